@@ -0,0 +1,45 @@
+#include "AllocationCounter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<std::size_t> allocations{0};
+}
+
+std::size_t BenchmarkSupport::allocationCount() noexcept
+{
+    return allocations.load(std::memory_order_relaxed);
+}
+
+// Replacing the two base forms is enough: the array and nothrow forms
+// forward to these.
+void *operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void *operator new(std::size_t size, std::align_val_t align)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    auto alignment = static_cast<std::size_t>(align);
+    // aligned_alloc wants the size to be a multiple of the alignment
+    std::size_t rounded = (size + alignment - 1) / alignment * alignment;
+    if (void *p = std::aligned_alloc(alignment, rounded ? rounded : alignment))
+    {
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete(void *p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t, std::align_val_t) noexcept { std::free(p); }
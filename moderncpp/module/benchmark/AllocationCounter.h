@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstddef>
+
+// Counts calls to the global operator new so benchmarks can report
+// allocations per iteration next to their timings.
+namespace BenchmarkSupport
+{
+    // Total number of global allocations made by the process so far.
+    std::size_t allocationCount() noexcept;
+}
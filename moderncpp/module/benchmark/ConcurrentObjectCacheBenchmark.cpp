@@ -0,0 +1,121 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+import leonrahul.ConcurrentObjectCache;
+
+using namespace std;
+using ThreadSafeWorld::ConcurrentObjectCache;
+using ThreadSafeWorld::LockFreeSharedWithWeakPtr;
+using ThreadSafeWorld::make_shared_custom;
+
+// Requests looking up already built objects under 64 keys, through the
+// striped cache and through one mutex around a map of std::weak_ptr
+namespace
+{
+    struct CompiledTemplate
+    {
+        string name;
+        explicit CompiledTemplate(string n) : name(std::move(n)) {}
+    };
+
+    constexpr size_t key_count = 64;
+    const int numcpu = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    const vector<string> &cacheKeys()
+    {
+        static const vector<string> keys = []
+        {
+            vector<string> k;
+            for (size_t i = 0; i < key_count; ++i)
+            {
+                k.push_back("template-" + to_string(i));
+            }
+            return k;
+        }();
+        return keys;
+    }
+
+    ConcurrentObjectCache<string, CompiledTemplate> stripedCache;
+    vector<LockFreeSharedWithWeakPtr<CompiledTemplate>> stripedHeld;
+
+    mutex globalMutex;
+    unordered_map<string, weak_ptr<CompiledTemplate>> globalCache;
+    vector<shared_ptr<CompiledTemplate>> globalHeld;
+
+    shared_ptr<CompiledTemplate> globalGetOrCreate(const string &key)
+    {
+        lock_guard<mutex> lock(globalMutex);
+        weak_ptr<CompiledTemplate> &slot = globalCache[key];
+        if (auto existing = slot.lock())
+        {
+            return existing;
+        }
+        auto created = make_shared<CompiledTemplate>(key);
+        slot = created;
+        return created;
+    }
+}
+
+static void BM_ConcurrentObjectCache_Hit(benchmark::State &state)
+{
+    if (state.thread_index() == 0 && stripedHeld.empty())
+    {
+        for (const string &key : cacheKeys())
+        {
+            stripedHeld.push_back(stripedCache.get_or_create(key, [&]
+                                                             { return make_shared_custom<CompiledTemplate>(key); }));
+        }
+    }
+    size_t i = state.thread_index();
+    for (auto _ : state)
+    {
+        const string &key = cacheKeys()[++i % key_count];
+        auto found = stripedCache.get_or_create(key, [&]
+                                                { return make_shared_custom<CompiledTemplate>(key); });
+        benchmark::DoNotOptimize(found.get());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ConcurrentObjectCache_Hit)->ThreadRange(1, numcpu)->UseRealTime();
+
+static void BM_GlobalMutexCache_Hit(benchmark::State &state)
+{
+    if (state.thread_index() == 0 && globalHeld.empty())
+    {
+        for (const string &key : cacheKeys())
+        {
+            globalHeld.push_back(globalGetOrCreate(key));
+        }
+    }
+    size_t i = state.thread_index();
+    for (auto _ : state)
+    {
+        auto found = globalGetOrCreate(cacheKeys()[++i % key_count]);
+        benchmark::DoNotOptimize(found.get());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GlobalMutexCache_Hit)->ThreadRange(1, numcpu)->UseRealTime();
+
+// Every lookup misses: the object is dropped right away, so each round
+// rebuilds it and the stripes sweep the dead entries as they go
+static void BM_ConcurrentObjectCache_MissDrop(benchmark::State &state)
+{
+    ConcurrentObjectCache<string, CompiledTemplate> cache;
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        const string &key = cacheKeys()[++i % key_count];
+        auto made = cache.get_or_create(key, [&]
+                                        { return make_shared_custom<CompiledTemplate>(key); });
+        benchmark::DoNotOptimize(made.get());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ConcurrentObjectCache_MissDrop);
@@ -0,0 +1,204 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AllocationCounter.h"
+
+import leonrahul.CustomStringArray;
+
+using StringWorld::CustomStringArray;
+
+// Building an array of N short strings one add() at a time, and copying
+// the finished array, against a std::vector<std::string>
+namespace
+{
+    const std::vector<std::string> &words(size_t n)
+    {
+        static std::vector<std::string> w;
+        while (w.size() < n)
+        {
+            w.push_back("column_" + std::to_string(w.size()));
+        }
+        return w;
+    }
+
+    void reportAllocations(benchmark::State &state, size_t before)
+    {
+        state.counters["allocs_per_iter"] = benchmark::Counter(
+            static_cast<double>(BenchmarkSupport::allocationCount() - before),
+            benchmark::Counter::kAvgIterations);
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+}
+
+static void BM_CustomStringArray_Build(benchmark::State &state)
+{
+    const auto &w = words(state.range(0));
+    auto before = BenchmarkSupport::allocationCount();
+    for (auto _ : state)
+    {
+        CustomStringArray arr;
+        for (int i = 0; i < state.range(0); ++i)
+        {
+            arr.add(w[i].c_str());
+        }
+        benchmark::DoNotOptimize(arr.get(0));
+    }
+    reportAllocations(state, before);
+}
+BENCHMARK(BM_CustomStringArray_Build)->RangeMultiplier(10)->Range(10, 10000);
+
+static void BM_CustomStringArray_Copy(benchmark::State &state)
+{
+    const auto &w = words(state.range(0));
+    CustomStringArray source;
+    for (int i = 0; i < state.range(0); ++i)
+    {
+        source.add(w[i].c_str());
+    }
+    auto before = BenchmarkSupport::allocationCount();
+    for (auto _ : state)
+    {
+        CustomStringArray copy(source);
+        benchmark::DoNotOptimize(copy.get(0));
+    }
+    reportAllocations(state, before);
+}
+BENCHMARK(BM_CustomStringArray_Copy)->RangeMultiplier(10)->Range(10, 10000);
+
+static void BM_StringVector_Build(benchmark::State &state)
+{
+    const auto &w = words(state.range(0));
+    auto before = BenchmarkSupport::allocationCount();
+    for (auto _ : state)
+    {
+        std::vector<std::string> arr;
+        for (int i = 0; i < state.range(0); ++i)
+        {
+            arr.emplace_back(w[i]);
+        }
+        benchmark::DoNotOptimize(arr.data());
+    }
+    reportAllocations(state, before);
+}
+BENCHMARK(BM_StringVector_Build)->RangeMultiplier(10)->Range(10, 10000);
+
+static void BM_StringVector_Copy(benchmark::State &state)
+{
+    const auto &w = words(state.range(0));
+    std::vector<std::string> source(w.begin(), w.begin() + state.range(0));
+    auto before = BenchmarkSupport::allocationCount();
+    for (auto _ : state)
+    {
+        std::vector<std::string> copy(source);
+        benchmark::DoNotOptimize(copy.data());
+    }
+    reportAllocations(state, before);
+}
+BENCHMARK(BM_StringVector_Copy)->RangeMultiplier(10)->Range(10, 10000);
+
+// Sorting N keys that look like request paths: a few long shared prefixes
+// followed by random ids, which is where strcmp keeps rereading the same
+// bytes. The arrays are copied outside the timed region.
+namespace
+{
+    const int numcpu = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    // One thread, and all of them when there are more
+    std::vector<int64_t> threadCounts()
+    {
+        return numcpu > 1 ? std::vector<int64_t>{1, numcpu} : std::vector<int64_t>{1};
+    }
+
+    const std::vector<std::string> &sortKeys(size_t n)
+    {
+        static std::vector<std::string> keys;
+        if (keys.size() < n)
+        {
+            std::mt19937_64 rng(42);
+            const char *prefixes[] = {"/api/v2/tenants/", "/api/v2/tenants/eu-west/users/", "/static/assets/", "/health"};
+            while (keys.size() < n)
+            {
+                keys.push_back(prefixes[rng() % 4] + std::to_string(rng() % 100000000));
+            }
+        }
+        return keys;
+    }
+
+    const CustomStringArray &unsortedArray(size_t n)
+    {
+        static std::vector<std::pair<size_t, CustomStringArray>> built;
+        for (const auto &[size, arr] : built)
+        {
+            if (size == n)
+            {
+                return arr;
+            }
+        }
+        const auto &keys = sortKeys(n);
+        CustomStringArray arr;
+        for (size_t i = 0; i < n; ++i)
+        {
+            arr.add(keys[i].c_str());
+        }
+        built.emplace_back(n, std::move(arr));
+        return built.back().second;
+    }
+
+    template <typename Sort>
+    void sortArray(benchmark::State &state, Sort sort)
+    {
+        const CustomStringArray &source = unsortedArray(state.range(0));
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            CustomStringArray arr(source);
+            state.ResumeTiming();
+            sort(arr);
+            benchmark::DoNotOptimize(arr.get(0));
+        }
+        state.SetItemsProcessed(state.iterations() * state.range(0));
+    }
+}
+
+static void BM_CustomStringArray_Sort(benchmark::State &state)
+{
+    unsigned threads = static_cast<unsigned>(state.range(1));
+    sortArray(state, [threads](CustomStringArray &arr)
+              { arr.sort(threads); });
+}
+BENCHMARK(BM_CustomStringArray_Sort)->ArgsProduct({{1 << 16, 1 << 20}, threadCounts()})->Unit(benchmark::kMillisecond);
+
+static void BM_CustomStringArray_StableSort(benchmark::State &state)
+{
+    unsigned threads = static_cast<unsigned>(state.range(1));
+    sortArray(state, [threads](CustomStringArray &arr)
+              { arr.stableSort(threads); });
+}
+BENCHMARK(BM_CustomStringArray_StableSort)->ArgsProduct({{1 << 16, 1 << 20}, threadCounts()})->Unit(benchmark::kMillisecond);
+
+// The baseline: std::sort over the element pointers with strcmp
+static void BM_StdSortStrcmp(benchmark::State &state)
+{
+    const CustomStringArray &source = unsortedArray(state.range(0));
+    std::vector<const char *> pointers(source.getSize());
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        for (int i = 0; i < source.getSize(); ++i)
+        {
+            pointers[i] = source.get(i);
+        }
+        state.ResumeTiming();
+        std::sort(pointers.begin(), pointers.end(), [](const char *a, const char *b)
+                  { return std::strcmp(a, b) < 0; });
+        benchmark::DoNotOptimize(pointers.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_StdSortStrcmp)->Arg(1 << 16)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
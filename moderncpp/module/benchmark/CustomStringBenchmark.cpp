@@ -0,0 +1,156 @@
+#include <benchmark/benchmark.h>
+#include <string>
+#include <string_view>
+
+#include "../include/CustomString.h"
+#include "AllocationCounter.h"
+
+// Copies and concatenations of short identifiers, which fit the inline
+// buffer, and of longer strings, which still go to the heap
+namespace
+{
+    const char *shortKey = "user_id";
+    const char *longText = "a configuration value well past the inline buffer";
+
+    void reportAllocations(benchmark::State &state, size_t before)
+    {
+        state.counters["allocs_per_iter"] = benchmark::Counter(
+            static_cast<double>(BenchmarkSupport::allocationCount() - before),
+            benchmark::Counter::kAvgIterations);
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    void copyString(benchmark::State &state, const char *text)
+    {
+        CustomString source(text);
+        auto before = BenchmarkSupport::allocationCount();
+        for (auto _ : state)
+        {
+            CustomString copy(source);
+            benchmark::DoNotOptimize(copy.c_str());
+        }
+        reportAllocations(state, before);
+    }
+
+    void concatString(benchmark::State &state, const char *text)
+    {
+        CustomString first(text);
+        CustomString second("_x");
+        auto before = BenchmarkSupport::allocationCount();
+        for (auto _ : state)
+        {
+            CustomString joined = first + second;
+            benchmark::DoNotOptimize(joined.c_str());
+        }
+        reportAllocations(state, before);
+    }
+}
+
+static void BM_CustomString_CopyShort(benchmark::State &state)
+{
+    copyString(state, shortKey);
+}
+BENCHMARK(BM_CustomString_CopyShort);
+
+static void BM_CustomString_CopyLong(benchmark::State &state)
+{
+    copyString(state, longText);
+}
+BENCHMARK(BM_CustomString_CopyLong);
+
+static void BM_CustomString_ConcatShort(benchmark::State &state)
+{
+    concatString(state, shortKey);
+}
+BENCHMARK(BM_CustomString_ConcatShort);
+
+static void BM_CustomString_ConcatLong(benchmark::State &state)
+{
+    concatString(state, longText);
+}
+BENCHMARK(BM_CustomString_ConcatLong);
+
+static void BM_StdString_CopyShort(benchmark::State &state)
+{
+    std::string source(shortKey);
+    auto before = BenchmarkSupport::allocationCount();
+    for (auto _ : state)
+    {
+        std::string copy(source);
+        benchmark::DoNotOptimize(copy.data());
+    }
+    reportAllocations(state, before);
+}
+BENCHMARK(BM_StdString_CopyShort);
+
+// A log line from six pieces, built in one step and, as before lazy
+// concatenation, one temporary CustomString per +
+namespace
+{
+    const CustomString level("WARN");
+    const CustomString service("billing-service");
+    const std::string host = "node-17.eu-west";
+    const char *message = "disk usage above threshold on /var/lib/data";
+}
+
+static void BM_CustomString_ConcatChain(benchmark::State &state)
+{
+    auto before = BenchmarkSupport::allocationCount();
+    for (auto _ : state)
+    {
+        CustomString line = level + " [" + service + "@" + std::string_view(host) + "] " + message;
+        benchmark::DoNotOptimize(line.c_str());
+    }
+    reportAllocations(state, before);
+}
+BENCHMARK(BM_CustomString_ConcatChain);
+
+static void BM_CustomString_ConcatChainEager(benchmark::State &state)
+{
+    CustomString open(" ["), at("@"), close("] "), hostName(host.c_str()), text(message);
+    auto before = BenchmarkSupport::allocationCount();
+    for (auto _ : state)
+    {
+        CustomString line = level + open;
+        line = line + service;
+        line = line + at;
+        line = line + hostName;
+        line = line + close;
+        line = line + text;
+        benchmark::DoNotOptimize(line.c_str());
+    }
+    reportAllocations(state, before);
+}
+BENCHMARK(BM_CustomString_ConcatChainEager);
+
+static void BM_StdString_ConcatChain(benchmark::State &state)
+{
+    std::string levelText("WARN"), serviceText("billing-service");
+    auto before = BenchmarkSupport::allocationCount();
+    for (auto _ : state)
+    {
+        std::string line = levelText + " [" + serviceText + "@" + host + "] " + message;
+        benchmark::DoNotOptimize(line.data());
+    }
+    reportAllocations(state, before);
+}
+BENCHMARK(BM_StdString_ConcatChain);
+
+// Copying a 1 MB payload between pipeline stages, deep and shared
+static void BM_CustomString_CopyLarge(benchmark::State &state)
+{
+    std::string payload(1 << 20, 'p');
+    CustomString source(payload.c_str());
+    if (state.range(0) != 0)
+    {
+        source.share();
+    }
+    auto before = BenchmarkSupport::allocationCount();
+    for (auto _ : state)
+    {
+        CustomString copy(source);
+        benchmark::DoNotOptimize(copy.c_str());
+    }
+    reportAllocations(state, before);
+}
+BENCHMARK(BM_CustomString_CopyLarge)->ArgName("shared")->Arg(0)->Arg(1);
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+// Per-operation latency sampling for benchmarks that care about the tail
+// rather than the mean reported by Google Benchmark.
+namespace BenchmarkSupport
+{
+    class LatencySamples
+    {
+    private:
+        std::vector<double> samples_;
+
+    public:
+        explicit LatencySamples(std::size_t expected = 1 << 16)
+        {
+            samples_.reserve(expected);
+        }
+
+        // Times one call of op in nanoseconds
+        template <typename Op>
+        void measure(Op &&op)
+        {
+            auto start = std::chrono::steady_clock::now();
+            op();
+            auto end = std::chrono::steady_clock::now();
+            samples_.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+        }
+
+        // Adds p50/p99/p999 counters, in nanoseconds, to state
+        void report(benchmark::State &state)
+        {
+            if (samples_.empty())
+            {
+                return;
+            }
+            std::sort(samples_.begin(), samples_.end());
+            auto at = [this](double quantile)
+            {
+                return samples_[static_cast<std::size_t>(quantile * (samples_.size() - 1))];
+            };
+            state.counters["p50_ns"] = at(0.50);
+            state.counters["p99_ns"] = at(0.99);
+            state.counters["p999_ns"] = at(0.999);
+        }
+    };
+}
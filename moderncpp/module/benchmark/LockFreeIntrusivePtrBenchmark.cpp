@@ -0,0 +1,160 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+#include "AllocationCounter.h"
+
+import leonrahul.LockFreeIntrusivePtr;
+import leonrahul.LockFreeSharedWithWeakPtr;
+
+using namespace std;
+using ThreadSafeWorld::IntrusiveRefCounted;
+using ThreadSafeWorld::LockFreeIntrusivePtr;
+using ThreadSafeWorld::AtomicLockFreeIntrusivePtr;
+using ThreadSafeWorld::make_intrusive;
+using ThreadSafeWorld::LockFreeSharedWithWeakPtr;
+using ThreadSafeWorld::AtomicLockFreeSharedPtr;
+
+namespace
+{
+    struct IntrusivePayload : IntrusiveRefCounted<IntrusivePayload>
+    {
+        int value;
+        explicit IntrusivePayload(int v = 0) : value(v) {}
+    };
+
+    struct PlainPayload
+    {
+        int value;
+        explicit PlainPayload(int v = 0) : value(v) {}
+    };
+
+    void reportAllocations(benchmark::State &state, size_t before)
+    {
+        state.counters["allocs_per_iter"] = benchmark::Counter(
+            static_cast<double>(BenchmarkSupport::allocationCount() - before),
+            benchmark::Counter::kAvgIterations);
+    }
+
+    const int numcpu = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+// --- Construction from a fresh object: no control block to allocate ---
+static void BM_LockFreeIntrusivePtr_Create(benchmark::State &state)
+{
+    auto before = BenchmarkSupport::allocationCount();
+    for (auto _ : state)
+    {
+        auto ptr = make_intrusive<IntrusivePayload>(1);
+        benchmark::DoNotOptimize(ptr.get());
+    }
+    reportAllocations(state, before);
+}
+BENCHMARK(BM_LockFreeIntrusivePtr_Create);
+
+static void BM_LockFreeSharedWithWeakPtr_Create(benchmark::State &state)
+{
+    auto before = BenchmarkSupport::allocationCount();
+    for (auto _ : state)
+    {
+        LockFreeSharedWithWeakPtr<PlainPayload> ptr(new PlainPayload(1));
+        benchmark::DoNotOptimize(ptr.get());
+    }
+    reportAllocations(state, before);
+}
+BENCHMARK(BM_LockFreeSharedWithWeakPtr_Create);
+
+// --- Copy and dereference of a pointer shared by every thread ---
+namespace
+{
+    LockFreeIntrusivePtr<IntrusivePayload> sharedIntrusive = make_intrusive<IntrusivePayload>(7);
+    LockFreeSharedWithWeakPtr<PlainPayload> sharedCounted(new PlainPayload(7));
+    std::shared_ptr<PlainPayload> sharedStd = std::make_shared<PlainPayload>(7);
+}
+
+static void BM_LockFreeIntrusivePtr_CopyDeref(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        auto copy = sharedIntrusive;
+        benchmark::DoNotOptimize(copy->value);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LockFreeIntrusivePtr_CopyDeref)->ThreadRange(1, numcpu)->UseRealTime();
+
+static void BM_LockFreeSharedWithWeakPtr_CopyDeref(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        auto copy = sharedCounted;
+        benchmark::DoNotOptimize(copy->value);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LockFreeSharedWithWeakPtr_CopyDeref)->ThreadRange(1, numcpu)->UseRealTime();
+
+static void BM_StdSharedPtr_CopyDeref(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        auto copy = sharedStd;
+        benchmark::DoNotOptimize(copy->value);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StdSharedPtr_CopyDeref)->ThreadRange(1, numcpu)->UseRealTime();
+
+// --- Published slot: thread 0 writes, every other thread reads ---
+namespace
+{
+    AtomicLockFreeIntrusivePtr<IntrusivePayload> intrusiveSlot;
+    AtomicLockFreeSharedPtr<PlainPayload> countedSlot;
+}
+
+static void BM_AtomicLockFreeIntrusivePtr_ReadMostly(benchmark::State &state)
+{
+    if (state.thread_index() == 0)
+    {
+        intrusiveSlot.store(make_intrusive<IntrusivePayload>(0));
+        int version = 0;
+        for (auto _ : state)
+        {
+            intrusiveSlot.store(make_intrusive<IntrusivePayload>(++version));
+        }
+    }
+    else
+    {
+        for (auto _ : state)
+        {
+            auto current = intrusiveSlot.load();
+            benchmark::DoNotOptimize(current->value);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+BENCHMARK(BM_AtomicLockFreeIntrusivePtr_ReadMostly)->ThreadRange(2, std::max(2, numcpu))->UseRealTime();
+
+static void BM_AtomicLockFreeSharedPtr_IntrusiveBaseline(benchmark::State &state)
+{
+    if (state.thread_index() == 0)
+    {
+        countedSlot.store(LockFreeSharedWithWeakPtr<PlainPayload>(new PlainPayload(0)));
+        int version = 0;
+        for (auto _ : state)
+        {
+            countedSlot.store(LockFreeSharedWithWeakPtr<PlainPayload>(new PlainPayload(++version)));
+        }
+    }
+    else
+    {
+        for (auto _ : state)
+        {
+            auto current = countedSlot.load();
+            benchmark::DoNotOptimize(current->value);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+BENCHMARK(BM_AtomicLockFreeSharedPtr_IntrusiveBaseline)->ThreadRange(2, std::max(2, numcpu))->UseRealTime();
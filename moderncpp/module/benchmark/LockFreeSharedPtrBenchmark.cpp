@@ -0,0 +1,123 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "LatencyStats.h"
+
+import leonrahul.LockFreeSharedPtr;
+
+using ThreadSafeWorld::LockFreeSharedPtr;
+using ThreadSafeWorld::LocalSharedPtr;
+using ThreadSafeWorld::DeferredSharedPtr;
+using ThreadSafeWorld::ShardedSharedPtr;
+using ThreadSafeWorld::DeferredReclaimer;
+
+namespace
+{
+    struct Node
+    {
+        int value;
+        explicit Node(int v = 0) : value(v) {}
+    };
+
+    // Copy and drop a pointer, the refcount traffic of passing it by value
+    template <typename Ptr>
+    void copyAndDrop(benchmark::State &state)
+    {
+        Ptr source{new Node(42)};
+        for (auto _ : state)
+        {
+            Ptr copy(source);
+            benchmark::DoNotOptimize(copy.get());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+
+// --- Atomic vs thread-confined count policy ---
+static void BM_LockFreeSharedPtr_CopyDrop(benchmark::State &state)
+{
+    copyAndDrop<LockFreeSharedPtr<Node>>(state);
+}
+BENCHMARK(BM_LockFreeSharedPtr_CopyDrop);
+
+static void BM_LocalSharedPtr_CopyDrop(benchmark::State &state)
+{
+    copyAndDrop<LocalSharedPtr<Node>>(state);
+}
+BENCHMARK(BM_LocalSharedPtr_CopyDrop);
+
+// --- Latency of dropping the last reference to a large object ---
+// Inline destruction frees every chunk on the dropping thread; the deferred
+// policy only queues the block, and a background reclaimer frees it.
+namespace
+{
+    struct LargeObject
+    {
+        std::vector<std::vector<int>> chunks;
+        LargeObject() : chunks(256, std::vector<int>(256)) {}
+    };
+
+    template <typename Ptr>
+    void dropLast(benchmark::State &state)
+    {
+        BenchmarkSupport::LatencySamples latencies;
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            Ptr ptr{new LargeObject};
+            state.ResumeTiming();
+            latencies.measure([&ptr]
+                              { ptr.reset(); });
+        }
+        latencies.report(state);
+    }
+}
+
+static void BM_LockFreeSharedPtr_DropLargeInline(benchmark::State &state)
+{
+    dropLast<LockFreeSharedPtr<LargeObject>>(state);
+}
+BENCHMARK(BM_LockFreeSharedPtr_DropLargeInline);
+
+static void BM_DeferredSharedPtr_DropLarge(benchmark::State &state)
+{
+    DeferredReclaimer::global().start_background(std::chrono::microseconds(200));
+    dropLast<DeferredSharedPtr<LargeObject>>(state);
+    DeferredReclaimer::global().stop_background();
+}
+BENCHMARK(BM_DeferredSharedPtr_DropLarge);
+
+// --- Hot object copied by every thread: one count vs sharded counts ---
+namespace
+{
+    const int numcpu = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    LockFreeSharedPtr<Node> hotShared{new Node(7)};
+    ShardedSharedPtr<Node> hotSharded{new Node(7)};
+
+    template <typename Ptr>
+    void copyHot(benchmark::State &state, const Ptr &hot)
+    {
+        for (auto _ : state)
+        {
+            Ptr copy(hot);
+            benchmark::DoNotOptimize(copy->value);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+
+static void BM_LockFreeSharedPtr_HotCopy(benchmark::State &state)
+{
+    copyHot(state, hotShared);
+}
+BENCHMARK(BM_LockFreeSharedPtr_HotCopy)->ThreadRange(1, numcpu)->UseRealTime();
+
+static void BM_ShardedSharedPtr_HotCopy(benchmark::State &state)
+{
+    copyHot(state, hotSharded);
+}
+BENCHMARK(BM_ShardedSharedPtr_HotCopy)->ThreadRange(1, numcpu)->UseRealTime();
@@ -0,0 +1,103 @@
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <vector>
+
+#include "AllocationCounter.h"
+
+import leonrahul.LockFreeSharedPtrGemini;
+
+using ThreadSafeWorld::make_lock_free_shared;
+using ThreadSafeWorld::LockFreeSharedPtrGemini;
+using ThreadSafeWorld::ControlBlockImpl;
+using ThreadSafeWorld::ControlBlockMakeShared;
+
+namespace
+{
+    struct GeminiPayload
+    {
+        long a, b, c;
+        explicit GeminiPayload(long v = 0) : a(v), b(v), c(v) {}
+    };
+}
+
+// --- Create and drop a short-lived shared object ---
+static void BM_Gemini_MakeLockFreeShared(benchmark::State &state)
+{
+    auto before = BenchmarkSupport::allocationCount();
+    for (auto _ : state)
+    {
+        auto ptr = make_lock_free_shared<GeminiPayload>(42);
+        benchmark::DoNotOptimize(ptr.get());
+    }
+    state.counters["allocs_per_iter"] = benchmark::Counter(
+        static_cast<double>(BenchmarkSupport::allocationCount() - before),
+        benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_Gemini_MakeLockFreeShared);
+
+static void BM_Gemini_StdMakeShared(benchmark::State &state)
+{
+    auto before = BenchmarkSupport::allocationCount();
+    for (auto _ : state)
+    {
+        auto ptr = std::make_shared<GeminiPayload>(42);
+        benchmark::DoNotOptimize(ptr.get());
+    }
+    state.counters["allocs_per_iter"] = benchmark::Counter(
+        static_cast<double>(BenchmarkSupport::allocationCount() - before),
+        benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_Gemini_StdMakeShared);
+
+// --- Dropping the last reference: object and block destruction ---
+namespace
+{
+    constexpr int releaseBatch = 1024;
+
+    struct GeminiDeleter
+    {
+        void operator()(GeminiPayload *p) const { delete p; }
+    };
+
+    template <typename Make>
+    void releaseLast(benchmark::State &state, size_t block_bytes, Make make)
+    {
+        std::vector<LockFreeSharedPtrGemini<GeminiPayload>> ptrs(releaseBatch);
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            for (auto &ptr : ptrs)
+            {
+                ptr = make();
+            }
+            state.ResumeTiming();
+            for (auto &ptr : ptrs)
+            {
+                ptr.reset();
+            }
+        }
+        state.counters["block_bytes"] = static_cast<double>(block_bytes);
+        state.SetItemsProcessed(state.iterations() * releaseBatch);
+    }
+}
+
+static void BM_Gemini_ReleaseDefaultDelete(benchmark::State &state)
+{
+    releaseLast(state, sizeof(ControlBlockImpl<GeminiPayload>), []
+                { return LockFreeSharedPtrGemini<GeminiPayload>(new GeminiPayload(1)); });
+}
+BENCHMARK(BM_Gemini_ReleaseDefaultDelete);
+
+static void BM_Gemini_ReleaseCustomDeleter(benchmark::State &state)
+{
+    releaseLast(state, sizeof(ControlBlockImpl<GeminiPayload, GeminiDeleter>), []
+                { return LockFreeSharedPtrGemini<GeminiPayload>(new GeminiPayload(1), GeminiDeleter()); });
+}
+BENCHMARK(BM_Gemini_ReleaseCustomDeleter);
+
+static void BM_Gemini_ReleaseMakeShared(benchmark::State &state)
+{
+    releaseLast(state, sizeof(ControlBlockMakeShared<GeminiPayload>), []
+                { return make_lock_free_shared<GeminiPayload>(1); });
+}
+BENCHMARK(BM_Gemini_ReleaseMakeShared);
@@ -0,0 +1,756 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <memory>
+#include <memory_resource>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <cstddef>
+
+#include "AllocationCounter.h"
+#include "LatencyStats.h"
+
+import leonrahul.LockFreeSharedWithWeakPtr;
+
+using namespace std;
+using ThreadSafeWorld::LockFreeSharedWithWeakPtr;
+using ThreadSafeWorld::LockFreeWeakPtr;
+using ThreadSafeWorld::make_shared_custom;
+using ThreadSafeWorld::make_shared_array;
+using ThreadSafeWorld::make_shared_array_for_overwrite;
+using ThreadSafeWorld::allocate_shared_pmr;
+using ThreadSafeWorld::AtomicLockFreeSharedPtr;
+using ThreadSafeWorld::make_biased_shared;
+using ThreadSafeWorld::Reclamation;
+using ThreadSafeWorld::HazardPointer;
+using ThreadSafeWorld::DeferredReclaimer;
+using ThreadSafeWorld::PointerLayout;
+using ThreadSafeWorld::BasicControlBlock;
+using ThreadSafeWorld::ControlBlockWithDeleter;
+using ThreadSafeWorld::ControlBlockMakeShared;
+using ThreadSafeWorld::SharedRef;
+using ThreadSafeWorld::ContentionSnapshot;
+using ThreadSafeWorld::ContentionStats;
+using ThreadSafeWorld::contention_stats_enabled;
+
+namespace
+{
+    struct Payload
+    {
+        int value;
+        explicit Payload(int v = 0) : value(v) {}
+    };
+
+    // Reports how many global allocations each iteration made on average.
+    void reportAllocations(benchmark::State &state, size_t before)
+    {
+        state.counters["allocs_per_iter"] = benchmark::Counter(
+            static_cast<double>(BenchmarkSupport::allocationCount() - before),
+            benchmark::Counter::kAvgIterations);
+    }
+
+    // Adds the CAS failures and spins taken per iteration, across all
+    // threads, in builds with THREADSAFEWORLD_CONTENTION_STATS. Only the
+    // first thread reports, so the per-thread values sum to the total.
+    void reportContention(benchmark::State &state, const ContentionSnapshot &before)
+    {
+        if constexpr (contention_stats_enabled)
+        {
+            auto delta = ContentionStats::snapshot() - before;
+            bool first = state.thread_index() == 0;
+            state.counters["cas_failures_per_iter"] = benchmark::Counter(
+                first ? static_cast<double>(delta.cas_failures) : 0.0, benchmark::Counter::kAvgIterations);
+            state.counters["spins_per_iter"] = benchmark::Counter(
+                first ? static_cast<double>(delta.spin_iterations) : 0.0, benchmark::Counter::kAvgIterations);
+        }
+    }
+}
+
+// --- Weak -> strong upgrade ---
+static void BM_LockFreeWeakPtr_Lock(benchmark::State &state)
+{
+    auto shared = make_shared_custom<Payload>(42);
+    LockFreeWeakPtr<Payload> weak(shared);
+
+    auto before = BenchmarkSupport::allocationCount();
+    for (auto _ : state)
+    {
+        auto locked = weak.lock();
+        benchmark::DoNotOptimize(locked.get());
+    }
+    reportAllocations(state, before);
+}
+BENCHMARK(BM_LockFreeWeakPtr_Lock);
+
+static void BM_StdWeakPtr_Lock(benchmark::State &state)
+{
+    auto shared = std::make_shared<Payload>(42);
+    std::weak_ptr<Payload> weak(shared);
+
+    auto before = BenchmarkSupport::allocationCount();
+    for (auto _ : state)
+    {
+        auto locked = weak.lock();
+        benchmark::DoNotOptimize(locked.get());
+    }
+    reportAllocations(state, before);
+}
+BENCHMARK(BM_StdWeakPtr_Lock);
+
+// --- Control block allocation for raw pointers ---
+// Raw T* construction takes its block from the pool; routing the same block
+// through a non-default allocator goes to plain operator new instead.
+namespace
+{
+    template <typename T>
+    struct PlainAllocator : std::allocator<T>
+    {
+        template <typename U>
+        struct rebind
+        {
+            using other = PlainAllocator<U>;
+        };
+
+        PlainAllocator() = default;
+        template <typename U>
+        PlainAllocator(const PlainAllocator<U> &) noexcept {}
+    };
+}
+
+static void BM_RawPointer_PooledBlock(benchmark::State &state)
+{
+    auto before = BenchmarkSupport::allocationCount();
+    for (auto _ : state)
+    {
+        LockFreeSharedWithWeakPtr<Payload> ptr(new Payload(1));
+        benchmark::DoNotOptimize(ptr.get());
+    }
+    reportAllocations(state, before);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RawPointer_PooledBlock)->ThreadRange(1, std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
+
+static void BM_RawPointer_HeapBlock(benchmark::State &state)
+{
+    auto before = BenchmarkSupport::allocationCount();
+    for (auto _ : state)
+    {
+        LockFreeSharedWithWeakPtr<Payload> ptr(new Payload(1), std::default_delete<Payload>(),
+                                               PlainAllocator<Payload>());
+        benchmark::DoNotOptimize(ptr.get());
+    }
+    reportAllocations(state, before);
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RawPointer_HeapBlock)->ThreadRange(1, std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
+
+// --- Published slot: thread 0 writes, every other thread reads ---
+// The std::atomic<std::shared_ptr> baseline needs a library that has the
+// specialization; libc++ does not yet, so that row is absent there
+namespace
+{
+    AtomicLockFreeSharedPtr<Payload> lockFreeSlot;
+#if defined(__cpp_lib_atomic_shared_ptr)
+    std::atomic<std::shared_ptr<Payload>> stdSlot;
+#endif
+
+    const int numcpu = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+static void BM_AtomicLockFreeSharedPtr_ReadMostly(benchmark::State &state)
+{
+    auto contention = ContentionStats::snapshot();
+    if (state.thread_index() == 0)
+    {
+        lockFreeSlot.store(LockFreeSharedWithWeakPtr<Payload>(new Payload(0)));
+        int version = 0;
+        for (auto _ : state)
+        {
+            lockFreeSlot.store(LockFreeSharedWithWeakPtr<Payload>(new Payload(++version)));
+        }
+    }
+    else
+    {
+        for (auto _ : state)
+        {
+            auto current = lockFreeSlot.load();
+            benchmark::DoNotOptimize(current->value);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+    reportContention(state, contention);
+}
+BENCHMARK(BM_AtomicLockFreeSharedPtr_ReadMostly)->ThreadRange(2, std::max(2, numcpu))->UseRealTime();
+
+#if defined(__cpp_lib_atomic_shared_ptr)
+static void BM_StdAtomicSharedPtr_ReadMostly(benchmark::State &state)
+{
+    if (state.thread_index() == 0)
+    {
+        stdSlot.store(std::make_shared<Payload>(0));
+        int version = 0;
+        for (auto _ : state)
+        {
+            stdSlot.store(std::make_shared<Payload>(++version));
+        }
+    }
+    else
+    {
+        for (auto _ : state)
+        {
+            auto current = stdSlot.load();
+            benchmark::DoNotOptimize(current->value);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+BENCHMARK(BM_StdAtomicSharedPtr_ReadMostly)->ThreadRange(2, std::max(2, numcpu))->UseRealTime();
+#endif
+
+// Readers borrow through a hazard pointer instead of copying, so they never
+// write to the control block
+namespace
+{
+    LockFreeSharedWithWeakPtr<Payload> hazardShared;
+
+    LockFreeSharedWithWeakPtr<Payload> makeHazardPayload(int value)
+    {
+        LockFreeSharedWithWeakPtr<Payload> ptr(new Payload(value));
+        ptr.set_reclamation(Reclamation::Hazard);
+        return ptr;
+    }
+}
+
+static void BM_HazardProtect_ReadMostly(benchmark::State &state)
+{
+    if (state.thread_index() == 0)
+    {
+        hazardShared = makeHazardPayload(0);
+        int version = 0;
+        for (auto _ : state)
+        {
+            hazardShared = makeHazardPayload(++version);
+        }
+    }
+    else
+    {
+        HazardPointer hp;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(hazardShared.protect(hp)->value);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+BENCHMARK(BM_HazardProtect_ReadMostly)->ThreadRange(2, std::max(2, numcpu))->UseRealTime();
+
+// --- Biased vs plain counting ---
+// Thread 0 creates (and so owns) the object and copies it every iteration.
+// Other threads copy it once every range(0) iterations: Threads(1) is the
+// owner-only case, a large stride is mixed, a stride of 1 is fully shared.
+namespace
+{
+    LockFreeSharedWithWeakPtr<Payload> biasedShared;
+
+    template <bool Biased>
+    void copyFromOwnerAndOthers(benchmark::State &state)
+    {
+        if (state.thread_index() == 0)
+        {
+            biasedShared = Biased ? make_biased_shared<Payload>(1)
+                                  : LockFreeSharedWithWeakPtr<Payload>(new Payload(1));
+        }
+        const int64_t stride = state.thread_index() == 0 ? 1 : state.range(0);
+        int64_t i = 0;
+        for (auto _ : state)
+        {
+            if (++i % stride == 0)
+            {
+                LockFreeSharedWithWeakPtr<Payload> copy(biasedShared);
+                benchmark::DoNotOptimize(copy.get());
+            }
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+
+static void BM_BiasedCopy(benchmark::State &state)
+{
+    copyFromOwnerAndOthers<true>(state);
+}
+BENCHMARK(BM_BiasedCopy)->Arg(1)->Threads(1);
+BENCHMARK(BM_BiasedCopy)->Arg(16)->Arg(1)->ThreadRange(2, std::max(2, numcpu))->UseRealTime();
+
+static void BM_PlainCopy(benchmark::State &state)
+{
+    copyFromOwnerAndOthers<false>(state);
+}
+BENCHMARK(BM_PlainCopy)->Arg(1)->Threads(1);
+BENCHMARK(BM_PlainCopy)->Arg(16)->Arg(1)->ThreadRange(2, std::max(2, numcpu))->UseRealTime();
+
+// --- Latency of dropping the last reference to a large object ---
+namespace
+{
+    struct LargeObject
+    {
+        std::vector<std::vector<int>> chunks;
+        LargeObject() : chunks(256, std::vector<int>(256)) {}
+    };
+
+    void dropLast(benchmark::State &state, Reclamation mode)
+    {
+        BenchmarkSupport::LatencySamples latencies;
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            LockFreeSharedWithWeakPtr<LargeObject> ptr(new LargeObject);
+            ptr.set_reclamation(mode);
+            state.ResumeTiming();
+            latencies.measure([&ptr]
+                              { ptr.reset(); });
+        }
+        latencies.report(state);
+    }
+}
+
+static void BM_DropLargeImmediate(benchmark::State &state)
+{
+    dropLast(state, Reclamation::Immediate);
+}
+BENCHMARK(BM_DropLargeImmediate);
+
+static void BM_DropLargeDeferred(benchmark::State &state)
+{
+    DeferredReclaimer::global().start_background(std::chrono::microseconds(200));
+    dropLast(state, Reclamation::Deferred);
+    DeferredReclaimer::global().stop_background();
+}
+BENCHMARK(BM_DropLargeDeferred);
+
+// --- Pointer layouts: 16-byte pair vs one packed word ---
+// Without a native 16-byte CAS every pair access goes through the spin flag.
+namespace
+{
+    template <PointerLayout Layout>
+    using LayoutPtr = LockFreeSharedWithWeakPtr<Payload, Layout>;
+
+    LayoutPtr<PointerLayout::Pair> pairShared(new Payload(3));
+    LayoutPtr<PointerLayout::Packed> packedShared(new Payload(3));
+
+    template <PointerLayout Layout>
+    const LayoutPtr<Layout> &layoutShared()
+    {
+        if constexpr (Layout == PointerLayout::Packed)
+        {
+            return packedShared;
+        }
+        else
+        {
+            return pairShared;
+        }
+    }
+
+    template <PointerLayout Layout>
+    void derefShared(benchmark::State &state)
+    {
+        const auto &shared = layoutShared<Layout>();
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(shared->value);
+        }
+        state.counters["bytes"] = sizeof(LayoutPtr<Layout>);
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    template <PointerLayout Layout>
+    void copyShared(benchmark::State &state)
+    {
+        const auto &shared = layoutShared<Layout>();
+        for (auto _ : state)
+        {
+            LayoutPtr<Layout> copy(shared);
+            benchmark::DoNotOptimize(copy.get());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    template <PointerLayout Layout>
+    void lockWeak(benchmark::State &state)
+    {
+        LockFreeWeakPtr<Payload, Layout> weak(layoutShared<Layout>());
+        for (auto _ : state)
+        {
+            auto locked = weak.lock();
+            benchmark::DoNotOptimize(locked.get());
+        }
+        state.counters["bytes"] = sizeof(weak);
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // Assignment and swap exercise the exchange and CAS paths
+    template <PointerLayout Layout>
+    void assignAndSwap(benchmark::State &state)
+    {
+        LayoutPtr<Layout> a(new Payload(1));
+        LayoutPtr<Layout> b(new Payload(2));
+        LayoutPtr<Layout> c;
+        for (auto _ : state)
+        {
+            c = a;
+            a.swap(b);
+            benchmark::DoNotOptimize(c.get());
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+
+static void BM_PairLayout_Deref(benchmark::State &state)
+{
+    derefShared<PointerLayout::Pair>(state);
+}
+BENCHMARK(BM_PairLayout_Deref)->ThreadRange(1, numcpu)->UseRealTime();
+
+static void BM_PackedLayout_Deref(benchmark::State &state)
+{
+    derefShared<PointerLayout::Packed>(state);
+}
+BENCHMARK(BM_PackedLayout_Deref)->ThreadRange(1, numcpu)->UseRealTime();
+
+static void BM_PairLayout_Copy(benchmark::State &state)
+{
+    copyShared<PointerLayout::Pair>(state);
+}
+BENCHMARK(BM_PairLayout_Copy)->ThreadRange(1, numcpu)->UseRealTime();
+
+static void BM_PackedLayout_Copy(benchmark::State &state)
+{
+    copyShared<PointerLayout::Packed>(state);
+}
+BENCHMARK(BM_PackedLayout_Copy)->ThreadRange(1, numcpu)->UseRealTime();
+
+static void BM_PairLayout_WeakLock(benchmark::State &state)
+{
+    lockWeak<PointerLayout::Pair>(state);
+}
+BENCHMARK(BM_PairLayout_WeakLock)->ThreadRange(1, numcpu)->UseRealTime();
+
+static void BM_PackedLayout_WeakLock(benchmark::State &state)
+{
+    lockWeak<PointerLayout::Packed>(state);
+}
+BENCHMARK(BM_PackedLayout_WeakLock)->ThreadRange(1, numcpu)->UseRealTime();
+
+static void BM_PairLayout_AssignSwap(benchmark::State &state)
+{
+    assignAndSwap<PointerLayout::Pair>(state);
+}
+BENCHMARK(BM_PairLayout_AssignSwap);
+
+static void BM_PackedLayout_AssignSwap(benchmark::State &state)
+{
+    assignAndSwap<PointerLayout::Packed>(state);
+}
+BENCHMARK(BM_PackedLayout_AssignSwap);
+
+// --- Dropping the last reference: object and block destruction ---
+namespace
+{
+    constexpr int releaseBatch = 1024;
+
+    struct PayloadDeleter
+    {
+        void operator()(Payload *p) const { delete p; }
+    };
+
+    template <typename Make>
+    void releaseLast(benchmark::State &state, size_t block_bytes, Make make)
+    {
+        std::vector<LockFreeSharedWithWeakPtr<Payload>> ptrs(releaseBatch);
+        for (auto _ : state)
+        {
+            state.PauseTiming();
+            for (auto &ptr : ptrs)
+            {
+                ptr = make();
+            }
+            state.ResumeTiming();
+            for (auto &ptr : ptrs)
+            {
+                ptr.reset();
+            }
+        }
+        state.counters["block_bytes"] = static_cast<double>(block_bytes);
+        state.SetItemsProcessed(state.iterations() * releaseBatch);
+    }
+}
+
+static void BM_ReleaseDefaultDelete(benchmark::State &state)
+{
+    releaseLast(state, sizeof(BasicControlBlock<Payload>), []
+                { return LockFreeSharedWithWeakPtr<Payload>(new Payload(1)); });
+}
+BENCHMARK(BM_ReleaseDefaultDelete);
+
+static void BM_ReleaseCustomDeleter(benchmark::State &state)
+{
+    using Block = ControlBlockWithDeleter<Payload, PayloadDeleter, std::allocator<Payload>>;
+    releaseLast(state, sizeof(Block), []
+                { return LockFreeSharedWithWeakPtr<Payload>(new Payload(1), PayloadDeleter()); });
+}
+BENCHMARK(BM_ReleaseCustomDeleter);
+
+static void BM_ReleaseMakeShared(benchmark::State &state)
+{
+    releaseLast(state, sizeof(ControlBlockMakeShared<Payload, std::allocator<Payload>>), []
+                { return make_shared_custom<Payload>(1); });
+}
+BENCHMARK(BM_ReleaseMakeShared);
+
+// --- Weak-heavy workloads: lock() storms, weak churn, release with weak refs ---
+namespace
+{
+    LockFreeSharedWithWeakPtr<Payload> weakTarget(new Payload(42));
+    std::shared_ptr<Payload> stdWeakTarget = std::make_shared<Payload>(42);
+}
+
+// Every thread upgrades its own weak reference to one shared object, so
+// all the lock() CASes land on a single count word
+static void BM_WeakLockStorm(benchmark::State &state)
+{
+    LockFreeWeakPtr<Payload> weak(weakTarget);
+    auto contention = ContentionStats::snapshot();
+    for (auto _ : state)
+    {
+        auto locked = weak.lock();
+        benchmark::DoNotOptimize(locked.get());
+    }
+    state.SetItemsProcessed(state.iterations());
+    reportContention(state, contention);
+}
+BENCHMARK(BM_WeakLockStorm)->ThreadRange(1, numcpu)->UseRealTime();
+
+static void BM_StdWeakLockStorm(benchmark::State &state)
+{
+    std::weak_ptr<Payload> weak(stdWeakTarget);
+    for (auto _ : state)
+    {
+        auto locked = weak.lock();
+        benchmark::DoNotOptimize(locked.get());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StdWeakLockStorm)->ThreadRange(1, numcpu)->UseRealTime();
+
+// Observers attaching and detaching while the object stays alive
+static void BM_WeakCreateDrop(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        LockFreeWeakPtr<Payload> weak(weakTarget);
+        benchmark::DoNotOptimize(&weak);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_WeakCreateDrop)->ThreadRange(1, numcpu)->UseRealTime();
+
+static void BM_StdWeakCreateDrop(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        std::weak_ptr<Payload> weak(stdWeakTarget);
+        benchmark::DoNotOptimize(&weak);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StdWeakCreateDrop)->ThreadRange(1, numcpu)->UseRealTime();
+
+// Last strong reference dropped while a weak one is outstanding, then the
+// weak one: the object and the block are freed on separate paths
+static void BM_ReleaseWithWeakOutstanding(benchmark::State &state)
+{
+    std::vector<LockFreeSharedWithWeakPtr<Payload>> ptrs(releaseBatch);
+    std::vector<LockFreeWeakPtr<Payload>> weaks(releaseBatch);
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        for (int i = 0; i < releaseBatch; ++i)
+        {
+            ptrs[i] = LockFreeSharedWithWeakPtr<Payload>(new Payload(i));
+            weaks[i] = LockFreeWeakPtr<Payload>(ptrs[i]);
+        }
+        state.ResumeTiming();
+        for (int i = 0; i < releaseBatch; ++i)
+        {
+            ptrs[i].reset();
+            weaks[i].reset();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * releaseBatch);
+}
+BENCHMARK(BM_ReleaseWithWeakOutstanding);
+
+static void BM_StdReleaseWithWeakOutstanding(benchmark::State &state)
+{
+    std::vector<std::shared_ptr<Payload>> ptrs(releaseBatch);
+    std::vector<std::weak_ptr<Payload>> weaks(releaseBatch);
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        for (int i = 0; i < releaseBatch; ++i)
+        {
+            ptrs[i] = std::shared_ptr<Payload>(new Payload(i));
+            weaks[i] = ptrs[i];
+        }
+        state.ResumeTiming();
+        for (int i = 0; i < releaseBatch; ++i)
+        {
+            ptrs[i].reset();
+            weaks[i].reset();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * releaseBatch);
+}
+BENCHMARK(BM_StdReleaseWithWeakOutstanding);
+
+// --- Shared numeric buffers: one fused, aligned allocation per array ---
+static void BM_MakeSharedArray(benchmark::State &state)
+{
+    auto size = static_cast<size_t>(state.range(0));
+    auto before = BenchmarkSupport::allocationCount();
+    for (auto _ : state)
+    {
+        auto buffer = make_shared_array<double, 64>(size);
+        benchmark::DoNotOptimize(buffer.get());
+    }
+    reportAllocations(state, before);
+    state.SetBytesProcessed(state.iterations() * size * sizeof(double));
+}
+BENCHMARK(BM_MakeSharedArray)->Arg(64)->Arg(4096)->Arg(1 << 18);
+
+static void BM_MakeSharedArrayForOverwrite(benchmark::State &state)
+{
+    auto size = static_cast<size_t>(state.range(0));
+    auto before = BenchmarkSupport::allocationCount();
+    for (auto _ : state)
+    {
+        auto buffer = make_shared_array_for_overwrite<double, 64>(size);
+        benchmark::DoNotOptimize(buffer.get());
+    }
+    reportAllocations(state, before);
+    state.SetBytesProcessed(state.iterations() * size * sizeof(double));
+}
+BENCHMARK(BM_MakeSharedArrayForOverwrite)->Arg(64)->Arg(4096)->Arg(1 << 18);
+
+static void BM_StdMakeSharedArray(benchmark::State &state)
+{
+    auto size = static_cast<size_t>(state.range(0));
+    auto before = BenchmarkSupport::allocationCount();
+    for (auto _ : state)
+    {
+        auto buffer = std::make_shared<double[]>(size);
+        benchmark::DoNotOptimize(buffer.get());
+    }
+    reportAllocations(state, before);
+    state.SetBytesProcessed(state.iterations() * size * sizeof(double));
+}
+BENCHMARK(BM_StdMakeSharedArray)->Arg(64)->Arg(4096)->Arg(1 << 18);
+
+// --- Per-request object graphs: global heap vs a monotonic arena ---
+namespace
+{
+    constexpr int requestObjects = 1024;
+}
+
+static void BM_RequestGraph_Heap(benchmark::State &state)
+{
+    std::vector<LockFreeSharedWithWeakPtr<Payload>> graph;
+    graph.reserve(requestObjects);
+    for (auto _ : state)
+    {
+        for (int i = 0; i < requestObjects; ++i)
+        {
+            graph.push_back(make_shared_custom<Payload>(i));
+        }
+        graph.clear();
+    }
+    state.SetItemsProcessed(state.iterations() * requestObjects);
+}
+BENCHMARK(BM_RequestGraph_Heap);
+
+static void BM_RequestGraph_MonotonicArena(benchmark::State &state)
+{
+    std::vector<LockFreeSharedWithWeakPtr<Payload>> graph;
+    graph.reserve(requestObjects);
+    // Sized for a whole request, so release() only rewinds the buffer
+    std::vector<std::byte> buffer(requestObjects * 128);
+    std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+    for (auto _ : state)
+    {
+        for (int i = 0; i < requestObjects; ++i)
+        {
+            graph.push_back(allocate_shared_pmr<Payload>(&arena, i));
+        }
+        graph.clear();
+        // Every block goes back at once
+        arena.release();
+    }
+    state.SetItemsProcessed(state.iterations() * requestObjects);
+}
+BENCHMARK(BM_RequestGraph_MonotonicArena);
+
+// --- Read-only fan-out through six call layers ---
+// The handle is passed down and read at every layer: by value (a count
+// round trip per layer), by const reference (a reload of the pointer per
+// read) or as a SharedRef (two plain pointers). Contended runs share one
+// owner, as hot configuration objects are.
+namespace
+{
+    constexpr int fanOutDepth = 6;
+    LockFreeSharedWithWeakPtr<Payload> fanOutOwner = make_shared_custom<Payload>(1);
+
+    [[gnu::noinline]] int byValue(LockFreeSharedWithWeakPtr<Payload> ptr, int depth)
+    {
+        return depth == 0 ? ptr->value : ptr->value + byValue(ptr, depth - 1);
+    }
+
+    [[gnu::noinline]] int byConstRef(const LockFreeSharedWithWeakPtr<Payload> &ptr, int depth)
+    {
+        return depth == 0 ? ptr->value : ptr->value + byConstRef(ptr, depth - 1);
+    }
+
+    [[gnu::noinline]] int byBorrow(SharedRef<Payload> ref, int depth)
+    {
+        return depth == 0 ? ref->value : ref->value + byBorrow(ref, depth - 1);
+    }
+}
+
+static void BM_FanOut_ByValue(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(byValue(fanOutOwner, fanOutDepth));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FanOut_ByValue)->ThreadRange(1, numcpu)->UseRealTime();
+
+static void BM_FanOut_ByConstRef(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(byConstRef(fanOutOwner, fanOutDepth));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FanOut_ByConstRef)->ThreadRange(1, numcpu)->UseRealTime();
+
+static void BM_FanOut_SharedRef(benchmark::State &state)
+{
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(byBorrow(fanOutOwner, fanOutDepth));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FanOut_SharedRef)->ThreadRange(1, numcpu)->UseRealTime();
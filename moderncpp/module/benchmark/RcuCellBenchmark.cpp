@@ -0,0 +1,71 @@
+#include <benchmark/benchmark.h>
+#include <array>
+
+import leonrahul.RcuCell;
+
+using namespace std;
+using ThreadSafeWorld::LockFreeSharedPtr;
+using ThreadSafeWorld::RcuCell;
+using ThreadSafeWorld::RcuReadGuard;
+
+// Readers look up one entry of a read-mostly table, either inside an RCU
+// read section or through a counted copy of the pointer, at 1-64 threads
+namespace
+{
+    struct RoutingTable
+    {
+        array<int, 64> routes{};
+        explicit RoutingTable(int version = 0) { routes.fill(version); }
+    };
+
+    RcuCell<RoutingTable> rcuTable(LockFreeSharedPtr<RoutingTable>(new RoutingTable(1)));
+    LockFreeSharedPtr<RoutingTable> sharedTable(new RoutingTable(1));
+}
+
+static void BM_RcuCell_Read(benchmark::State &state)
+{
+    size_t i = state.thread_index();
+    for (auto _ : state)
+    {
+        RcuReadGuard guard;
+        benchmark::DoNotOptimize(rcuTable.read(guard)->routes[++i % 64]);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RcuCell_Read)->ThreadRange(1, 64)->UseRealTime();
+
+static void BM_LockFreeSharedPtr_CopyRead(benchmark::State &state)
+{
+    size_t i = state.thread_index();
+    for (auto _ : state)
+    {
+        LockFreeSharedPtr<RoutingTable> copy(sharedTable);
+        benchmark::DoNotOptimize(copy->routes[++i % 64]);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LockFreeSharedPtr_CopyRead)->ThreadRange(1, 64)->UseRealTime();
+
+// Thread 0 keeps publishing new versions while the others read
+static void BM_RcuCell_ReadWithWriter(benchmark::State &state)
+{
+    if (state.thread_index() == 0)
+    {
+        int version = 0;
+        for (auto _ : state)
+        {
+            rcuTable.publish(LockFreeSharedPtr<RoutingTable>(new RoutingTable(++version)));
+        }
+    }
+    else
+    {
+        size_t i = state.thread_index();
+        for (auto _ : state)
+        {
+            RcuReadGuard guard;
+            benchmark::DoNotOptimize(rcuTable.read(guard)->routes[++i % 64]);
+        }
+        state.SetItemsProcessed(state.iterations());
+    }
+}
+BENCHMARK(BM_RcuCell_ReadWithWriter)->ThreadRange(2, 64)->UseRealTime();
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+#include <benchmark/benchmark.h>
+
+#include "AllocationCounter.h"
+
+// Bodies of the shared-pointer comparison suite. Each
+// SharedPtrComparison*Benchmark.cpp file runs them for one implementation,
+// since the modules export clashing names and cannot share a translation
+// unit. Every benchmark is named BM_Compare<Operation>_<Implementation>, so
+// filtering on BM_Compare<Operation> lines the implementations up.
+//
+// The contended cases follow Chapter06/03b_shared_ptr_mbm.C and
+// 04b_atomic_shared_ptr_mbm.C: every thread works on one global pointer,
+// from one thread up to all hardware threads, timed in real time.
+namespace BenchmarkSupport
+{
+    struct ComparePayload
+    {
+        int value;
+        int member = 7;
+        explicit ComparePayload(int v = 0) : value(v) {}
+    };
+
+    inline const int compareThreads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    inline void reportCompareAllocations(benchmark::State &state, size_t before)
+    {
+        state.counters["allocs_per_iter"] = benchmark::Counter(
+            static_cast<double>(allocationCount() - before), benchmark::Counter::kAvgIterations);
+        state.SetItemsProcessed(state.iterations());
+    }
+
+    // Creates and destroys an object; make returns a fresh owning pointer
+    template <typename Make>
+    void compareConstruct(benchmark::State &state, Make make)
+    {
+        auto before = allocationCount();
+        for (auto _ : state)
+        {
+            auto ptr = make();
+            benchmark::DoNotOptimize(ptr.get());
+        }
+        reportCompareAllocations(state, before);
+    }
+
+    // Copies and destroys the copy: one increment and one decrement. Run
+    // from several threads on one source, this is the contended copy.
+    template <typename Ptr>
+    void compareCopy(benchmark::State &state, const Ptr &source)
+    {
+        auto before = allocationCount();
+        for (auto _ : state)
+        {
+            Ptr copy(source);
+            benchmark::DoNotOptimize(copy->value);
+        }
+        reportCompareAllocations(state, before);
+    }
+
+    // Moves ownership back and forth without touching the counts
+    template <typename Ptr>
+    void compareMove(benchmark::State &state, Ptr source)
+    {
+        auto before = allocationCount();
+        for (auto _ : state)
+        {
+            Ptr moved(std::move(source));
+            source = std::move(moved);
+            benchmark::DoNotOptimize(source.get());
+        }
+        reportCompareAllocations(state, before);
+    }
+
+    template <typename Weak>
+    void compareWeakLock(benchmark::State &state, const Weak &weak)
+    {
+        auto before = allocationCount();
+        for (auto _ : state)
+        {
+            auto locked = weak.lock();
+            benchmark::DoNotOptimize(locked.get());
+        }
+        reportCompareAllocations(state, before);
+    }
+
+    // Points a new owner at a member of the owner's object
+    template <typename Ptr, typename Alias>
+    void compareAlias(benchmark::State &state, const Ptr &owner, Alias alias)
+    {
+        auto before = allocationCount();
+        for (auto _ : state)
+        {
+            auto member = alias(owner);
+            benchmark::DoNotOptimize(member.get());
+        }
+        reportCompareAllocations(state, before);
+    }
+
+    // Reads a published pointer out of an atomic slot; load returns an owner
+    template <typename Load>
+    void compareSlotLoad(benchmark::State &state, Load load)
+    {
+        auto before = allocationCount();
+        for (auto _ : state)
+        {
+            auto current = load();
+            benchmark::DoNotOptimize(current->value);
+        }
+        reportCompareAllocations(state, before);
+    }
+}
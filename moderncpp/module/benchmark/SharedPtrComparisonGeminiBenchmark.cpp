@@ -0,0 +1,43 @@
+#include <benchmark/benchmark.h>
+#include <utility>
+
+#include "SharedPtrComparison.h"
+
+import leonrahul.LockFreeSharedPtrGemini;
+
+using ThreadSafeWorld::LockFreeSharedPtrGemini;
+using ThreadSafeWorld::make_lock_free_shared;
+using namespace BenchmarkSupport;
+
+// --- Comparison suite: LockFreeSharedPtrGemini ---
+// Its weak pointer is declared but not implemented and it has no aliasing
+// constructor, so those rows are missing here.
+namespace
+{
+    LockFreeSharedPtrGemini<ComparePayload> geminiSource = make_lock_free_shared<ComparePayload>(42);
+}
+
+static void BM_CompareConstruct_LockFreeSharedPtrGemini(benchmark::State &state)
+{
+    compareConstruct(state, []
+                     { return make_lock_free_shared<ComparePayload>(1); });
+}
+BENCHMARK(BM_CompareConstruct_LockFreeSharedPtrGemini);
+
+static void BM_CompareCopy_LockFreeSharedPtrGemini(benchmark::State &state)
+{
+    compareCopy(state, geminiSource);
+}
+BENCHMARK(BM_CompareCopy_LockFreeSharedPtrGemini);
+
+static void BM_CompareMove_LockFreeSharedPtrGemini(benchmark::State &state)
+{
+    compareMove(state, make_lock_free_shared<ComparePayload>(1));
+}
+BENCHMARK(BM_CompareMove_LockFreeSharedPtrGemini);
+
+static void BM_CompareContendedCopy_LockFreeSharedPtrGemini(benchmark::State &state)
+{
+    compareCopy(state, geminiSource);
+}
+BENCHMARK(BM_CompareContendedCopy_LockFreeSharedPtrGemini)->ThreadRange(1, compareThreads)->UseRealTime();
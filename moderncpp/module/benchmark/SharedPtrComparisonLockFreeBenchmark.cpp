@@ -0,0 +1,42 @@
+#include <benchmark/benchmark.h>
+#include <utility>
+
+#include "SharedPtrComparison.h"
+
+import leonrahul.LockFreeSharedPtr;
+
+using ThreadSafeWorld::LockFreeSharedPtr;
+using namespace BenchmarkSupport;
+
+// --- Comparison suite: LockFreeSharedPtr ---
+// It has no weak pointer and no aliasing constructor, so those rows are
+// missing here.
+namespace
+{
+    LockFreeSharedPtr<ComparePayload> lockFreeSource{new ComparePayload(42)};
+}
+
+static void BM_CompareConstruct_LockFreeSharedPtr(benchmark::State &state)
+{
+    compareConstruct(state, []
+                     { return LockFreeSharedPtr<ComparePayload>(new ComparePayload(1)); });
+}
+BENCHMARK(BM_CompareConstruct_LockFreeSharedPtr);
+
+static void BM_CompareCopy_LockFreeSharedPtr(benchmark::State &state)
+{
+    compareCopy(state, lockFreeSource);
+}
+BENCHMARK(BM_CompareCopy_LockFreeSharedPtr);
+
+static void BM_CompareMove_LockFreeSharedPtr(benchmark::State &state)
+{
+    compareMove(state, LockFreeSharedPtr<ComparePayload>(new ComparePayload(1)));
+}
+BENCHMARK(BM_CompareMove_LockFreeSharedPtr);
+
+static void BM_CompareContendedCopy_LockFreeSharedPtr(benchmark::State &state)
+{
+    compareCopy(state, lockFreeSource);
+}
+BENCHMARK(BM_CompareContendedCopy_LockFreeSharedPtr)->ThreadRange(1, compareThreads)->UseRealTime();
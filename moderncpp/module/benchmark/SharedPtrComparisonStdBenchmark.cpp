@@ -0,0 +1,66 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <memory>
+
+#include "SharedPtrComparison.h"
+
+using namespace BenchmarkSupport;
+
+// --- Comparison suite: std::shared_ptr and std::atomic<std::shared_ptr> ---
+// libc++ has no std::atomic<std::shared_ptr> specialization yet, so the
+// contended-load row is absent there
+namespace
+{
+    std::shared_ptr<ComparePayload> stdSource = std::make_shared<ComparePayload>(42);
+    std::weak_ptr<ComparePayload> stdWeak = stdSource;
+#if defined(__cpp_lib_atomic_shared_ptr)
+    std::atomic<std::shared_ptr<ComparePayload>> stdSlot{std::make_shared<ComparePayload>(42)};
+#endif
+}
+
+static void BM_CompareConstruct_StdSharedPtr(benchmark::State &state)
+{
+    compareConstruct(state, []
+                     { return std::make_shared<ComparePayload>(1); });
+}
+BENCHMARK(BM_CompareConstruct_StdSharedPtr);
+
+static void BM_CompareCopy_StdSharedPtr(benchmark::State &state)
+{
+    compareCopy(state, stdSource);
+}
+BENCHMARK(BM_CompareCopy_StdSharedPtr);
+
+static void BM_CompareMove_StdSharedPtr(benchmark::State &state)
+{
+    compareMove(state, std::make_shared<ComparePayload>(1));
+}
+BENCHMARK(BM_CompareMove_StdSharedPtr);
+
+static void BM_CompareWeakLock_StdSharedPtr(benchmark::State &state)
+{
+    compareWeakLock(state, stdWeak);
+}
+BENCHMARK(BM_CompareWeakLock_StdSharedPtr);
+
+static void BM_CompareAlias_StdSharedPtr(benchmark::State &state)
+{
+    compareAlias(state, stdSource, [](const std::shared_ptr<ComparePayload> &owner)
+                 { return std::shared_ptr<int>(owner, &owner->member); });
+}
+BENCHMARK(BM_CompareAlias_StdSharedPtr);
+
+static void BM_CompareContendedCopy_StdSharedPtr(benchmark::State &state)
+{
+    compareCopy(state, stdSource);
+}
+BENCHMARK(BM_CompareContendedCopy_StdSharedPtr)->ThreadRange(1, compareThreads)->UseRealTime();
+
+#if defined(__cpp_lib_atomic_shared_ptr)
+static void BM_CompareContendedLoad_StdAtomicSharedPtr(benchmark::State &state)
+{
+    compareSlotLoad(state, []
+                    { return stdSlot.load(std::memory_order_acquire); });
+}
+BENCHMARK(BM_CompareContendedLoad_StdAtomicSharedPtr)->ThreadRange(1, compareThreads)->UseRealTime();
+#endif
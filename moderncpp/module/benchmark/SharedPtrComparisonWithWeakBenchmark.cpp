@@ -0,0 +1,65 @@
+#include <benchmark/benchmark.h>
+#include <utility>
+
+#include "SharedPtrComparison.h"
+
+import leonrahul.LockFreeSharedWithWeakPtr;
+
+using ThreadSafeWorld::AtomicLockFreeSharedPtr;
+using ThreadSafeWorld::LockFreeSharedWithWeakPtr;
+using ThreadSafeWorld::LockFreeWeakPtr;
+using ThreadSafeWorld::make_shared_custom;
+using namespace BenchmarkSupport;
+
+// --- Comparison suite: LockFreeSharedWithWeakPtr and its atomic slot ---
+namespace
+{
+    LockFreeSharedWithWeakPtr<ComparePayload> withWeakSource = make_shared_custom<ComparePayload>(42);
+    LockFreeWeakPtr<ComparePayload> withWeakWeak(withWeakSource);
+    AtomicLockFreeSharedPtr<ComparePayload> withWeakSlot{make_shared_custom<ComparePayload>(42)};
+}
+
+static void BM_CompareConstruct_LockFreeSharedWithWeakPtr(benchmark::State &state)
+{
+    compareConstruct(state, []
+                     { return make_shared_custom<ComparePayload>(1); });
+}
+BENCHMARK(BM_CompareConstruct_LockFreeSharedWithWeakPtr);
+
+static void BM_CompareCopy_LockFreeSharedWithWeakPtr(benchmark::State &state)
+{
+    compareCopy(state, withWeakSource);
+}
+BENCHMARK(BM_CompareCopy_LockFreeSharedWithWeakPtr);
+
+static void BM_CompareMove_LockFreeSharedWithWeakPtr(benchmark::State &state)
+{
+    compareMove(state, make_shared_custom<ComparePayload>(1));
+}
+BENCHMARK(BM_CompareMove_LockFreeSharedWithWeakPtr);
+
+static void BM_CompareWeakLock_LockFreeSharedWithWeakPtr(benchmark::State &state)
+{
+    compareWeakLock(state, withWeakWeak);
+}
+BENCHMARK(BM_CompareWeakLock_LockFreeSharedWithWeakPtr);
+
+static void BM_CompareAlias_LockFreeSharedWithWeakPtr(benchmark::State &state)
+{
+    compareAlias(state, withWeakSource, [](const LockFreeSharedWithWeakPtr<ComparePayload> &owner)
+                 { return LockFreeSharedWithWeakPtr<int>(owner, &owner->member); });
+}
+BENCHMARK(BM_CompareAlias_LockFreeSharedWithWeakPtr);
+
+static void BM_CompareContendedCopy_LockFreeSharedWithWeakPtr(benchmark::State &state)
+{
+    compareCopy(state, withWeakSource);
+}
+BENCHMARK(BM_CompareContendedCopy_LockFreeSharedWithWeakPtr)->ThreadRange(1, compareThreads)->UseRealTime();
+
+static void BM_CompareContendedLoad_AtomicLockFreeSharedPtr(benchmark::State &state)
+{
+    compareSlotLoad(state, []
+                    { return withWeakSlot.load(); });
+}
+BENCHMARK(BM_CompareContendedLoad_AtomicLockFreeSharedPtr)->ThreadRange(1, compareThreads)->UseRealTime();
@@ -0,0 +1,132 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../include/CustomString.h"
+
+import leonrahul.StringInternPool;
+
+using namespace StringWorld;
+
+// Metric names looked up in a hash map by their characters and by their
+// interned handles, and the cost of interning a name that is already in
+// the pool from several threads
+namespace
+{
+    constexpr size_t name_count = 256;
+    const int numcpu = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    const std::vector<std::string> &metricNames()
+    {
+        static const std::vector<std::string> names = []
+        {
+            std::vector<std::string> n;
+            for (size_t i = 0; i < name_count; ++i)
+            {
+                n.push_back("service.http.request.latency.bucket_" + std::to_string(i));
+            }
+            return n;
+        }();
+        return names;
+    }
+}
+
+static void BM_StringKeyedMap_Lookup(benchmark::State &state)
+{
+    std::unordered_map<std::string, int> counts;
+    for (const auto &name : metricNames())
+    {
+        counts[name] = 0;
+    }
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        ++counts.find(metricNames()[++i % name_count])->second;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StringKeyedMap_Lookup);
+
+static void BM_InternedKeyedMap_Lookup(benchmark::State &state)
+{
+    StringInternPool pool;
+    std::vector<InternedString> handles;
+    std::unordered_map<InternedString, int> counts;
+    for (const auto &name : metricNames())
+    {
+        handles.push_back(pool.intern(name.c_str(), name.size()));
+        counts[handles.back()] = 0;
+    }
+    size_t i = 0;
+    for (auto _ : state)
+    {
+        ++counts.find(handles[++i % name_count])->second;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_InternedKeyedMap_Lookup);
+
+static void BM_CustomString_Equal(benchmark::State &state)
+{
+    CustomString a(metricNames()[7].c_str());
+    CustomString b(metricNames()[7].c_str());
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(a.size() == b.size() && std::memcmp(a.c_str(), b.c_str(), a.size()) == 0);
+    }
+}
+BENCHMARK(BM_CustomString_Equal);
+
+static void BM_InternedString_Equal(benchmark::State &state)
+{
+    InternedString a = StringInternPool::global().intern(metricNames()[7].c_str());
+    InternedString b = StringInternPool::global().intern(CustomString(metricNames()[7].c_str()));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(a == b);
+    }
+}
+BENCHMARK(BM_InternedString_Equal);
+
+// The lock-free path: every name is already interned
+static void BM_StringInternPool_InternHit(benchmark::State &state)
+{
+    static StringInternPool pool;
+    if (state.thread_index() == 0)
+    {
+        for (const auto &name : metricNames())
+        {
+            pool.intern(name.c_str(), name.size());
+        }
+    }
+    size_t i = state.thread_index();
+    for (auto _ : state)
+    {
+        const std::string &name = metricNames()[++i % name_count];
+        benchmark::DoNotOptimize(pool.intern(name.c_str(), name.size()));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StringInternPool_InternHit)->ThreadRange(1, numcpu)->UseRealTime();
+
+// Interns a CustomStringArray into an empty pool, one lock per shard
+static void BM_StringInternPool_BulkIntern(benchmark::State &state)
+{
+    CustomStringArray names;
+    for (const auto &name : metricNames())
+    {
+        names.add(name.c_str());
+    }
+    for (auto _ : state)
+    {
+        StringInternPool pool;
+        auto handles = pool.intern(names);
+        benchmark::DoNotOptimize(handles.data());
+    }
+    state.SetItemsProcessed(state.iterations() * name_count);
+}
+BENCHMARK(BM_StringInternPool_BulkIntern);
@@ -0,0 +1,116 @@
+#include <benchmark/benchmark.h>
+#include <string>
+
+#include "../include/StringKernels.h"
+
+using StringKernels::Level;
+using StringKernels::Table;
+
+// Each kernel at each level over buffers from 8 bytes to 1 MB. The inputs
+// make every kernel scan the whole buffer: the terminator, the only
+// difference, the needle and the set byte all sit at the very end.
+namespace
+{
+    const Table *tableOrSkip(benchmark::State &state, Level level)
+    {
+        const Table *table = StringKernels::forLevel(level);
+        if (table == nullptr)
+        {
+            state.SkipWithError("not supported on this CPU");
+        }
+        return table;
+    }
+
+    std::string filler(size_t n)
+    {
+        std::string s(n, 'a');
+        for (size_t i = 0; i < n; i += 7)
+        {
+            s[i] = 'b';
+        }
+        return s;
+    }
+
+    void reportBytes(benchmark::State &state)
+    {
+        state.SetBytesProcessed(state.iterations() * state.range(0));
+    }
+}
+
+static void BM_StringKernels_Length(benchmark::State &state, Level level)
+{
+    const Table *table = tableOrSkip(state, level);
+    std::string s = filler(state.range(0));
+    for (auto _ : state)
+    {
+        if (table == nullptr)
+        {
+            break;
+        }
+        benchmark::DoNotOptimize(table->length(s.c_str()));
+    }
+    reportBytes(state);
+}
+
+static void BM_StringKernels_Compare(benchmark::State &state, Level level)
+{
+    const Table *table = tableOrSkip(state, level);
+    std::string a = filler(state.range(0));
+    std::string b = a;
+    b.back() = 'z';
+    for (auto _ : state)
+    {
+        if (table == nullptr)
+        {
+            break;
+        }
+        benchmark::DoNotOptimize(table->compare(a.data(), a.size(), b.data(), b.size()));
+    }
+    reportBytes(state);
+}
+
+static void BM_StringKernels_Find(benchmark::State &state, Level level)
+{
+    const Table *table = tableOrSkip(state, level);
+    std::string haystack = filler(state.range(0));
+    // starts and ends like much of the filler, to make candidates
+    std::string needle = "abaz";
+    haystack.replace(haystack.size() - needle.size(), needle.size(), needle);
+    for (auto _ : state)
+    {
+        if (table == nullptr)
+        {
+            break;
+        }
+        benchmark::DoNotOptimize(table->find(haystack.data(), haystack.size(), needle.data(), needle.size()));
+    }
+    reportBytes(state);
+}
+
+static void BM_StringKernels_FindFirstOf(benchmark::State &state, Level level)
+{
+    const Table *table = tableOrSkip(state, level);
+    std::string s = filler(state.range(0));
+    s.back() = ';';
+    const char set[] = " \t;=&";
+    for (auto _ : state)
+    {
+        if (table == nullptr)
+        {
+            break;
+        }
+        benchmark::DoNotOptimize(table->findFirstOf(s.data(), s.size(), set, sizeof(set) - 1));
+    }
+    reportBytes(state);
+}
+
+#define STRING_KERNEL_BENCHMARKS(kernel)                                                   \
+    BENCHMARK_CAPTURE(kernel, scalar, Level::Scalar)->RangeMultiplier(8)->Range(8, 1 << 20); \
+    BENCHMARK_CAPTURE(kernel, sse2, Level::SSE2)->RangeMultiplier(8)->Range(8, 1 << 20);     \
+    BENCHMARK_CAPTURE(kernel, avx2, Level::AVX2)->RangeMultiplier(8)->Range(8, 1 << 20);     \
+    BENCHMARK_CAPTURE(kernel, avx512, Level::AVX512)->RangeMultiplier(8)->Range(8, 1 << 20)
+
+STRING_KERNEL_BENCHMARKS(BM_StringKernels_Length);
+STRING_KERNEL_BENCHMARKS(BM_StringKernels_Compare);
+STRING_KERNEL_BENCHMARKS(BM_StringKernels_Find);
+STRING_KERNEL_BENCHMARKS(BM_StringKernels_FindFirstOf);
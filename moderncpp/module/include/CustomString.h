@@ -0,0 +1,344 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <array>
+#include <compare>
+#include <concepts>
+#include <ostream>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+#include "StringKernels.h"
+
+// Owning, null-terminated string. A string built from nullptr is "null":
+// c_str() returns nullptr, indexing throws, and streaming or adding it
+// throws, which sets it apart from the empty string "".
+//
+// Small-string optimization: strings of up to inline_capacity characters
+// are stored inside the 24-byte object and never allocate. The last byte
+// of the object is a tag. Its top bit selects heap storage, in which case
+// the first 16 bytes hold the heap pointer and the length; otherwise the
+// tag is the inline length, or null_tag for a null string.
+//
+// Copy-on-write is opt-in: share() moves a heap string into a reference
+// counted buffer, and from then on copies of it share that buffer and
+// only bump an atomic count. Writing through the non-const operator[]
+// first gives the string a private copy again, so a reference it returns
+// can never change another string; read shared strings through a const
+// reference to keep the sharing. Inline strings are cheaper to copy
+// than to count, so share() leaves them as they are.
+template <size_t N>
+class CustomStringConcat;
+
+class CustomString
+{
+public:
+    static constexpr size_t inline_capacity = 22;
+    static constexpr size_t npos = StringKernels::npos;
+
+    CustomString() noexcept
+    {
+        setNull();
+    }
+
+    CustomString(const char* other);
+
+    // Concatenation of two C strings; nullptr counts as ""
+    CustomString(const char* ptr1, const char* ptr2);
+
+    // The first l characters of ptr
+    CustomString(const char* ptr, size_t l);
+
+    CustomString(const CustomString& other);
+    CustomString(CustomString&& other) noexcept;
+    ~CustomString();
+
+    CustomString& operator=(const CustomString& other);
+    CustomString& operator=(CustomString&& other) noexcept;
+
+    char& operator[](size_t index)
+    {
+        if (index >= size())
+        {
+            throw std::out_of_range{"index out of range"};
+        }
+        if (isShared())
+        {
+            detach();
+        }
+        return data()[index];
+    }
+
+    const char& operator[](size_t index) const
+    {
+        if (index >= size())
+        {
+            throw std::out_of_range{"index out of range"};
+        }
+        return data()[index];
+    }
+
+    size_t size() const noexcept
+    {
+        if (isHeap())
+        {
+            return heapSize();
+        }
+        return tag() == null_tag ? 0 : tag();
+    }
+
+    const char* c_str() const noexcept
+    {
+        return tag() == null_tag ? nullptr : data();
+    }
+
+    const char* operator*() const noexcept
+    {
+        return c_str();
+    }
+
+    // True while the characters live inside the object
+    bool isInline() const noexcept
+    {
+        return !isHeap() && tag() != null_tag;
+    }
+
+    // Moves a heap string into a shared buffer for cheap copies; see above
+    void share();
+
+    bool isShared() const noexcept
+    {
+        return tag() == shared_tag;
+    }
+
+    // Strings sharing this one's buffer, itself included; 1 when unshared
+    size_t useCount() const noexcept;
+
+    // Negative, zero or positive as this string sorts before, with or after
+    // other, byte by byte as unsigned; a null string sorts before all others
+    int compare(const CustomString& other) const noexcept;
+
+    friend bool operator==(const CustomString& a, const CustomString& b) noexcept
+    {
+        if (a.c_str() == nullptr || b.c_str() == nullptr)
+        {
+            return a.c_str() == b.c_str();
+        }
+        return StringKernels::equal(a.data(), a.size(), b.data(), b.size());
+    }
+
+    friend std::strong_ordering operator<=>(const CustomString& a, const CustomString& b) noexcept
+    {
+        return a.compare(b) <=> 0;
+    }
+
+    // Position of the first needle at or after from, or npos
+    size_t find(std::string_view needle, size_t from = 0) const noexcept;
+
+    // Position of the first character at or after from that is in set, or npos
+    size_t findFirstOf(std::string_view set, size_t from = 0) const noexcept;
+
+    // Drops the first character; "" and null strings stay as they are
+    CustomString& operator++();
+    CustomString operator++(int);
+
+    friend std::ostream& operator<<(std::ostream& os, const CustomString& val);
+
+    template <size_t N>
+    friend class CustomStringConcat;
+
+private:
+    static constexpr size_t rep_size = 24;
+    static constexpr size_t tag_index = rep_size - 1;
+    static constexpr unsigned char heap_flag = 0x80;
+    static constexpr unsigned char null_tag = 0x7F;
+    // Heap storage whose buffer follows a reference count
+    static constexpr unsigned char shared_tag = heap_flag | 0x40;
+
+    // Pointer and length are copied in and out with memcpy, which compiles
+    // to plain loads and stores and keeps the byte array the only member
+    alignas(char*) unsigned char rep[rep_size];
+
+    unsigned char tag() const noexcept
+    {
+        return rep[tag_index];
+    }
+
+    bool isHeap() const noexcept
+    {
+        return (tag() & heap_flag) != 0;
+    }
+
+    char* heapPtr() const noexcept
+    {
+        char* p;
+        std::memcpy(&p, rep, sizeof(p));
+        return p;
+    }
+
+    size_t heapSize() const noexcept
+    {
+        size_t n;
+        std::memcpy(&n, rep + sizeof(char*), sizeof(n));
+        return n;
+    }
+
+    char* data() noexcept
+    {
+        return isHeap() ? heapPtr() : reinterpret_cast<char*>(rep);
+    }
+
+    const char* data() const noexcept
+    {
+        return isHeap() ? heapPtr() : reinterpret_cast<const char*>(rep);
+    }
+
+    void setNull() noexcept
+    {
+        rep[0] = '\0';
+        rep[tag_index] = null_tag;
+    }
+
+    // Sets up storage for n characters plus the terminator, which is
+    // written here, and returns where the characters go
+    char* allocate(size_t n);
+
+    void copy(const char* other);
+    void copy(const char* other, size_t n);
+    void destroy();
+
+    // Trades a shared buffer for a private copy
+    void detach();
+
+    // The pieces joined, in one allocation of total characters
+    CustomString(const std::string_view* pieces, size_t count, size_t total);
+};
+
+// Concatenation with operator+ is lazy: a + b + c builds a
+// CustomStringConcat that records a view of every operand, and converting
+// it to a CustomString allocates once, for the total length, and copies
+// each piece once. Operands can be CustomStrings, C strings or anything
+// convertible to std::string_view, as long as one of the first two
+// operands is a CustomString. A null CustomString or C string throws
+// std::logic_error as soon as it is added.
+//
+// The views point into the operands, so an expression must be converted
+// before they go away. Temporaries last to the end of the full
+// expression, which covers CustomString s = a + CustomString(x); keeping
+// the expression itself, as in auto e = a + b, does not extend them.
+inline std::string_view concatView(const CustomString& piece)
+{
+    if (piece.c_str() == nullptr)
+    {
+        throw std::logic_error{"one of the string has null ptr"};
+    }
+    return {piece.c_str(), piece.size()};
+}
+
+inline std::string_view concatView(const char* piece)
+{
+    if (piece == nullptr)
+    {
+        throw std::logic_error{"one of the string has null ptr"};
+    }
+    return piece;
+}
+
+inline std::string_view concatView(std::string_view piece) noexcept
+{
+    return piece;
+}
+
+template <typename T>
+inline constexpr bool isCustomStringConcat = false;
+
+template <size_t N>
+inline constexpr bool isCustomStringConcat<CustomStringConcat<N>> = true;
+
+template <typename T>
+concept ConcatOperand = !isCustomStringConcat<std::remove_cvref_t<T>> &&
+                        requires(const T& piece) { concatView(piece); };
+
+template <size_t N>
+class CustomStringConcat
+{
+public:
+    explicit CustomStringConcat(const std::array<std::string_view, N>& pieces) noexcept
+        : pieces_{pieces}
+    {
+        for (std::string_view piece : pieces_)
+        {
+            total_ += piece.size();
+        }
+    }
+
+    size_t size() const noexcept
+    {
+        return total_;
+    }
+
+    const std::array<std::string_view, N>& pieces() const noexcept
+    {
+        return pieces_;
+    }
+
+    CustomString str() const
+    {
+        return CustomString(pieces_.data(), N, total_);
+    }
+
+    operator CustomString() const
+    {
+        return str();
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const CustomStringConcat& expr)
+    {
+        for (std::string_view piece : expr.pieces_)
+        {
+            os.write(piece.data(), static_cast<std::streamsize>(piece.size()));
+        }
+        return os;
+    }
+
+private:
+    std::array<std::string_view, N> pieces_;
+    size_t total_ = 0;
+};
+
+template <ConcatOperand L, ConcatOperand R>
+    requires std::same_as<std::remove_cvref_t<L>, CustomString> || std::same_as<std::remove_cvref_t<R>, CustomString>
+CustomStringConcat<2> operator+(const L& first, const R& second)
+{
+    return CustomStringConcat<2>({concatView(first), concatView(second)});
+}
+
+template <size_t N, ConcatOperand R>
+CustomStringConcat<N + 1> operator+(const CustomStringConcat<N>& first, const R& second)
+{
+    std::array<std::string_view, N + 1> pieces;
+    std::copy(first.pieces().begin(), first.pieces().end(), pieces.begin());
+    pieces[N] = concatView(second);
+    return CustomStringConcat<N + 1>(pieces);
+}
+
+template <ConcatOperand L, size_t N>
+CustomStringConcat<N + 1> operator+(const L& first, const CustomStringConcat<N>& second)
+{
+    std::array<std::string_view, N + 1> pieces;
+    pieces[0] = concatView(first);
+    std::copy(second.pieces().begin(), second.pieces().end(), pieces.begin() + 1);
+    return CustomStringConcat<N + 1>(pieces);
+}
+
+template <size_t N, size_t M>
+CustomStringConcat<N + M> operator+(const CustomStringConcat<N>& first, const CustomStringConcat<M>& second)
+{
+    std::array<std::string_view, N + M> pieces;
+    std::copy(first.pieces().begin(), first.pieces().end(), pieces.begin());
+    std::copy(second.pieces().begin(), second.pieces().end(), pieces.begin() + N);
+    return CustomStringConcat<N + M>(pieces);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+
+// Byte-string kernels behind CustomString and CustomStringArray. Each one
+// has SSE2, AVX2 and AVX-512BW versions, and the best one the CPU supports
+// is picked at run time. The scalar versions work everywhere and define
+// the results the others must agree with.
+//
+// Only length() reads past the bytes it is given: it loads whole aligned
+// blocks, which never cross into another page, so it cannot fault.
+namespace StringKernels
+{
+    inline constexpr size_t npos = static_cast<size_t>(-1);
+
+    enum class Level
+    {
+        Scalar,
+        SSE2,
+        AVX2,
+        AVX512
+    };
+
+    struct Table
+    {
+        Level level;
+        const char* name;
+
+        // Characters before the first '\0'
+        size_t (*length)(const char* s);
+
+        // Negative, zero or positive as a sorts before, with or after b.
+        // Bytes compare as unsigned, and a proper prefix sorts first.
+        int (*compare)(const char* a, size_t an, const char* b, size_t bn);
+
+        // Whether the first n bytes of a and b match
+        bool (*equal)(const char* a, const char* b, size_t n);
+
+        // Position of the first occurrence of needle in haystack, or npos.
+        // An empty needle is found at 0.
+        size_t (*find)(const char* haystack, size_t hn, const char* needle, size_t nn);
+
+        // Position of the first byte of s that is one of the set bytes, or
+        // npos. Sets of up to 16 bytes are scanned with vectors, larger ones
+        // with a scalar lookup table.
+        size_t (*findFirstOf)(const char* s, size_t n, const char* set, size_t setSize);
+    };
+
+    // The best table for this CPU, chosen on first use
+    const Table& active();
+
+    // The table for level, or nullptr when the CPU or the build lacks it
+    const Table* forLevel(Level level);
+
+    inline size_t length(const char* s)
+    {
+        return active().length(s);
+    }
+
+    inline int compare(const char* a, size_t an, const char* b, size_t bn)
+    {
+        return active().compare(a, an, b, bn);
+    }
+
+    inline bool equal(const char* a, size_t an, const char* b, size_t bn)
+    {
+        return an == bn && active().equal(a, b, an);
+    }
+
+    inline size_t find(const char* haystack, size_t hn, const char* needle, size_t nn)
+    {
+        return active().find(haystack, hn, needle, nn);
+    }
+
+    inline size_t findFirstOf(const char* s, size_t n, const char* set, size_t setSize)
+    {
+        return active().findFirstOf(s, n, set, setSize);
+    }
+}
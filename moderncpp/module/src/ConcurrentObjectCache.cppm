@@ -0,0 +1,177 @@
+module;
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+export module leonrahul.ConcurrentObjectCache;
+export import leonrahul.LockFreeSharedWithWeakPtr;
+
+using namespace std;
+
+export namespace ThreadSafeWorld
+{
+    // Deduplicates heavyweight objects by key. get_or_create() hands out
+    // strong pointers, while the cache itself only keeps weak ones, so an
+    // object dies as soon as its last user drops it.
+    //
+    // Keys are spread over lock-striped buckets. A miss leaves a pending
+    // entry behind and runs the factory outside the lock; concurrent callers
+    // for the same key wait for that one result instead of building their
+    // own, and an exception thrown by the factory reaches all of them.
+    // Entries whose objects are gone are swept lazily: a stripe sweeps
+    // itself when inserting would grow it past twice its size after the
+    // previous sweep, which keeps the cost amortized O(1) per insert.
+    template <typename K, typename V, typename Hash = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+    class ConcurrentObjectCache
+    {
+    public:
+        using key_type = K;
+        using pointer = LockFreeSharedWithWeakPtr<V>;
+
+        static constexpr int stripe_bits = 5;
+        static constexpr size_t stripe_count = size_t{1} << stripe_bits;
+        static constexpr size_t min_sweep_size = 8;
+
+        ConcurrentObjectCache() = default;
+        ConcurrentObjectCache(const ConcurrentObjectCache &) = delete;
+        ConcurrentObjectCache &operator=(const ConcurrentObjectCache &) = delete;
+
+        // Returns the live object for key, or the one make() builds. make
+        // returns a pointer (or anything convertible to one) and must not
+        // ask this cache for the same key.
+        template <typename Factory>
+        pointer get_or_create(const K &key, Factory &&make)
+        {
+            Stripe &stripe = stripes[stripeOf(key)];
+            unique_lock<mutex> lock(stripe.access);
+            auto [it, inserted] = stripe.entries.try_emplace(key);
+            // Entries are map nodes, so the reference stays valid across
+            // rehashes; only sweeps erase, and they skip pending entries.
+            Entry &entry = it->second;
+            // Every path returns result, so the hit path copies nothing:
+            // the pointer has no move constructor and a copy costs an RMW
+            pointer result = inserted ? pointer() : entry.object.lock();
+            if (result)
+            {
+                return result;
+            }
+            if (entry.pending.valid())
+            {
+                shared_future<pointer> pending = entry.pending;
+                lock.unlock();
+                result = pending.get();
+                return result;
+            }
+
+            promise<pointer> created;
+            entry.pending = created.get_future().share();
+            if (inserted)
+            {
+                sweepIfDue(stripe);
+            }
+            lock.unlock();
+
+            try
+            {
+                result = std::forward<Factory>(make)();
+            }
+            catch (...)
+            {
+                lock.lock();
+                stripe.entries.erase(key);
+                lock.unlock();
+                created.set_exception(current_exception());
+                throw;
+            }
+
+            // Only the creator touches an entry while it is pending
+            lock.lock();
+            entry.object = LockFreeWeakPtr<V>(result);
+            entry.pending = shared_future<pointer>();
+            lock.unlock();
+            created.set_value(result);
+            return result;
+        }
+
+        // The live object for key, or null; never waits for one being made
+        pointer find(const K &key) const
+        {
+            const Stripe &stripe = stripes[stripeOf(key)];
+            lock_guard<mutex> lock(stripe.access);
+            auto it = stripe.entries.find(key);
+            return it == stripe.entries.end() ? pointer() : it->second.object.lock();
+        }
+
+        // Drops every entry whose object is gone. Returns how many.
+        size_t sweep()
+        {
+            size_t removed = 0;
+            for (Stripe &stripe : stripes)
+            {
+                lock_guard<mutex> lock(stripe.access);
+                removed += sweepLocked(stripe);
+            }
+            return removed;
+        }
+
+        // Entries held, including expired ones not swept yet
+        size_t size() const
+        {
+            size_t total = 0;
+            for (const Stripe &stripe : stripes)
+            {
+                lock_guard<mutex> lock(stripe.access);
+                total += stripe.entries.size();
+            }
+            return total;
+        }
+
+    private:
+        struct Entry
+        {
+            LockFreeWeakPtr<V> object;
+            // Valid while the object is being created
+            shared_future<pointer> pending;
+        };
+
+        struct alignas(64) Stripe
+        {
+            mutable mutex access;
+            unordered_map<K, Entry, Hash, KeyEqual> entries;
+            size_t sweep_at = min_sweep_size;
+        };
+
+        Stripe stripes[stripe_count];
+
+        // The map buckets on the same hash, so mix it before taking
+        // the top bits for the stripe
+        static size_t stripeOf(const K &key)
+        {
+            uint64_t mixed = static_cast<uint64_t>(Hash{}(key)) * 0x9E3779B97F4A7C15ull;
+            return static_cast<size_t>(mixed >> (64 - stripe_bits));
+        }
+
+        // Requires the stripe lock
+        static size_t sweepLocked(Stripe &stripe)
+        {
+            return erase_if(stripe.entries, [](const auto &item)
+                            { return !item.second.pending.valid() && item.second.object.expired(); });
+        }
+
+        // Requires the stripe lock
+        static void sweepIfDue(Stripe &stripe)
+        {
+            if (stripe.entries.size() <= stripe.sweep_at)
+            {
+                return;
+            }
+            sweepLocked(stripe);
+            stripe.sweep_at = max(min_sweep_size, 2 * stripe.entries.size());
+        }
+    };
+}
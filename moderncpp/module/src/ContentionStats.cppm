@@ -0,0 +1,207 @@
+module;
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+export module leonrahul.ContentionStats;
+
+using namespace std;
+
+export namespace ThreadSafeWorld
+{
+    // Set by the THREADSAFEWORLD_CONTENTION_STATS CMake option. When off,
+    // every record() call compiles to nothing and snapshot() reports zeros.
+#ifdef THREADSAFEWORLD_CONTENTION_STATS
+    inline constexpr bool contention_stats_enabled = true;
+#else
+    inline constexpr bool contention_stats_enabled = false;
+#endif
+
+    enum class ContentionEvent : uint8_t
+    {
+        CasFailure,     // a compare-exchange lost and the operation retried
+        SpinIteration,  // one pass of a wait loop that made no progress
+        Allocation,     // a control block was allocated
+        FinalRelease,   // the last strong reference to an object was dropped
+        Count
+    };
+
+    struct ContentionSnapshot
+    {
+        uint64_t cas_failures = 0;
+        uint64_t spin_iterations = 0;
+        uint64_t allocations = 0;
+        uint64_t final_releases = 0;
+
+        // What happened between an earlier snapshot and this one
+        ContentionSnapshot operator-(const ContentionSnapshot &earlier) const noexcept
+        {
+            return ContentionSnapshot{cas_failures - earlier.cas_failures,
+                                      spin_iterations - earlier.spin_iterations,
+                                      allocations - earlier.allocations,
+                                      final_releases - earlier.final_releases};
+        }
+    };
+
+    // Per-thread event counters for the lock-free pointers.
+    //
+    // Each thread bumps counters in its own cache-line sized record, which
+    // only that thread writes, so recording is a plain load and store with
+    // no RMW and no sharing. snapshot() sums every record. Records of
+    // exited threads keep their counts and are adopted by new threads.
+    class ContentionStats
+    {
+    public:
+        static void record(ContentionEvent event, uint64_t n = 1) noexcept
+        {
+            if constexpr (contention_stats_enabled)
+            {
+                Record *local = tls_record;
+                if (!local) [[unlikely]]
+                {
+                    if (!exited)
+                    {
+                        local = tls_record = acquireRecord();
+                    }
+                    // Threads past their holder's destructor, or that could
+                    // not get a record, count on the shared one instead
+                    if (!local)
+                    {
+                        orphans().counters[index(event)].fetch_add(n, memory_order_relaxed);
+                        return;
+                    }
+                    // Odr-use registers the holder's destructor for this thread
+                    static_cast<void>(&holder);
+                }
+                atomic<uint64_t> &counter = local->counters[index(event)];
+                counter.store(counter.load(memory_order_relaxed) + n, memory_order_relaxed);
+            }
+        }
+
+        // For loop conditions: counts a lost CAS and says whether to retry,
+        //   while (ContentionStats::casFailed(word.compare_exchange_weak(...)))
+        static bool casFailed(bool succeeded) noexcept
+        {
+            if (!succeeded)
+            {
+                record(ContentionEvent::CasFailure);
+            }
+            return !succeeded;
+        }
+
+        // Totals over all threads. Counts still being written by other
+        // threads may or may not be included.
+        static ContentionSnapshot snapshot() noexcept
+        {
+            ContentionSnapshot total;
+            if constexpr (contention_stats_enabled)
+            {
+                add(total, orphans());
+                for (Record *r = records.load(memory_order_acquire); r; r = r->next)
+                {
+                    add(total, *r);
+                }
+            }
+            return total;
+        }
+
+        // Zeroes every counter. Only exact while no instrumented operation
+        // runs; otherwise prefer the difference of two snapshots.
+        static void reset() noexcept
+        {
+            if constexpr (contention_stats_enabled)
+            {
+                clear(orphans());
+                for (Record *r = records.load(memory_order_acquire); r; r = r->next)
+                {
+                    clear(*r);
+                }
+            }
+        }
+
+    private:
+        static constexpr size_t event_count = static_cast<size_t>(ContentionEvent::Count);
+
+        struct alignas(64) Record
+        {
+            atomic<uint64_t> counters[event_count] = {};
+            atomic<bool> in_use{false};
+            Record *next = nullptr;
+        };
+
+        // Hands the record back at thread exit
+        struct RecordHolder
+        {
+            ~RecordHolder()
+            {
+                if (tls_record)
+                {
+                    tls_record->in_use.store(false, memory_order_release);
+                    tls_record = nullptr;
+                }
+                exited = true;
+            }
+        };
+
+        static inline atomic<Record *> records{nullptr};
+        static inline thread_local Record *tls_record = nullptr;
+        static inline thread_local bool exited = false;
+        static inline thread_local RecordHolder holder;
+
+        // Shared by threads without a record of their own
+        static Record &orphans() noexcept
+        {
+            static Record shared;
+            return shared;
+        }
+
+        static size_t index(ContentionEvent event) noexcept
+        {
+            return static_cast<size_t>(event);
+        }
+
+        static void add(ContentionSnapshot &total, const Record &r) noexcept
+        {
+            total.cas_failures += r.counters[index(ContentionEvent::CasFailure)].load(memory_order_relaxed);
+            total.spin_iterations += r.counters[index(ContentionEvent::SpinIteration)].load(memory_order_relaxed);
+            total.allocations += r.counters[index(ContentionEvent::Allocation)].load(memory_order_relaxed);
+            total.final_releases += r.counters[index(ContentionEvent::FinalRelease)].load(memory_order_relaxed);
+        }
+
+        static void clear(Record &r) noexcept
+        {
+            for (auto &counter : r.counters)
+            {
+                counter.store(0, memory_order_relaxed);
+            }
+        }
+
+        // Reuses the record of an exited thread when there is one. Recording
+        // happens on noexcept paths, so running out of memory gives null.
+        static Record *acquireRecord() noexcept
+        {
+            for (Record *r = records.load(memory_order_acquire); r; r = r->next)
+            {
+                bool expected = false;
+                if (!r->in_use.load(memory_order_relaxed) &&
+                    r->in_use.compare_exchange_strong(expected, true, memory_order_acquire))
+                {
+                    return r;
+                }
+            }
+
+            auto *r = new (nothrow) Record;
+            if (!r)
+            {
+                return nullptr;
+            }
+            r->in_use.store(true, memory_order_relaxed);
+            Record *head = records.load(memory_order_relaxed);
+            do
+            {
+                r->next = head;
+            } while (!records.compare_exchange_weak(head, r, memory_order_release, memory_order_relaxed));
+            return r;
+        }
+    };
+}
@@ -0,0 +1,277 @@
+module;
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+export module leonrahul.ControlBlockPool;
+
+using namespace std;
+
+export namespace ThreadSafeWorld
+{
+    // Size-class slab allocator for control blocks.
+    //
+    // Every thread owns a cache with one free list per 16-byte size class,
+    // refilled from 64 KiB slabs aligned to their size so any block finds its
+    // slab header by masking its address. A block freed by its owning thread
+    // goes straight back on the free list. Blocks freed elsewhere collect in
+    // a per-thread batch and are handed to the owner's remote list with a
+    // single push; the owner takes the whole remote list back when its own
+    // free list runs dry. Caches of exited threads are adopted by new ones,
+    // and slabs are kept for reuse rather than returned to the system: each
+    // cache links the slabs it carved, so they stay reachable from `caches`
+    // for the life of the process and leak checkers do not report them.
+    class ControlBlockPool
+    {
+    public:
+        static constexpr size_t granularity = 16;
+        static constexpr size_t size_classes = 16;
+        static constexpr size_t max_size = granularity * size_classes;
+        static constexpr size_t slab_size = 64 * 1024;
+        static constexpr size_t remote_batch = 32;
+
+        static void *allocate(size_t bytes)
+        {
+            if (bytes > max_size)
+            {
+                return ::operator new(bytes);
+            }
+            size_t index = classOf(bytes);
+            ThreadCache *cache = tls_cache;
+            if (!cache) [[unlikely]]
+            {
+                if (exited)
+                {
+                    // Borrow a cache for thread_local destructors that
+                    // still allocate, without holding on to it
+                    cache = acquireCache();
+                    void *block = take(*cache, index);
+                    cache->in_use.store(false, memory_order_release);
+                    return block;
+                }
+                cache = tls_cache = acquireCache();
+                // Odr-use registers the holder's destructor for this thread
+                static_cast<void>(&holder);
+            }
+            return take(*cache, index);
+        }
+
+        static void deallocate(void *p, size_t bytes) noexcept
+        {
+            if (bytes > max_size)
+            {
+                ::operator delete(p);
+                return;
+            }
+            auto *block = static_cast<FreeBlock *>(p);
+            ThreadCache *owner = slabOf(p)->owner;
+            if (owner == tls_cache) [[likely]]
+            {
+                size_t index = classOf(bytes);
+                block->next = owner->free_lists[index];
+                owner->free_lists[index] = block;
+                return;
+            }
+            freeRemote(owner, classOf(bytes), block);
+        }
+
+        // Hands blocks this thread freed for other threads to their owners
+        static void flush() noexcept
+        {
+            RemoteBatch &batch = localBatch();
+            if (batch.count == 0)
+            {
+                return;
+            }
+            atomic<FreeBlock *> &remote = batch.owner->remote[batch.index];
+            FreeBlock *head = remote.load(memory_order_relaxed);
+            do
+            {
+                batch.tail->next = head;
+            } while (!remote.compare_exchange_weak(head, batch.head, memory_order_release, memory_order_relaxed));
+            batch = RemoteBatch{};
+        }
+
+    private:
+        struct FreeBlock
+        {
+            FreeBlock *next;
+        };
+
+        struct ThreadCache;
+
+        struct alignas(64) SlabHeader
+        {
+            ThreadCache *owner;
+            SlabHeader *next; // the owner's previous slab
+        };
+
+        struct alignas(64) ThreadCache
+        {
+            // Touched only by the thread holding the cache
+            FreeBlock *free_lists[size_classes] = {};
+            // Blocks other threads freed, pushed in batches
+            atomic<FreeBlock *> remote[size_classes] = {};
+            atomic<bool> in_use{false};
+            ThreadCache *next = nullptr;
+            // Every slab carved for this cache, newest first
+            SlabHeader *slabs = nullptr;
+        };
+
+        // Consecutive foreign frees bound for the same owner and size class
+        struct RemoteBatch
+        {
+            ThreadCache *owner = nullptr;
+            size_t index = 0;
+            FreeBlock *head = nullptr;
+            FreeBlock *tail = nullptr;
+            size_t count = 0;
+        };
+
+        // Releases the cache at thread exit. The raw pointers below stay
+        // usable afterwards, so blocks freed by later thread_local
+        // destructors simply take the remote path.
+        struct CacheHolder
+        {
+            ~CacheHolder()
+            {
+                flush();
+                if (tls_cache)
+                {
+                    tls_cache->in_use.store(false, memory_order_release);
+                    tls_cache = nullptr;
+                }
+                exited = true;
+            }
+        };
+
+        static inline atomic<ThreadCache *> caches{nullptr};
+        static inline thread_local ThreadCache *tls_cache = nullptr;
+        static inline thread_local bool exited = false;
+        static inline thread_local CacheHolder holder;
+
+        static RemoteBatch &localBatch() noexcept
+        {
+            static thread_local RemoteBatch batch;
+            return batch;
+        }
+
+        static size_t classOf(size_t bytes) noexcept
+        {
+            return bytes == 0 ? 0 : (bytes - 1) / granularity;
+        }
+
+        static SlabHeader *slabOf(void *p) noexcept
+        {
+            return reinterpret_cast<SlabHeader *>(reinterpret_cast<uintptr_t>(p) & ~(uintptr_t{slab_size} - 1));
+        }
+
+        static void *take(ThreadCache &cache, size_t index)
+        {
+            FreeBlock *block = cache.free_lists[index];
+            if (!block) [[unlikely]]
+            {
+                block = refill(cache, index);
+            }
+            cache.free_lists[index] = block->next;
+            return block;
+        }
+
+        // Reuses the cache of an exited thread when there is one
+        static ThreadCache *acquireCache()
+        {
+            for (ThreadCache *cache = caches.load(memory_order_acquire); cache; cache = cache->next)
+            {
+                bool expected = false;
+                if (!cache->in_use.load(memory_order_relaxed) &&
+                    cache->in_use.compare_exchange_strong(expected, true, memory_order_acquire))
+                {
+                    return cache;
+                }
+            }
+
+            auto *cache = new ThreadCache;
+            cache->in_use.store(true, memory_order_relaxed);
+            ThreadCache *head = caches.load(memory_order_relaxed);
+            do
+            {
+                cache->next = head;
+            } while (!caches.compare_exchange_weak(head, cache, memory_order_release, memory_order_relaxed));
+            return cache;
+        }
+
+        // Takes back remote frees, or carves a fresh slab
+        static FreeBlock *refill(ThreadCache &cache, size_t index)
+        {
+            if (FreeBlock *returned = cache.remote[index].exchange(nullptr, memory_order_acquire))
+            {
+                return returned;
+            }
+
+            void *memory = ::operator new(slab_size, align_val_t{slab_size});
+            auto *slab = ::new (memory) SlabHeader{&cache, cache.slabs};
+            cache.slabs = slab;
+            size_t block_size = (index + 1) * granularity;
+            auto *begin = reinterpret_cast<unsigned char *>(slab) + sizeof(SlabHeader);
+
+            FreeBlock *head = nullptr;
+            for (size_t i = (slab_size - sizeof(SlabHeader)) / block_size; i-- > 0;)
+            {
+                head = ::new (begin + i * block_size) FreeBlock{head};
+            }
+            return head;
+        }
+
+        static void freeRemote(ThreadCache *owner, size_t index, FreeBlock *block) noexcept
+        {
+            RemoteBatch &batch = localBatch();
+            if (batch.count != 0 && (batch.owner != owner || batch.index != index))
+            {
+                flush();
+            }
+            if (batch.count == 0)
+            {
+                if (!exited)
+                {
+                    // A thread may free without ever allocating; the holder
+                    // is what flushes its last partial batch at exit
+                    static_cast<void>(&holder);
+                }
+                batch.owner = owner;
+                batch.index = index;
+                batch.tail = block;
+            }
+            block->next = batch.head;
+            batch.head = block;
+            // After thread exit nothing would flush a partial batch
+            if (++batch.count == remote_batch || exited)
+            {
+                flush();
+            }
+        }
+    };
+
+    // Base for control blocks allocated from ControlBlockPool
+    struct PoolAllocated
+    {
+        static void *operator new(size_t bytes)
+        {
+            return ControlBlockPool::allocate(bytes);
+        }
+
+        static void operator delete(void *p, size_t bytes) noexcept
+        {
+            ControlBlockPool::deallocate(p, bytes);
+        }
+
+        // Placement forms stay available to allocator-constructed blocks
+        static void *operator new(size_t, void *where) noexcept
+        {
+            return where;
+        }
+
+        static void operator delete(void *, void *) noexcept
+        {
+        }
+    };
+}
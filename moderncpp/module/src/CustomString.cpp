@@ -1,42 +1,84 @@
 #include "../include/CustomString.h"
 
+#include <atomic>
 #include <cstring>
+#include <new>
 #include <utility>
 #include <stdexcept>
 
+namespace
+{
+    // Starts the block of a shared buffer; the characters follow it
+    struct SharedHeader
+    {
+        std::atomic<size_t> refs;
+    };
+
+    SharedHeader* headerOf(char* chars)
+    {
+        return std::launder(reinterpret_cast<SharedHeader*>(chars - sizeof(SharedHeader)));
+    }
+}
 
-CustomString::CustomString(const char* other): str{nullptr}, len{0}
+
+CustomString::CustomString(const char* other)
 {
     copy(other);
 }
 
+char* CustomString::allocate(size_t n)
+{
+    char* dest;
+    if (n <= inline_capacity)
+    {
+        dest = reinterpret_cast<char*>(rep);
+        rep[tag_index] = static_cast<unsigned char>(n);
+    }
+    else
+    {
+        dest = new char[n + 1]; //+1 for '\0' character
+        std::memcpy(rep, &dest, sizeof(dest));
+        std::memcpy(rep + sizeof(char*), &n, sizeof(n));
+        rep[tag_index] = heap_flag;
+    }
+    dest[n] = '\0';
+    return dest;
+}
+
 void CustomString::copy(const char* other)
 {
     if (other != nullptr)
     {
-        len = strlen(other);
-        str = new char[len + 1]; //+1 for '\0' character
-        // strcpy(str, other);
-        // using memcopy for bitwise copy
-        memcpy(str, other, len + 1);
+        copy(other, StringKernels::length(other));
     }
     else
     {
-        str = nullptr;
-        len = 0;
+        setNull();
     }
 }
 
+void CustomString::copy(const char* other, size_t n)
+{
+    // using memcopy for bitwise copy
+    memcpy(allocate(n), other, n);
+}
+
 CustomString::CustomString(const CustomString& other)
 {
-    if(other.str != nullptr)
+    if (other.isShared())
+    {
+        // a copy only needs a count; relaxed, as for any reference count
+        headerOf(other.heapPtr())->refs.fetch_add(1, std::memory_order_relaxed);
+        memcpy(rep, other.rep, rep_size);
+    }
+    else if (!other.isHeap())
     {
-        copy(other.str);
+        // inline and null strings are the object bytes themselves
+        memcpy(rep, other.rep, rep_size);
     }
     else
     {
-        str = nullptr;
-        len = 0;
+        copy(other.heapPtr(), other.heapSize());
     }
 }
 
@@ -47,56 +89,60 @@ CustomString::~CustomString()
 
 void CustomString::destroy()
 {
-    if (nullptr != str)
+    if (isShared())
     {
-        delete[] str;
-        len = 0;
+        SharedHeader* header = headerOf(heapPtr());
+        if (header->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            header->~SharedHeader();
+            delete[] reinterpret_cast<char*>(header);
+        }
     }
-    str = nullptr;
+    else if (isHeap())
+    {
+        delete[] heapPtr();
+    }
+    setNull();
 }
 
 CustomString& CustomString::operator=(const CustomString& other) // let compiler make the copy
 {
     // copy swap idiom
     CustomString temp{other};
-    std::swap(temp.str, this->str);
-    std::swap(temp.len, this->len);
+    std::swap(temp.rep, this->rep);
 
-    //when temp goes out of scope previous str's memory will be released
-    //It handles self assignment also by itself , but we can add a check 
-    return *this; 
+    //when temp goes out of scope previous heap buffer will be released
+    //It handles self assignment also by itself , but we can add a check
+    return *this;
 }
 
-CustomString::CustomString(CustomString&& other)
+CustomString::CustomString(CustomString&& other) noexcept
 {
-    str = other.str;
-    len = other.len;
-    //make other str point to nullptr
-    other.str = nullptr;
-    other.len = 0;
+    // the representation moves as it is, whichever one it is
+    memcpy(rep, other.rep, rep_size);
+    //make other a null string
+    other.setNull();
 }
 
 CustomString& CustomString::operator=(CustomString&& other) noexcept
 {
     if (this != &other) { // Self-assignment check
-        destroy(); 
-        str = other.str; 
-        len = other.len;
-        other.str = nullptr; 
-        other.len = 0;
+        destroy();
+        memcpy(rep, other.rep, rep_size);
+        other.setNull();
     }
     return *this;
 }
 
-std::ostream &operator<<(std::ostream &os, CustomString &val)
+std::ostream &operator<<(std::ostream &os, const CustomString &val)
 {
-    //make sure point is not null 
-    if(val.str == nullptr)
+    //make sure point is not null
+    if(val.c_str() == nullptr)
     {
         throw std::runtime_error{"null pointer"};
     }
-    os<<val.str; 
-    return os; 
+    os.write(val.data(), static_cast<std::streamsize>(val.size()));
+    return os;
 }
 
 CustomString::CustomString(const char* ptr1, const char* ptr2)
@@ -104,44 +150,118 @@ CustomString::CustomString(const char* ptr1, const char* ptr2)
     // Treat null pointers as empty strings for robustness.
     const char *p1 = (ptr1 != nullptr) ? ptr1 : "";
     const char *p2 = (ptr2 != nullptr) ? ptr2 : "";
-    size_t len1 = strlen(p1);
-    size_t len2 = strlen(p2);
-    size_t lenLocal = len1 + len2;
+    size_t len1 = StringKernels::length(p1);
+    size_t len2 = StringKernels::length(p2);
+
+    char *dest = allocate(len1 + len2);
+    memcpy(dest, p1, len1);
+    memcpy(dest + len1, p2, len2);
+}
 
-    if (lenLocal > 0)
+CustomString::CustomString(const char *ptr, size_t l)
+{
+    if (ptr != nullptr)
     {
-        str = new char[lenLocal + 1];
-        memcpy(str, p1, len1);
-        memcpy(str + len1, p2, len2 + 1); // Copy p2 and its null terminator
+        copy(ptr, l);
     }
     else
-    {   
-        str = nullptr;
+    {
+        setNull();
     }
 }
 
-CustomString::CustomString(const char *ptr, size_t l)
+CustomString& CustomString::operator++()
 {
-    if (ptr != nullptr)
+    size_t n = size();
+    if (n > 0)
     {
-        
-        str = new char[l]; //+1 for '\0' character
-        // strcpy(str, other);
-        // using memcopy for bitwise copy
-        memcpy(str, ptr, l);
+        // the tail may move from the heap into the object, so take it
+        // out of the old storage before releasing that
+        CustomString tail{data() + 1, n - 1};
+        *this = std::move(tail);
     }
-    else
+    return *this;
+}
+
+CustomString CustomString::operator++(int)
+{
+    CustomString old{*this};
+    ++*this;
+    return old;
+}
+
+CustomString::CustomString(const std::string_view* pieces, size_t count, size_t total)
+{
+    char *dest = allocate(total);
+    for (size_t i = 0; i < count; ++i)
+    {
+        // an empty view may have a null data()
+        if (!pieces[i].empty())
+        {
+            memcpy(dest, pieces[i].data(), pieces[i].size());
+            dest += pieces[i].size();
+        }
+    }
+}
+
+void CustomString::share()
+{
+    if (!isHeap() || isShared())
     {
-        str = nullptr;
-        len = 0;
+        return;
     }
+    size_t n = heapSize();
+    char* block = new char[sizeof(SharedHeader) + n + 1];
+    new (block) SharedHeader{1};
+    char* chars = block + sizeof(SharedHeader);
+    memcpy(chars, heapPtr(), n + 1);
+    delete[] heapPtr();
+    std::memcpy(rep, &chars, sizeof(chars));
+    rep[tag_index] = shared_tag;
 }
 
-CustomString operator+(const CustomString &first, const CustomString &second)
+size_t CustomString::useCount() const noexcept
 {
-    if(nullptr == first.str || nullptr == second.str)
+    if (!isShared())
     {
-        throw std::logic_error{"one of the string has null ptr"};
+        return 1;
     }
-    return CustomString{first.str, second.str};
-}
\ No newline at end of file
+    return headerOf(heapPtr())->refs.load(std::memory_order_relaxed);
+}
+
+void CustomString::detach()
+{
+    CustomString own{data(), size()};
+    *this = std::move(own);
+}
+
+int CustomString::compare(const CustomString& other) const noexcept
+{
+    if (c_str() == nullptr || other.c_str() == nullptr)
+    {
+        return (c_str() != nullptr) - (other.c_str() != nullptr);
+    }
+    return StringKernels::compare(data(), size(), other.data(), other.size());
+}
+
+size_t CustomString::find(std::string_view needle, size_t from) const noexcept
+{
+    size_t n = size();
+    if (c_str() == nullptr || from > n)
+    {
+        return npos;
+    }
+    size_t found = StringKernels::find(data() + from, n - from, needle.data(), needle.size());
+    return found == npos ? npos : from + found;
+}
+
+size_t CustomString::findFirstOf(std::string_view set, size_t from) const noexcept
+{
+    size_t n = size();
+    if (c_str() == nullptr || from > n)
+    {
+        return npos;
+    }
+    size_t found = StringKernels::findFirstOf(data() + from, n - from, set.data(), set.size());
+    return found == npos ? npos : from + found;
+}
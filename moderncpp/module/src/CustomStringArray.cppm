@@ -1,60 +1,485 @@
 module;
 #include <cstring>
+#include <cstddef>
 #include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <system_error>
+#include <thread>
+#include <vector>
+#include "StringKernels.h"
 export module leonrahul.CustomStringArray;
 
 export namespace StringWorld
 {
 
+    // Array of C strings kept in one contiguous blob. Every string is stored
+    // with its '\0' back to back in blob_, and the table records where each
+    // one starts and how long it is; a null element has no bytes and is
+    // marked with null_offset. Both buffers grow geometrically, so add() is
+    // amortized O(1), and a copy is one memcpy per buffer.
+    //
+    // The pointers returned by get() point into the blob: they stay valid
+    // until the next add() or reserve() that has to grow it.
     class CustomStringArray
     {
 
     private:
-        char **stringArray_;
-        int size_; // size of the array
+        struct Slot
+        {
+            size_t offset; // start of the string in blob_, or null_offset
+            size_t length; // characters, not counting the '\0'
+        };
 
-    public:
-        CustomStringArray() : stringArray_{nullptr}, size_{0} {};
-        // Constructor
-        CustomStringArray(char **arr, int s)
+        static constexpr size_t null_offset = static_cast<size_t>(-1);
+        static constexpr int min_slots = 8;
+        static constexpr size_t min_bytes = 64;
+
+        Slot *slots_;
+        char *blob_;
+        int size_;         // size of the array
+        int slotCapacity_;
+        size_t used_;      // bytes of blob_ in use
+        size_t blobCapacity_;
+
+        static size_t grown(size_t current, size_t needed, size_t minimum)
         {
-            size_ = s;
-            stringArray_ = new char *[s];
-            for (int i = 0; i < s; ++i)
+            return std::max({current * 2, needed, minimum});
+        }
+
+        // Replaces the table with one of room slots; the old one is kept
+        // until the new one is in place
+        void growSlots(int room)
+        {
+            Slot *temp = new Slot[room];
+            if (size_ > 0)
+            {
+                memcpy(temp, slots_, size_ * sizeof(Slot));
+            }
+            delete[] slots_;
+            slots_ = temp;
+            slotCapacity_ = room;
+        }
+
+        // Copies the first count elements of arr, which may hold nulls, into
+        // storage that is already large enough
+        void append(char **arr, int count)
+        {
+            for (int i = 0; i < count; ++i)
             {
                 if (arr[i])
                 {
-                    int len = strlen(arr[i]) + 1; // +1 for '\0' char
-                    stringArray_[i] = new char[len];
-                    memcpy(stringArray_[i], arr[i], len);
+                    size_t len = StringKernels::length(arr[i]);
+                    memcpy(blob_ + used_, arr[i], len + 1); // +1 for '\0' char
+                    slots_[size_++] = Slot{used_, len};
+                    used_ += len + 1;
                 }
                 else
                 {
-                    stringArray_[i] = nullptr;
+                    slots_[size_++] = Slot{null_offset, 0};
                 }
             }
         }
-        // copy constructor
-        CustomStringArray(const CustomStringArray &other)
+
+
+        // Sorts a range of the slot table in place. Next to every slot it
+        // caches the element's next 8 bytes from the current depth as one
+        // big-endian integer, zero-padded past the end, so most comparisons
+        // are an integer compare and never touch the blob. A key whose low
+        // byte is 0 covers the rest of its string: the strings hold no '\0',
+        // so two such equal keys mean two equal strings.
+        //
+        // The unstable sort is a multikey quicksort on those keys: a 3-way
+        // partition, with the equal part carrying on 8 bytes deeper. The
+        // stable one is an MSD radix sort, one byte per pass, with counting
+        // passes through a spare table. Both hand ranges of at least
+        // parallel_threshold elements to new threads while any of the
+        // thread budget is left, and join them before returning.
+        class Sorter
         {
-            this->size_ = other.size_;
+        public:
+            static constexpr size_t small_range = 16;
+            static constexpr size_t parallel_threshold = 1 << 15;
 
-            stringArray_ = new char *[size_];
-            for (int i = 0; i < size_; ++i)
+            Sorter(CustomStringArray &array, unsigned threads, bool stable)
+                : blob{array.blob_}, slots{array.slots_}, keys{new uint64_t[array.size_]},
+                  spareThreads{static_cast<int>(threads) - 1}
             {
-                if (other.stringArray_[i])
+                if (stable)
                 {
-                    int len = strlen(other.stringArray_[i]) + 1;
-
-                    this->stringArray_[i] = new char[len];
+                    spareSlots.reset(new Slot[array.size_]);
+                    spareKeys.reset(new uint64_t[array.size_]);
+                }
+            }
 
-                    memcpy(stringArray_[i], other.stringArray_[i], len);
+            void sort(size_t lo, size_t hi, bool stable)
+            {
+                loadKeys(lo, hi, 0);
+                if (stable)
+                {
+                    radixSort(lo, hi, 0);
                 }
                 else
                 {
-                    stringArray_[i] = nullptr;
+                    multikeySort(lo, hi, 0);
+                }
+                // every helper has been joined by now
+                if (failure)
+                {
+                    std::rethrow_exception(failure);
+                }
+            }
+
+        private:
+            const char *blob;
+            Slot *slots;
+            std::unique_ptr<uint64_t[]> keys;
+            std::unique_ptr<Slot[]> spareSlots;
+            std::unique_ptr<uint64_t[]> spareKeys;
+            std::atomic<int> spareThreads;
+            // The first exception a helper thread ran into, rethrown by sort()
+            std::exception_ptr failure;
+            std::mutex failureLock;
+
+            // The threads a range handed work to. They are joined on the way
+            // out, exceptions included, so none is left joinable.
+            struct Helpers
+            {
+                std::vector<std::thread> threads;
+
+                Helpers() = default;
+                Helpers(const Helpers &) = delete;
+                Helpers &operator=(const Helpers &) = delete;
+
+                ~Helpers()
+                {
+                    for (auto &thread : threads)
+                    {
+                        thread.join();
+                    }
+                }
+            };
+
+            uint64_t keyOf(const Slot &slot, size_t depth) const
+            {
+                size_t left = slot.length > depth ? slot.length - depth : 0;
+                const unsigned char *p = reinterpret_cast<const unsigned char *>(blob + slot.offset + depth);
+                uint64_t key = 0;
+                if (left >= 8)
+                {
+                    memcpy(&key, p, 8);
+                    if constexpr (std::endian::native == std::endian::little)
+                    {
+                        key = __builtin_bswap64(key);
+                    }
+                    return key;
+                }
+                for (size_t i = 0; i < 8; ++i)
+                {
+                    key = (key << 8) | (i < left ? p[i] : 0);
+                }
+                return key;
+            }
+
+            void loadKeys(size_t lo, size_t hi, size_t depth)
+            {
+                for (size_t i = lo; i < hi; ++i)
+                {
+                    keys[i] = keyOf(slots[i], depth);
+                }
+            }
+
+            void swap(size_t i, size_t j)
+            {
+                std::swap(slots[i], slots[j]);
+                std::swap(keys[i], keys[j]);
+            }
+
+            // For elements that share their first depth bytes and have their
+            // keys loaded at depth
+            bool less(size_t i, size_t j, size_t depth) const
+            {
+                if (keys[i] != keys[j])
+                {
+                    return keys[i] < keys[j];
+                }
+                if ((keys[i] & 0xFF) == 0)
+                {
+                    return false;
+                }
+                size_t rest = depth + 8;
+                return StringKernels::compare(blob + slots[i].offset + rest, slots[i].length - rest,
+                                              blob + slots[j].offset + rest, slots[j].length - rest) < 0;
+            }
+
+            // Stable, for the small ranges both sorts end in
+            void insertionSort(size_t lo, size_t hi, size_t depth)
+            {
+                for (size_t i = lo + 1; i < hi; ++i)
+                {
+                    for (size_t j = i; j > lo && less(j, j - 1, depth); --j)
+                    {
+                        swap(j, j - 1);
+                    }
+                }
+            }
+
+            // Runs job on a new thread if the range is large and the budget
+            // allows, otherwise right here. A helper that throws records
+            // the exception for sort() instead of ending the process.
+            template <typename Job>
+            void fork(size_t size, Helpers &helpers, Job job)
+            {
+                if (size >= parallel_threshold)
+                {
+                    if (spareThreads.fetch_sub(1, std::memory_order_relaxed) > 0)
+                    {
+                        try
+                        {
+                            helpers.threads.emplace_back([this, job]
+                                                         {
+                                                             try
+                                                             {
+                                                                 job();
+                                                             }
+                                                             catch (...)
+                                                             {
+                                                                 std::lock_guard<std::mutex> lock(failureLock);
+                                                                 if (!failure)
+                                                                 {
+                                                                     failure = std::current_exception();
+                                                                 }
+                                                             }
+                                                             spareThreads.fetch_add(1, std::memory_order_relaxed); });
+                            return;
+                        }
+                        catch (const std::system_error &)
+                        {
+                            // no thread to be had: do it here
+                        }
+                        catch (const std::bad_alloc &)
+                        {
+                            // no room to track another thread: likewise
+                        }
+                    }
+                    spareThreads.fetch_add(1, std::memory_order_relaxed);
+                }
+                job();
+            }
+
+            void multikeySort(size_t lo, size_t hi, size_t depth)
+            {
+                Helpers helpers;
+                while (hi - lo > small_range)
+                {
+                    uint64_t a = keys[lo], b = keys[lo + (hi - lo) / 2], c = keys[hi - 1];
+                    uint64_t pivot = std::max(std::min(a, b), std::min(std::max(a, b), c));
+                    size_t lt = lo, i = lo, gt = hi;
+                    while (i < gt)
+                    {
+                        if (keys[i] < pivot)
+                        {
+                            swap(lt++, i++);
+                        }
+                        else if (keys[i] > pivot)
+                        {
+                            swap(i, --gt);
+                        }
+                        else
+                        {
+                            ++i;
+                        }
+                    }
+                    // [lo, lt) sorts below the pivot key, [lt, gt) shares it and
+                    // [gt, hi) sorts above. The shared part goes 8 bytes deeper,
+                    // unless the key ends its strings and they are all equal.
+                    // The largest part stays in this loop and the others, at
+                    // most half the range each, recurse, so the depth is
+                    // logarithmic however the input is shaped.
+                    size_t below = lt - lo, above = hi - gt;
+                    size_t equal = (pivot & 0xFF) != 0 && gt - lt > 1 ? gt - lt : 0;
+                    if (equal > 0 && equal >= below && equal >= above)
+                    {
+                        fork(below, helpers, [this, lo, lt, depth]
+                             { multikeySort(lo, lt, depth); });
+                        fork(above, helpers, [this, gt, hi, depth]
+                             { multikeySort(gt, hi, depth); });
+                        lo = lt;
+                        hi = gt;
+                        depth += 8;
+                        loadKeys(lo, hi, depth);
+                        continue;
+                    }
+                    if (equal > 0)
+                    {
+                        fork(equal, helpers, [this, lt, gt, depth]
+                             {
+                                 loadKeys(lt, gt, depth + 8);
+                                 multikeySort(lt, gt, depth + 8); });
+                    }
+                    if (below >= above)
+                    {
+                        fork(above, helpers, [this, gt, hi, depth]
+                             { multikeySort(gt, hi, depth); });
+                        hi = lt;
+                    }
+                    else
+                    {
+                        fork(below, helpers, [this, lo, lt, depth]
+                             { multikeySort(lo, lt, depth); });
+                        lo = gt;
+                    }
+                }
+                insertionSort(lo, hi, depth);
+            }
+
+            // Keys are loaded at depth rounded down to a multiple of 8
+            void radixSort(size_t lo, size_t hi, size_t depth)
+            {
+                Helpers helpers;
+                while (hi - lo > small_range)
+                {
+                    unsigned shift = 56 - 8 * (depth % 8);
+                    size_t start[257] = {};
+                    for (size_t i = lo; i < hi; ++i)
+                    {
+                        ++start[((keys[i] >> shift) & 0xFF) + 1];
+                    }
+                    int only = -1; // the bucket holding the whole range, if one does
+                    for (int b = 0; b < 256; ++b)
+                    {
+                        if (start[b + 1] == hi - lo)
+                        {
+                            only = b;
+                        }
+                        start[b + 1] += start[b];
+                    }
+                    size_t next = depth + 1;
+                    bool reload = next % 8 == 0;
+                    if (only == 0)
+                    {
+                        // every string ends here, so they are all equal
+                        break;
+                    }
+                    if (only > 0)
+                    {
+                        // a byte they all share: nothing to move
+                        if (reload)
+                        {
+                            loadKeys(lo, hi, next);
+                        }
+                        depth = next;
+                        continue;
+                    }
+                    // a counting pass through the spare table keeps equal
+                    // bytes in their order
+                    size_t fill[256];
+                    std::copy(start, start + 256, fill);
+                    for (size_t i = lo; i < hi; ++i)
+                    {
+                        size_t at = lo + fill[(keys[i] >> shift) & 0xFF]++;
+                        spareSlots[at] = slots[i];
+                        spareKeys[at] = keys[i];
+                    }
+                    std::copy(spareSlots.get() + lo, spareSlots.get() + hi, slots + lo);
+                    std::copy(spareKeys.get() + lo, spareKeys.get() + hi, keys.get() + lo);
+
+                    // Bucket 0 holds the strings that end here. The largest of
+                    // the others stays in this loop and the rest recurse, so
+                    // nested prefixes cannot make the recursion one level deep
+                    // per byte.
+                    int largest = 1;
+                    for (int b = 2; b < 256; ++b)
+                    {
+                        if (start[b + 1] - start[b] > start[largest + 1] - start[largest])
+                        {
+                            largest = b;
+                        }
+                    }
+                    for (int b = 1; b < 256; ++b)
+                    {
+                        size_t first = lo + start[b];
+                        size_t last = lo + start[b + 1];
+                        if (b != largest && last - first > 1)
+                        {
+                            fork(last - first, helpers, [this, first, last, next, reload]
+                                 {
+                                     if (reload)
+                                     {
+                                         loadKeys(first, last, next);
+                                     }
+                                     radixSort(first, last, next); });
+                        }
+                    }
+                    hi = lo + start[largest + 1];
+                    lo = lo + start[largest];
+                    if (reload)
+                    {
+                        loadKeys(lo, hi, next);
+                    }
+                    depth = next;
                 }
+                if (hi - lo <= small_range)
+                {
+                    insertionSort(lo, hi, depth - depth % 8);
+                }
+            }
+        };
+
+        void sortSlots(unsigned threads, bool stable)
+        {
+            // nulls go first, in their order; the sorters never see them
+            Slot *firstString = std::stable_partition(slots_, slots_ + size_, [](const Slot &slot)
+                                                      { return slot.offset == null_offset; });
+            size_t lo = firstString - slots_;
+            if (static_cast<size_t>(size_) - lo < 2)
+            {
+                return;
+            }
+            if (threads == 0)
+            {
+                threads = std::max(1u, std::thread::hardware_concurrency());
             }
+            Sorter(*this, threads, stable).sort(lo, size_, stable);
+        }
+
+    public:
+        CustomStringArray() : slots_{nullptr}, blob_{nullptr}, size_{0}, slotCapacity_{0}, used_{0}, blobCapacity_{0} {};
+        // Constructor
+        CustomStringArray(char **arr, int s) : CustomStringArray()
+        {
+            // measure first so both buffers are allocated exactly once
+            size_t bytes = 0;
+            for (int i = 0; i < s; ++i)
+            {
+                if (arr[i])
+                {
+                    bytes += StringKernels::length(arr[i]) + 1;
+                }
+            }
+            reserve(s, bytes);
+            append(arr, s);
+        }
+        // copy constructor
+        CustomStringArray(const CustomStringArray &other) : CustomStringArray()
+        {
+            // offsets are relative to the blob, so the table copies as it is
+            reserve(other.size_, other.used_);
+            if (other.size_ > 0)
+            {
+                memcpy(slots_, other.slots_, other.size_ * sizeof(Slot));
+            }
+            if (other.used_ > 0)
+            {
+                memcpy(blob_, other.blob_, other.used_);
+            }
+            size_ = other.size_;
+            used_ = other.used_;
         }
 
         // copy assignment operator
@@ -66,7 +491,7 @@ export namespace StringWorld
             if (this != &other)
             {
                 CustomStringArray temp{other}; // copy constructor called
-                std::swap(*this, temp);        // swaps the pointer of this and size to temp , shallow copy;
+                std::swap(*this, temp);        // swaps the buffers of this and temp , shallow copy;
             }
             return *this; // when stack unwindining , destructor for temp is called and memory is released
         }
@@ -77,23 +502,27 @@ export namespace StringWorld
         }
         void release()
         {
-
-            for (int i = 0; i < size_; ++i)
-            {
-                delete[] stringArray_[i];
-            }
-
-            delete[] stringArray_;
-            stringArray_ = nullptr;
+            delete[] slots_;
+            delete[] blob_;
+            slots_ = nullptr;
+            blob_ = nullptr;
+            size_ = 0;
+            slotCapacity_ = 0;
+            used_ = 0;
+            blobCapacity_ = 0;
         }
 
         // move constructor
-        CustomStringArray(CustomStringArray &&other)
+        CustomStringArray(CustomStringArray &&other) noexcept
+            : slots_{other.slots_}, blob_{other.blob_}, size_{other.size_},
+              slotCapacity_{other.slotCapacity_}, used_{other.used_}, blobCapacity_{other.blobCapacity_}
         {
-            this->size_ = other.size_;
-            this->stringArray_ = other.stringArray_;
+            other.slots_ = nullptr;
+            other.blob_ = nullptr;
             other.size_ = 0;
-            other.stringArray_ = nullptr;
+            other.slotCapacity_ = 0;
+            other.used_ = 0;
+            other.blobCapacity_ = 0;
         }
 
         // move assignment operator
@@ -104,10 +533,12 @@ export namespace StringWorld
             if (this != &other)
             {
                 release();
-                this->size_ = other.size_;
-                this->stringArray_ = other.stringArray_;
-                other.size_ = 0;
-                other.stringArray_ = nullptr;
+                std::swap(slots_, other.slots_);
+                std::swap(blob_, other.blob_);
+                std::swap(size_, other.size_);
+                std::swap(slotCapacity_, other.slotCapacity_);
+                std::swap(used_, other.used_);
+                std::swap(blobCapacity_, other.blobCapacity_);
             }
             return *this;
         }
@@ -117,24 +548,123 @@ export namespace StringWorld
         }
         char *get(int index) const
         {
-            if (index < 0 || index >= size_)
+            if (index < 0 || index >= size_ || slots_[index].offset == null_offset)
             {
                 return nullptr;
             }
-            return stringArray_[index];
+            return blob_ + slots_[index].offset;
         }
-        void add(const char *str)
+        // Length of the string at index; 0 for null elements and out of range
+        size_t length(int index) const
         {
-            char **temp = new char *[size_ + 1];
+            if (index < 0 || index >= size_)
+            {
+                return 0;
+            }
+            return slots_[index].length;
+        }
+        // Negative, zero or positive as element i sorts before, with or after
+        // element j; null elements sort first. Both must be in range.
+        int compare(int i, int j) const
+        {
+            const Slot &a = slots_[i];
+            const Slot &b = slots_[j];
+            if (a.offset == null_offset || b.offset == null_offset)
+            {
+                return (a.offset != null_offset) - (b.offset != null_offset);
+            }
+            return StringKernels::compare(blob_ + a.offset, a.length, blob_ + b.offset, b.length);
+        }
+        // Index of the first element equal to str, or -1
+        int find(const char *str) const
+        {
+            if (str == nullptr)
+            {
+                return -1;
+            }
+            size_t len = StringKernels::length(str);
             for (int i = 0; i < size_; ++i)
             {
-                temp[i] = stringArray_[i];
+                const Slot &slot = slots_[i];
+                if (slot.offset != null_offset && StringKernels::equal(blob_ + slot.offset, slot.length, str, len))
+                {
+                    return i;
+                }
+            }
+            return -1;
+        }
+        // Sorts the elements by their bytes, compared as unsigned, with null
+        // elements first. Only the table is permuted: get() returns the
+        // same pointers in the new order. threads caps the threads used,
+        // this one included; 0 means one per hardware thread. Equal
+        // elements may change their order. If the sort throws, say
+        // bad_alloc for its key table, every thread it started has been
+        // joined and the table holds the same elements, partly sorted.
+        void sort(unsigned threads = 0)
+        {
+            sortSlots(threads, false);
+        }
+        // Like sort(), but equal elements keep their order; takes a second
+        // table's worth of memory while it runs
+        void stableSort(unsigned threads = 0)
+        {
+            sortSlots(threads, true);
+        }
+        // Makes room for count elements holding bytes characters in total,
+        // terminators included, so that adding them does not reallocate
+        void reserve(int count, size_t bytes)
+        {
+            if (count > slotCapacity_)
+            {
+                growSlots(count);
+            }
+            if (bytes > blobCapacity_)
+            {
+                char *temp = new char[bytes];
+                if (used_ > 0)
+                {
+                    memcpy(temp, blob_, used_);
+                }
+                delete[] blob_;
+                blob_ = temp;
+                blobCapacity_ = bytes;
+            }
+        }
+        // Appends a copy of str; nullptr appends a null element. str may
+        // point into this array.
+        void add(const char *str)
+        {
+            if (size_ == slotCapacity_)
+            {
+                growSlots(static_cast<int>(grown(slotCapacity_, size_ + 1, min_slots)));
+            }
+            if (str == nullptr)
+            {
+                slots_[size_++] = Slot{null_offset, 0};
+                return;
+            }
+            size_t len = StringKernels::length(str);
+            size_t needed = used_ + len + 1; // +1 for '\0' char
+            if (needed > blobCapacity_)
+            {
+                size_t room = grown(blobCapacity_, needed, min_bytes);
+                char *temp = new char[room];
+                if (used_ > 0)
+                {
+                    memcpy(temp, blob_, used_);
+                }
+                // str may live in the old blob, so copy it before releasing that
+                memcpy(temp + used_, str, len + 1);
+                delete[] blob_;
+                blob_ = temp;
+                blobCapacity_ = room;
+            }
+            else
+            {
+                memcpy(blob_ + used_, str, len + 1);
             }
-            temp[size_] = new char[strlen(str) + 1];
-            strcpy(temp[size_], str);
-            delete[] stringArray_;
-            stringArray_ = temp;
-            size_++;
+            slots_[size_++] = Slot{used_, len};
+            used_ = needed;
         }
     };
 }
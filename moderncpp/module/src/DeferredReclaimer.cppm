@@ -0,0 +1,220 @@
+module;
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+export module leonrahul.DeferredReclaimer;
+
+using namespace std;
+
+export namespace ThreadSafeWorld
+{
+    // Intrusive link embedded in whatever is queued for deferred destruction
+    struct DeferredNode
+    {
+        DeferredNode *deferred_next = nullptr;
+        void (*deferred_reclaim)(DeferredNode *) = nullptr;
+    };
+
+    // Takes destruction off the thread that drops the last reference.
+    //
+    // That thread only pushes the node onto its own lock-free list; drain()
+    // or the background reclaimer later detaches each list with one exchange
+    // and runs the destructors in a batch.
+    class DeferredReclaimer
+    {
+    public:
+        // Padded so pushes from different threads don't share a cache line
+        struct alignas(64) ThreadList
+        {
+            atomic<DeferredNode *> head{nullptr};
+            atomic<bool> in_use{false};
+            ThreadList *next = nullptr;
+        };
+
+        static DeferredReclaimer &global()
+        {
+            static DeferredReclaimer reclaimer;
+            return reclaimer;
+        }
+
+        DeferredReclaimer() = default;
+        DeferredReclaimer(const DeferredReclaimer &) = delete;
+        DeferredReclaimer &operator=(const DeferredReclaimer &) = delete;
+
+        ~DeferredReclaimer()
+        {
+            stop_background();
+            while (drain() != 0)
+            {
+            }
+            ThreadList *list = lists.load(memory_order_acquire);
+            while (list)
+            {
+                ThreadList *next = list->next;
+                delete list;
+                list = next;
+            }
+        }
+
+        // Reuses the list of an exited thread when there is one; whatever
+        // is still queued on it is drained like any other list
+        ThreadList *acquire_list()
+        {
+            for (ThreadList *list = lists.load(memory_order_acquire); list; list = list->next)
+            {
+                bool expected = false;
+                if (!list->in_use.load(memory_order_relaxed) &&
+                    list->in_use.compare_exchange_strong(expected, true, memory_order_acquire))
+                {
+                    return list;
+                }
+            }
+
+            auto *list = new ThreadList;
+            list->in_use.store(true, memory_order_relaxed);
+            ThreadList *head = lists.load(memory_order_relaxed);
+            do
+            {
+                list->next = head;
+            } while (!lists.compare_exchange_weak(head, list, memory_order_release, memory_order_relaxed));
+            return list;
+        }
+
+        void release_list(ThreadList *list) noexcept
+        {
+            list->in_use.store(false, memory_order_release);
+        }
+
+        void push(ThreadList &list, DeferredNode *node) noexcept
+        {
+            DeferredNode *head = list.head.load(memory_order_relaxed);
+            do
+            {
+                node->deferred_next = head;
+            } while (!list.head.compare_exchange_weak(head, node, memory_order_release, memory_order_relaxed));
+        }
+
+        // Destroys everything queued so far on every thread. Destructors
+        // that drop further deferred references queue them on the calling
+        // thread, and those are destroyed too. Returns the number reclaimed.
+        size_t drain(ThreadList *own = nullptr) noexcept
+        {
+            size_t reclaimed = 0;
+            do
+            {
+                for (ThreadList *list = lists.load(memory_order_acquire); list; list = list->next)
+                {
+                    DeferredNode *node = list->head.exchange(nullptr, memory_order_acquire);
+                    while (node)
+                    {
+                        DeferredNode *next = node->deferred_next;
+                        node->deferred_reclaim(node);
+                        node = next;
+                        ++reclaimed;
+                    }
+                }
+            } while (own && own->head.load(memory_order_relaxed));
+            return reclaimed;
+        }
+
+        // Starts a thread that drains every `interval`; no-op if running
+        void start_background(chrono::microseconds interval)
+        {
+            lock_guard<mutex> lock(background_mutex);
+            if (background.joinable())
+            {
+                return;
+            }
+            stopping = false;
+            background = thread([this, interval]
+                                { run_background(interval); });
+        }
+
+        // Stops the background thread after one last drain
+        void stop_background()
+        {
+            {
+                lock_guard<mutex> lock(background_mutex);
+                if (!background.joinable())
+                {
+                    return;
+                }
+                stopping = true;
+            }
+            wakeup.notify_all();
+            background.join();
+        }
+
+    private:
+        void run_background(chrono::microseconds interval);
+
+        atomic<ThreadList *> lists{nullptr};
+
+        mutex background_mutex;
+        condition_variable wakeup;
+        bool stopping = false;
+        thread background;
+    };
+
+    // Binds the calling thread to a list of the global reclaimer for its lifetime
+    struct DeferredThreadState
+    {
+        DeferredReclaimer::ThreadList *list = nullptr;
+
+        DeferredReclaimer::ThreadList &get()
+        {
+            if (!list)
+            {
+                list = DeferredReclaimer::global().acquire_list();
+            }
+            return *list;
+        }
+
+        ~DeferredThreadState()
+        {
+            if (list)
+            {
+                DeferredReclaimer::global().release_list(list);
+            }
+        }
+    };
+
+    inline thread_local DeferredThreadState deferred_thread_state;
+
+    inline void DeferredReclaimer::run_background(chrono::microseconds interval)
+    {
+        // Cascading drops on this thread queue onto its own list, which is
+        // handed back here rather than at thread exit, as exit may happen
+        // while the reclaimer itself is being destroyed
+        ThreadList *own = acquire_list();
+        deferred_thread_state.list = own;
+
+        unique_lock<mutex> lock(background_mutex);
+        while (!stopping)
+        {
+            wakeup.wait_for(lock, interval, [this]
+                            { return stopping; });
+            lock.unlock();
+            drain(own);
+            lock.lock();
+        }
+
+        deferred_thread_state.list = nullptr;
+        release_list(own);
+    }
+
+    // Queues node; node->deferred_reclaim must be set
+    inline void defer_reclaim(DeferredNode *node)
+    {
+        DeferredReclaimer::global().push(deferred_thread_state.get(), node);
+    }
+
+    // Destroys everything deferred so far, on the calling thread
+    inline size_t drain_deferred()
+    {
+        return DeferredReclaimer::global().drain(&deferred_thread_state.get());
+    }
+}
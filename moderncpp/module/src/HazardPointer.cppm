@@ -0,0 +1,285 @@
+module;
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <cstddef>
+export module leonrahul.HazardPointer;
+
+using namespace std;
+
+export namespace ThreadSafeWorld
+{
+    // Object handed to the domain, reclaimed once no hazard pointer holds it
+    struct RetiredNode
+    {
+        void *ptr;
+        void (*reclaim)(void *);
+    };
+
+    // Process-wide hazard pointer domain.
+    //
+    // Readers publish the address they are about to dereference in one of
+    // their thread's hazard slots and re-check the source; from then on the
+    // object cannot be reclaimed, and the reader never writes to memory any
+    // other thread writes. Writers retire objects into a per-thread list and
+    // reclaim them in batches, skipping whatever is still published.
+    class HazardDomain
+    {
+    public:
+        static constexpr int slots_per_thread = 4;
+
+        // Padded so each thread's hazard writes stay in its own cache line
+        struct alignas(64) ThreadRecord
+        {
+            atomic<const void *> slots[slots_per_thread] = {};
+            atomic<bool> in_use{false};
+            ThreadRecord *next = nullptr;
+            // Touched only by the thread holding the record
+            unsigned used_slots = 0;
+            vector<RetiredNode> retired;
+        };
+
+        static HazardDomain &global()
+        {
+            static HazardDomain domain;
+            return domain;
+        }
+
+        HazardDomain() = default;
+        HazardDomain(const HazardDomain &) = delete;
+        HazardDomain &operator=(const HazardDomain &) = delete;
+
+        // Runs at exit when no reader is left, so everything can go
+        ~HazardDomain()
+        {
+            ThreadRecord *record = records.load(memory_order_acquire);
+            while (record)
+            {
+                for (auto &node : record->retired)
+                {
+                    node.reclaim(node.ptr);
+                }
+                ThreadRecord *next = record->next;
+                delete record;
+                record = next;
+            }
+        }
+
+        // Reuses the record of an exited thread when there is one
+        ThreadRecord *acquire_record()
+        {
+            for (ThreadRecord *record = records.load(memory_order_acquire); record; record = record->next)
+            {
+                bool expected = false;
+                if (!record->in_use.load(memory_order_relaxed) &&
+                    record->in_use.compare_exchange_strong(expected, true, memory_order_acquire))
+                {
+                    return record;
+                }
+            }
+
+            auto *record = new ThreadRecord;
+            record->in_use.store(true, memory_order_relaxed);
+            ThreadRecord *head = records.load(memory_order_relaxed);
+            do
+            {
+                record->next = head;
+            } while (!records.compare_exchange_weak(head, record, memory_order_release, memory_order_relaxed));
+            record_count.fetch_add(1, memory_order_relaxed);
+            return record;
+        }
+
+        // Objects still protected stay on the record for whoever reuses it,
+        // or for the next scan that adopts them
+        void release_record(ThreadRecord *record) noexcept
+        {
+            for (auto &slot : record->slots)
+            {
+                slot.store(nullptr, memory_order_release);
+            }
+            record->used_slots = 0;
+            scan(*record);
+            record->in_use.store(false, memory_order_release);
+        }
+
+        void retire(ThreadRecord &self, void *ptr, void (*reclaim)(void *))
+        {
+            self.retired.push_back(RetiredNode{ptr, reclaim});
+            if (self.retired.size() >= scan_threshold())
+            {
+                scan(self);
+            }
+        }
+
+        // Reclaims every retired object of `self` no hazard slot points at
+        void scan(ThreadRecord &self) noexcept
+        {
+            adopt_orphans(self);
+
+            // Pairs with the fence between a reader's publish and re-check
+            atomic_thread_fence(memory_order_seq_cst);
+            vector<const void *> hazards;
+            hazards.reserve(record_count.load(memory_order_relaxed) * slots_per_thread);
+            for (ThreadRecord *record = records.load(memory_order_acquire); record; record = record->next)
+            {
+                for (auto &slot : record->slots)
+                {
+                    if (const void *p = slot.load(memory_order_acquire))
+                    {
+                        hazards.push_back(p);
+                    }
+                }
+            }
+            sort(hazards.begin(), hazards.end());
+
+            // Reclaiming can retire more objects onto self.retired, so work
+            // on a detached batch
+            vector<RetiredNode> batch;
+            batch.swap(self.retired);
+            for (auto &node : batch)
+            {
+                if (binary_search(hazards.begin(), hazards.end(), node.ptr))
+                {
+                    self.retired.push_back(node);
+                }
+                else
+                {
+                    node.reclaim(node.ptr);
+                }
+            }
+        }
+
+        size_t scan_threshold() const noexcept
+        {
+            return max<size_t>(64, 2 * record_count.load(memory_order_relaxed) * slots_per_thread);
+        }
+
+    private:
+        // Takes over objects left behind on records of exited threads
+        void adopt_orphans(ThreadRecord &self) noexcept
+        {
+            for (ThreadRecord *record = records.load(memory_order_acquire); record; record = record->next)
+            {
+                bool expected = false;
+                if (record == &self || record->in_use.load(memory_order_relaxed) ||
+                    !record->in_use.compare_exchange_strong(expected, true, memory_order_acquire))
+                {
+                    continue;
+                }
+                self.retired.insert(self.retired.end(), record->retired.begin(), record->retired.end());
+                record->retired.clear();
+                record->in_use.store(false, memory_order_release);
+            }
+        }
+
+        atomic<ThreadRecord *> records{nullptr};
+        atomic<size_t> record_count{0};
+    };
+
+    // Binds the calling thread to a record of the global domain for its lifetime
+    struct HazardThreadState
+    {
+        HazardDomain::ThreadRecord *record = nullptr;
+
+        HazardDomain::ThreadRecord &get()
+        {
+            if (!record)
+            {
+                record = HazardDomain::global().acquire_record();
+            }
+            return *record;
+        }
+
+        ~HazardThreadState()
+        {
+            if (record)
+            {
+                HazardDomain::global().release_record(record);
+            }
+        }
+    };
+
+    inline thread_local HazardThreadState hazard_thread_state;
+
+    // RAII owner of one of the calling thread's hazard slots
+    class HazardPointer
+    {
+    private:
+        atomic<const void *> *slot_;
+        int index_;
+
+    public:
+        HazardPointer()
+        {
+            auto &record = hazard_thread_state.get();
+            for (index_ = 0; index_ < HazardDomain::slots_per_thread; ++index_)
+            {
+                if (!(record.used_slots & (1u << index_)))
+                {
+                    record.used_slots |= 1u << index_;
+                    slot_ = &record.slots[index_];
+                    return;
+                }
+            }
+            throw runtime_error{"no free hazard pointer slot on this thread"};
+        }
+
+        HazardPointer(const HazardPointer &) = delete;
+        HazardPointer &operator=(const HazardPointer &) = delete;
+
+        ~HazardPointer()
+        {
+            slot_->store(nullptr, memory_order_release);
+            hazard_thread_state.get().used_slots &= ~(1u << index_);
+        }
+
+        // Publishes p. The caller must re-read its source afterwards and
+        // only trust p if it is still there.
+        void set(const void *p) noexcept
+        {
+            slot_->store(p, memory_order_seq_cst);
+        }
+
+        // Loads src and guards the result; valid until reset() or the next protect
+        template <typename T>
+        T *protect(const atomic<T *> &src) noexcept
+        {
+            T *p = src.load(memory_order_relaxed);
+            while (true)
+            {
+                set(p);
+                T *again = src.load(memory_order_seq_cst);
+                if (again == p)
+                {
+                    return p;
+                }
+                p = again;
+            }
+        }
+
+        void reset() noexcept
+        {
+            slot_->store(nullptr, memory_order_release);
+        }
+    };
+
+    // Hands p to the global domain; reclaim(p) runs once no hazard pointer
+    // holds it
+    inline void hazard_retire(void *p, void (*reclaim)(void *))
+    {
+        HazardDomain::global().retire(hazard_thread_state.get(), p, reclaim);
+    }
+
+    template <typename T>
+    void hazard_retire(T *p)
+    {
+        hazard_retire(static_cast<void *>(p), [](void *q) { delete static_cast<T *>(q); });
+    }
+
+    // Reclaims whatever the calling thread retired that is no longer protected
+    inline void hazard_flush() noexcept
+    {
+        HazardDomain::global().scan(hazard_thread_state.get());
+    }
+}
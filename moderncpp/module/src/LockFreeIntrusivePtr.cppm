@@ -0,0 +1,330 @@
+module;
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <functional>
+export module leonrahul.LockFreeIntrusivePtr;
+import leonrahul.HazardPointer;
+
+using namespace std;
+
+export namespace ThreadSafeWorld
+{
+    // CRTP base embedding an atomic reference count in Derived, so a pointer
+    // to it needs no separate control block. Copies of the object start with
+    // a fresh count; the object is deleted as Derived.
+    template <typename Derived>
+    class IntrusiveRefCounted
+    {
+    private:
+        mutable atomic<uint32_t> ref_count_{0};
+
+    protected:
+        IntrusiveRefCounted() noexcept = default;
+        IntrusiveRefCounted(const IntrusiveRefCounted &) noexcept {}
+        IntrusiveRefCounted &operator=(const IntrusiveRefCounted &) noexcept { return *this; }
+        ~IntrusiveRefCounted() = default;
+
+    public:
+        void AddRef() const noexcept
+        {
+            ref_count_.fetch_add(1, memory_order_relaxed);
+        }
+
+        // True when the count dropped to zero
+        bool DelRef() const noexcept
+        {
+            return ref_count_.fetch_sub(1, memory_order_acq_rel) == 1;
+        }
+
+        void Destroy() const noexcept
+        {
+            delete static_cast<const Derived *>(this);
+        }
+
+        uint32_t use_count() const noexcept
+        {
+            return ref_count_.load(memory_order_acquire);
+        }
+    };
+
+    // Customization point for how LockFreeIntrusivePtr counts and frees a T.
+    // The default uses T's AddRef()/DelRef() members, as IntrusiveRefCounted
+    // provides, and T::Destroy() if present, delete otherwise. Specialize it
+    // for types with a different counting API.
+    template <typename T>
+    struct IntrusiveRefTraits
+    {
+        static void AddRef(T *p) noexcept
+        {
+            p->AddRef();
+        }
+
+        static bool DelRef(T *p) noexcept
+        {
+            return p->DelRef();
+        }
+
+        static void Destroy(T *p) noexcept
+        {
+            if constexpr (requires { p->Destroy(); })
+            {
+                p->Destroy();
+            }
+            else
+            {
+                delete p;
+            }
+        }
+    };
+
+    template <typename T>
+    class AtomicLockFreeIntrusivePtr;
+
+    // Owning pointer to an object carrying its own count. Like
+    // LockFreeSharedPtr, one instance must not be mutated concurrently;
+    // AtomicLockFreeIntrusivePtr is the slot for that.
+    template <typename T>
+    class LockFreeIntrusivePtr
+    {
+    private:
+        using Traits = IntrusiveRefTraits<T>;
+
+        T *ptr_;
+
+        friend class AtomicLockFreeIntrusivePtr<T>;
+
+        static void release(T *p) noexcept
+        {
+            if (p && Traits::DelRef(p))
+            {
+                Traits::Destroy(p);
+            }
+        }
+
+    public:
+        using element_type = T;
+
+        // Tag for taking over a reference the caller already holds
+        struct adopt_ref_t
+        {
+        };
+        static constexpr adopt_ref_t adopt_ref{};
+
+        constexpr LockFreeIntrusivePtr() noexcept : ptr_{nullptr} {}
+        constexpr LockFreeIntrusivePtr(std::nullptr_t) noexcept : ptr_{nullptr} {}
+
+        explicit LockFreeIntrusivePtr(T *p) noexcept : ptr_{p}
+        {
+            if (ptr_)
+            {
+                Traits::AddRef(ptr_);
+            }
+        }
+
+        LockFreeIntrusivePtr(T *p, adopt_ref_t) noexcept : ptr_{p} {}
+
+        LockFreeIntrusivePtr(const LockFreeIntrusivePtr &other) noexcept : ptr_{other.ptr_}
+        {
+            if (ptr_)
+            {
+                Traits::AddRef(ptr_);
+            }
+        }
+
+        LockFreeIntrusivePtr(LockFreeIntrusivePtr &&other) noexcept : ptr_{other.ptr_}
+        {
+            other.ptr_ = nullptr;
+        }
+
+        LockFreeIntrusivePtr &operator=(const LockFreeIntrusivePtr &other) noexcept
+        {
+            LockFreeIntrusivePtr temp{other};
+            swap(temp);
+            return *this;
+        }
+
+        LockFreeIntrusivePtr &operator=(LockFreeIntrusivePtr &&other) noexcept
+        {
+            LockFreeIntrusivePtr temp{std::move(other)};
+            swap(temp);
+            return *this;
+        }
+
+        ~LockFreeIntrusivePtr()
+        {
+            release(ptr_);
+        }
+
+        void reset() noexcept
+        {
+            release(std::exchange(ptr_, nullptr));
+        }
+
+        void reset(T *p) noexcept
+        {
+            LockFreeIntrusivePtr temp{p};
+            swap(temp);
+        }
+
+        void swap(LockFreeIntrusivePtr &other) noexcept
+        {
+            std::swap(ptr_, other.ptr_);
+        }
+
+        // Gives up ownership without dropping the reference
+        T *detach() noexcept
+        {
+            return std::exchange(ptr_, nullptr);
+        }
+
+        T *get() const noexcept { return ptr_; }
+        T &operator*() const noexcept { return *ptr_; }
+        T *operator->() const noexcept { return ptr_; }
+
+        explicit operator bool() const noexcept
+        {
+            return ptr_ != nullptr;
+        }
+
+        friend bool operator==(const LockFreeIntrusivePtr &lhs, const LockFreeIntrusivePtr &rhs) noexcept
+        {
+            return lhs.ptr_ == rhs.ptr_;
+        }
+
+        friend bool operator==(const LockFreeIntrusivePtr &lhs, std::nullptr_t) noexcept
+        {
+            return lhs.ptr_ == nullptr;
+        }
+    };
+
+    template <typename T, typename... Args>
+    LockFreeIntrusivePtr<T> make_intrusive(Args &&...args)
+    {
+        return LockFreeIntrusivePtr<T>(new T(std::forward<Args>(args)...));
+    }
+
+    template <typename T>
+    void swap(LockFreeIntrusivePtr<T> &lhs, LockFreeIntrusivePtr<T> &rhs) noexcept
+    {
+        lhs.swap(rhs);
+    }
+
+    // Lock-free atomic slot holding a LockFreeIntrusivePtr.
+    //
+    // The slot owns one reference to its object. A reader guards the raw
+    // pointer with a hazard pointer, re-checks the slot and only then takes
+    // its own reference; a writer that replaces the object hands the slot's
+    // reference to the hazard domain, which drops it once no reader is
+    // between those two steps. The count therefore never reaches zero under
+    // a reader, without a lock or a wider CAS.
+    template <typename T>
+    class AtomicLockFreeIntrusivePtr
+    {
+    private:
+        using Ptr = LockFreeIntrusivePtr<T>;
+
+        atomic<T *> slot_;
+
+        static void retire(T *p)
+        {
+            if (p)
+            {
+                hazard_retire(static_cast<void *>(p), [](void *q)
+                              { Ptr::release(static_cast<T *>(q)); });
+            }
+        }
+
+    public:
+        static constexpr bool is_always_lock_free = atomic<T *>::is_always_lock_free;
+
+        AtomicLockFreeIntrusivePtr() noexcept : slot_{nullptr} {}
+
+        explicit AtomicLockFreeIntrusivePtr(Ptr desired) noexcept : slot_{desired.detach()} {}
+
+        AtomicLockFreeIntrusivePtr(const AtomicLockFreeIntrusivePtr &) = delete;
+        AtomicLockFreeIntrusivePtr &operator=(const AtomicLockFreeIntrusivePtr &) = delete;
+
+        // No other thread may still be using the slot
+        ~AtomicLockFreeIntrusivePtr()
+        {
+            Ptr::release(slot_.load(memory_order_acquire));
+        }
+
+        bool is_lock_free() const noexcept
+        {
+            return slot_.is_lock_free();
+        }
+
+        Ptr load() const
+        {
+            HazardPointer hp;
+            T *p = hp.protect(slot_);
+            if (p)
+            {
+                IntrusiveRefTraits<T>::AddRef(p);
+            }
+            return Ptr(p, Ptr::adopt_ref);
+        }
+
+        operator Ptr() const
+        {
+            return load();
+        }
+
+        void store(Ptr desired)
+        {
+            retire(slot_.exchange(desired.detach(), memory_order_acq_rel));
+        }
+
+        AtomicLockFreeIntrusivePtr &operator=(Ptr desired)
+        {
+            store(std::move(desired));
+            return *this;
+        }
+
+        // The slot's own reference to the old object is retired, not handed
+        // out, since readers may still be about to count it
+        Ptr exchange(Ptr desired)
+        {
+            T *old = slot_.exchange(desired.detach(), memory_order_acq_rel);
+            Ptr result(old);
+            retire(old);
+            return result;
+        }
+
+        // On failure expected is reloaded from the slot
+        bool compare_exchange_strong(Ptr &expected, Ptr desired)
+        {
+            T *current = expected.get();
+            T *wanted = desired.get();
+            if (slot_.compare_exchange_strong(current, wanted, memory_order_acq_rel, memory_order_acquire))
+            {
+                desired.detach();
+                retire(current);
+                return true;
+            }
+            expected = load();
+            return false;
+        }
+
+        bool compare_exchange_weak(Ptr &expected, Ptr desired)
+        {
+            return compare_exchange_strong(expected, std::move(desired));
+        }
+    };
+}
+
+// Hash specialization in std namespace
+export namespace std
+{
+    template <typename T>
+    struct hash<ThreadSafeWorld::LockFreeIntrusivePtr<T>>
+    {
+        size_t operator()(const ThreadSafeWorld::LockFreeIntrusivePtr<T> &ptr) const noexcept
+        {
+            return hash<T *>()(ptr.get());
+        }
+    };
+}
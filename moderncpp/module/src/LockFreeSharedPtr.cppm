@@ -1,20 +1,35 @@
 module;
 #include <atomic>
 #include <utility>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
 export module leonrahul.LockFreeSharedPtr;
+export import leonrahul.DeferredReclaimer;
+export import leonrahul.ContentionStats;
+import leonrahul.ControlBlockPool;
 
 using namespace std;
 
 export namespace ThreadSafeWorld
 {
 
-    class ControlBlock
+    // Control blocks are the count policy of LockFreeSharedPtr. Each one
+    // provides addRef()/removeRef() returning the previous count, getCount(),
+    // thread_safe telling release() whether it needs a fence, and deferred
+    // telling it to hand the object to the deferred reclaimer. Blocks come
+    // from ControlBlockPool.
+    class ControlBlock : public PoolAllocated
     {
 
     private:
         atomic<int> count;
 
     public:
+        static constexpr bool thread_safe = true;
+        static constexpr bool deferred = false;
+
         ControlBlock() : count{1} {};
         int addRef()
         {
@@ -31,18 +46,222 @@ export namespace ThreadSafeWorld
         }
     };
 
-    template <typename T>
+    // Control block for objects that never leave the thread that created
+    // them: a plain int, so copies and drops cost no atomic RMW. Debug builds
+    // remember the owning thread and trap on use from any other.
+    class LocalControlBlock : public PoolAllocated
+    {
+
+    private:
+        int count;
+#ifndef NDEBUG
+        std::thread::id owner;
+#endif
+
+        void checkOwner() const
+        {
+#ifndef NDEBUG
+            assert(owner == std::this_thread::get_id() && "LocalSharedPtr used outside its owning thread");
+#endif
+        }
+
+    public:
+        static constexpr bool thread_safe = false;
+        static constexpr bool deferred = false;
+
+        LocalControlBlock() : count{1}
+        {
+#ifndef NDEBUG
+            owner = std::this_thread::get_id();
+#endif
+        }
+        int addRef()
+        {
+            checkOwner();
+            return count++;
+        }
+        int removeRef()
+        {
+            checkOwner();
+            return count--;
+        }
+
+        int getCount() const
+        {
+            checkOwner();
+            return count;
+        }
+    };
+
+    // Control block whose last release queues the object and the block on the
+    // releasing thread's deferred list instead of deleting them inline;
+    // drain_deferred() or the background reclaimer destroys them later.
+    class DeferredControlBlock : public ControlBlock, private DeferredNode
+    {
+    private:
+        void *object = nullptr;
+
+        template <typename T>
+        static void reclaim(DeferredNode *node)
+        {
+            auto *self = static_cast<DeferredControlBlock *>(node);
+            delete static_cast<T *>(self->object);
+            delete self;
+        }
+
+    public:
+        static constexpr bool deferred = true;
+
+        template <typename T>
+        void deferDestroy(T *ptr)
+        {
+            object = ptr;
+            deferred_reclaim = &reclaim<T>;
+            defer_reclaim(this);
+        }
+    };
+
+    // Control block for hot, long-lived objects copied by many threads at
+    // once. Counts are striped over cache-line padded shards, one per group
+    // of threads, on top of a central word holding the creation reference;
+    // copies and drops then touch the shard of the calling thread only.
+    //
+    // A shard on its own may go negative when a reference is dropped on
+    // another thread than the one that took it. While none does, every shard
+    // is >= 0 and the central reference keeps the total above zero, so no
+    // drop can be the last. The first drop that takes a shard below zero
+    // folds the shards into the central word in two phases: each shard is
+    // sealed with one exchange, which also yields its count, and the count
+    // is moved to the central word together with the shard's "not yet
+    // folded" mark. Only once every mark is gone can the central word read
+    // zero, and the RMW that brings it there belongs to the last reference.
+    // Operations that hit a sealed shard redo themselves on the central word,
+    // and later ones go there directly, as with ControlBlock.
+    //
+    // addRef() and removeRef() return 1 for the last reference and 2
+    // otherwise, not the exact count. The block is far larger than the
+    // pool's size classes and comes from the aligned global allocator.
+    class ShardedControlBlock
+    {
+    public:
+        static constexpr bool thread_safe = true;
+        static constexpr bool deferred = false;
+        static constexpr size_t shard_count = 16;
+
+        ShardedControlBlock() = default;
+        ShardedControlBlock(const ShardedControlBlock &) = delete;
+        ShardedControlBlock &operator=(const ShardedControlBlock &) = delete;
+
+        int addRef()
+        {
+            if (!folded.load(memory_order_relaxed))
+            {
+                int64_t prev = shards[localShard()].count.fetch_add(1, memory_order_relaxed);
+                if (!isSealed(prev))
+                {
+                    return 2;
+                }
+            }
+            central.fetch_add(1, memory_order_acq_rel);
+            return 2;
+        }
+
+        int removeRef()
+        {
+            if (!folded.load(memory_order_relaxed))
+            {
+                int64_t prev = shards[localShard()].count.fetch_sub(1, memory_order_acq_rel);
+                if (!isSealed(prev))
+                {
+                    return prev > 0 ? 2 : fold();
+                }
+            }
+            int64_t prev = central.fetch_sub(1, memory_order_acq_rel);
+            return prev == 1 ? 1 : 2;
+        }
+
+        // Exact only while no other thread copies or drops the pointer
+        int getCount() const
+        {
+            int64_t total = static_cast<int32_t>(central.load(memory_order_acquire) & count_mask);
+            if (!folded.load(memory_order_acquire))
+            {
+                for (const Shard &shard : shards)
+                {
+                    int64_t count = shard.count.load(memory_order_acquire);
+                    total += isSealed(count) ? 0 : count;
+                }
+            }
+            return static_cast<int>(total);
+        }
+
+    private:
+        struct alignas(64) Shard
+        {
+            atomic<int64_t> count{0};
+        };
+
+        static constexpr int64_t unfolded_one = int64_t{1} << 32;
+        static constexpr int64_t count_mask = unfolded_one - 1;
+        // Far below any count, so a sealed shard stays recognisable however
+        // many late updates land on it
+        static constexpr int64_t sealed = INT64_MIN / 2;
+
+        // Low half: the folded count. High half: shards not yet folded.
+        alignas(64) atomic<int64_t> central{static_cast<int64_t>(shard_count) * unfolded_one + 1};
+        atomic<bool> folded{false};
+        Shard shards[shard_count];
+
+        static inline atomic<size_t> next_shard{0};
+
+        static bool isSealed(int64_t count) noexcept
+        {
+            return count < sealed / 2;
+        }
+
+        static size_t localShard() noexcept
+        {
+            static thread_local size_t index = next_shard.fetch_add(1, memory_order_relaxed) % shard_count;
+            return index;
+        }
+
+        // Seals every shard still open and moves its count to the central
+        // word. Concurrent folders split the shards between them; whoever
+        // brings the word to zero holds the last reference.
+        int fold()
+        {
+            folded.store(true, memory_order_relaxed);
+            bool last = false;
+            for (Shard &shard : shards)
+            {
+                int64_t count = shard.count.exchange(sealed, memory_order_acq_rel);
+                if (isSealed(count))
+                {
+                    continue;
+                }
+                int64_t delta = count - unfolded_one;
+                if (central.fetch_add(delta, memory_order_acq_rel) + delta == 0)
+                {
+                    last = true;
+                }
+            }
+            return last ? 1 : 2;
+        }
+    };
+
+    template <typename T, typename Block = ControlBlock>
     class LockFreeSharedPtr
     {
     private:
-        ControlBlock *cb;
+        Block *cb;
         T *ptr;
 
     public:
         LockFreeSharedPtr() : cb{nullptr}, ptr{nullptr} {};
         constexpr LockFreeSharedPtr(std::nullptr_t) : cb{nullptr}, ptr{nullptr} {};
-        LockFreeSharedPtr(T *ptr) : cb{new ControlBlock()}, ptr{ptr}
+        LockFreeSharedPtr(T *ptr) : cb{new Block()}, ptr{ptr}
         {
+            ContentionStats::record(ContentionEvent::Allocation);
         };
 
         // copy Constructor
@@ -113,7 +332,8 @@ export namespace ThreadSafeWorld
         void reset(T *p)
         {
             release();
-            cb = new ControlBlock();
+            cb = new Block();
+            ContentionStats::record(ContentionEvent::Allocation);
             ptr = p;
         }   
         void
@@ -121,13 +341,23 @@ export namespace ThreadSafeWorld
         {
             if (cb && cb->removeRef() == 1) // count now becomes 0
             {
-                atomic_thread_fence(memory_order_acquire); // the acquire fence is required , beacuse all the writes must
+                if constexpr (Block::thread_safe)
+                {
+                    atomic_thread_fence(memory_order_acquire);
+                } // the acquire fence is required , beacuse all the writes must
                 // be visble by all threads , we have memory order release for cnt sub in control block , and we need to ensure
                 // visibility of all the writes before destruction only
                 //  release the memory
-                
-                delete ptr;
-                delete cb;
+                ContentionStats::record(ContentionEvent::FinalRelease);
+                if constexpr (Block::deferred)
+                {
+                    cb->deferDestroy(ptr);
+                }
+                else
+                {
+                    delete ptr;
+                    delete cb;
+                }
                 cb = nullptr;
                 ptr = nullptr;
             }
@@ -157,4 +387,16 @@ export namespace ThreadSafeWorld
         }
 
     };
+
+    // Same API as LockFreeSharedPtr for object graphs confined to one thread
+    template <typename T>
+    using LocalSharedPtr = LockFreeSharedPtr<T, LocalControlBlock>;
+
+    // LockFreeSharedPtr whose last drop never runs the destructor inline
+    template <typename T>
+    using DeferredSharedPtr = LockFreeSharedPtr<T, DeferredControlBlock>;
+
+    // LockFreeSharedPtr for objects copied concurrently by many threads
+    template <typename T>
+    using ShardedSharedPtr = LockFreeSharedPtr<T, ShardedControlBlock>;
 }
@@ -5,8 +5,11 @@ module; // Start module declaration
 #include <type_traits> // For std::is_array, std::is_function
 #include <cstddef>     // For std::nullptr_t, std::size_t
 #include <memory>
+#include <memory_resource>
+#include <new>         // For std::launder
 
 export module leonrahul.LockFreeSharedPtrGemini; // Export the module
+import leonrahul.ControlBlockPool;
 
 export namespace ThreadSafeWorld
 {
@@ -21,13 +24,27 @@ export namespace ThreadSafeWorld
     // Manages the reference count and deletion logic
     class ControlBlockBase
     {
+    public:
+        // Type-specific steps, one constant table per block type, so blocks
+        // need no vtable and the common case can skip it altogether
+        struct Ops
+        {
+            void (*dispose)(ControlBlockBase *) noexcept;
+            void (*destroy)(ControlBlockBase *) noexcept;
+        };
+
     private:
+        const Ops *ops_;
         std::atomic<long> shared_count_{1}; // Starts at 1 for the initial owner
         std::atomic<long> weak_count_{0};   // Weak reference count
 
-    public:
-        ControlBlockBase() = default;
+    protected:
+        explicit ControlBlockBase(const Ops &ops) noexcept : ops_(&ops) {}
 
+        // Blocks are only ever destroyed through their own table
+        ~ControlBlockBase() = default;
+
+    public:
         // Prevent copying/moving of the control block itself
         ControlBlockBase(const ControlBlockBase &) = delete;
         ControlBlockBase &operator=(const ControlBlockBase &) = delete;
@@ -77,18 +94,31 @@ export namespace ThreadSafeWorld
             return count > 0;
         }
 
-        // Virtual destructor ensures derived class destructors are called
-        // correctly when deleting via a base pointer. Also handles deleting
-        // the managed object itself.
-        virtual ~ControlBlockBase() = default;
+        // True if this block was built as a Block, whose steps may then be
+        // called directly
+        template <typename Block>
+        bool isA() const noexcept
+        {
+            return ops_ == &Block::ops;
+        }
 
-        // Abstract method to delete the managed object.
-        virtual void dispose() noexcept = 0;
+        // Deletes the managed object.
+        void dispose() noexcept
+        {
+            ops_->dispose(this);
+        }
+
+        // Frees the control block itself once both counts are gone.
+        void destroy() noexcept
+        {
+            ops_->destroy(this);
+        }
     };
 
-    // Template derived control block to handle specific object type T
+    // Template derived control block to handle specific object type T,
+    // allocated from ControlBlockPool
     template <typename T, typename Deleter = std::default_delete<T>, typename Allocator = std::allocator<T>>
-    class ControlBlockImpl final : public ControlBlockBase
+    class ControlBlockImpl final : public ControlBlockBase, public PoolAllocated
     {
     private:
         T *ptr_;
@@ -96,60 +126,85 @@ export namespace ThreadSafeWorld
         [[no_unique_address]] Allocator alloc_;
 
     public:
-        // Store the pointer and potentially a custom deleter
-        explicit ControlBlockImpl(T *p, Deleter d = Deleter(), Allocator a = Allocator())
-            : ptr_(p), deleter_(std::move(d)), alloc_(std::move(a)) {}
-
         // Dispose calls the deleter on the stored pointer
-        void dispose() noexcept override
+        static void disposeBlock(ControlBlockBase *cb) noexcept
         {
-            if (ptr_)
+            auto *self = static_cast<ControlBlockImpl *>(cb);
+            if (self->ptr_)
             {
-                deleter_(ptr_);
-                ptr_ = nullptr; // Avoid double deletion if dispose called again (shouldn't happen)
+                self->deleter_(self->ptr_);
+                self->ptr_ = nullptr; // Avoid double deletion if dispose called again (shouldn't happen)
             }
         }
 
-        // Destructor for ControlBlockImpl itself (called after dispose)
-        ~ControlBlockImpl() override = default; // Implicitly calls base destructor
+        // Returns the block to ControlBlockPool (called after dispose)
+        static void destroyBlock(ControlBlockBase *cb) noexcept
+        {
+            delete static_cast<ControlBlockImpl *>(cb);
+        }
+
+        static constexpr Ops ops{&disposeBlock, &destroyBlock};
+
+        // Store the pointer and potentially a custom deleter
+        explicit ControlBlockImpl(T *p, Deleter d = Deleter(), Allocator a = Allocator())
+            : ControlBlockBase(ops), ptr_(p), deleter_(std::move(d)), alloc_(std::move(a)) {}
     };
 
     // Optimized control block for make_shared that combines object and control data
-    template <typename T>
+    // in a single allocation obtained from Allocator (rebound to this type).
+    // The object is built through the allocator as well, so allocator-aware
+    // members of T share a pmr::polymorphic_allocator's resource.
+    template <typename T, typename Allocator = std::allocator<T>>
     class ControlBlockMakeShared final : public ControlBlockBase
     {
     private:
+        using BlockAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<ControlBlockMakeShared>;
+        using ObjectAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+
         alignas(T) unsigned char object_buffer_[sizeof(T)];
-        T *ptr_;
+        [[no_unique_address]] BlockAllocator alloc_;
 
     public:
-        template <typename... Args>
-        explicit ControlBlockMakeShared(Args &&...args)
+        static void disposeBlock(ControlBlockBase *cb) noexcept
         {
-            ptr_ = new (&object_buffer_) T(std::forward<Args>(args)...);
+            auto *self = static_cast<ControlBlockMakeShared *>(cb);
+            ObjectAllocator alloc(self->alloc_);
+            std::allocator_traits<ObjectAllocator>::destroy(alloc, self->get());
         }
 
-        void dispose() noexcept override
+        // Releases the fused block through a copy of the allocator, since the
+        // stored one dies with the block.
+        static void destroyBlock(ControlBlockBase *cb) noexcept
         {
-            if (ptr_)
-            {
-                ptr_->~T();
-                ptr_ = nullptr;
-            }
+            auto *self = static_cast<ControlBlockMakeShared *>(cb);
+            BlockAllocator alloc(std::move(self->alloc_));
+            self->~ControlBlockMakeShared();
+            std::allocator_traits<BlockAllocator>::deallocate(alloc, self, 1);
         }
 
-        T *get() noexcept { return ptr_; }
+        static constexpr Ops ops{&disposeBlock, &destroyBlock};
+
+        template <typename... Args>
+        explicit ControlBlockMakeShared(const Allocator &a, Args &&...args)
+            : ControlBlockBase(ops), alloc_(a)
+        {
+            ObjectAllocator alloc(a);
+            std::allocator_traits<ObjectAllocator>::construct(alloc, reinterpret_cast<T *>(&object_buffer_),
+                                                              std::forward<Args>(args)...);
+        }
 
-        ~ControlBlockMakeShared() override = default;
+        // The object sits at a fixed place in the block, so no pointer to it
+        // is stored
+        T *get() noexcept { return std::launder(reinterpret_cast<T *>(&object_buffer_)); }
     };
 
     // --- LockFreeSharedPtrGemini ---
     template <typename T>
     class LockFreeSharedPtrGemini
     {
-        // Friend declaration for make_shared (optional, but good practice)
-        template <typename U, typename... Args>
-        friend LockFreeSharedPtrGemini<U> make_lock_free_shared(Args &&...args);
+        // Friend declaration for the fused-allocation factory
+        template <typename U, typename Allocator, typename... Args>
+        friend LockFreeSharedPtrGemini<U> allocate_lock_free_shared(const Allocator &alloc, Args &&...args);
 
         // Friend declaration for enabling conversions (e.g., shared_ptr<Derived> to shared_ptr<Base>)
         template <typename U>
@@ -288,7 +343,19 @@ export namespace ThreadSafeWorld
                 // are visible *before* we proceed with deletion.
                 std::atomic_thread_fence(std::memory_order_acquire);
 
-                // Delete the managed object via the control block's virtual dispose
+                // A block of the raw-pointer constructor with the default
+                // deleter is destroyed through direct calls; any other goes
+                // through its table
+                using DefaultBlock = ControlBlockImpl<T>;
+                if (temp_cb->isA<DefaultBlock>())
+                {
+                    DefaultBlock::disposeBlock(temp_cb);
+                    std::atomic_thread_fence(std::memory_order_release);
+                    DefaultBlock::destroyBlock(temp_cb);
+                    return;
+                }
+
+                // Delete the managed object via the control block's dispose
                 temp_cb->dispose();
 
                 // Delete the control block itself.
@@ -297,7 +364,7 @@ export namespace ThreadSafeWorld
                 // critical here as no other thread should access cb anymore,
                 // it doesn't hurt.
                 std::atomic_thread_fence(std::memory_order_release);
-                delete temp_cb;
+                temp_cb->destroy();
             }
         }
 
@@ -389,65 +456,53 @@ export namespace ThreadSafeWorld
         return !(nullptr == rhs);
     }
 
-    // --- `make_lock_free_shared` Factory Function ---
-    // Creates an object of type T and wraps it in a LockFreeSharedPtrGemini,
-    // allocating the object and control block in potentially one allocation (optimization).
-    // Provides exception safety.
-    template <typename T, typename... Args>
-    LockFreeSharedPtrGemini<T> make_lock_free_shared(Args &&...args)
+    // --- `allocate_lock_free_shared` Factory Function ---
+    // Creates an object of type T inside its control block, so the object and
+    // both counts come from a single allocation made through `alloc`
+    // (rebound to the block type), like std::allocate_shared.
+    // If T's constructor throws, the storage is returned and the exception
+    // propagates.
+    template <typename T, typename Allocator, typename... Args>
+    LockFreeSharedPtrGemini<T> allocate_lock_free_shared(const Allocator &alloc, Args &&...args)
     {
-        static_assert(!std::is_array_v<T>, "make_lock_free_shared does not support arrays.");
-        // In a real implementation, you might optimize by allocating
-        // T and ControlBlockImpl<T> contiguously in memory.
-        // For simplicity here, we use separate allocations but ensure safety.
+        static_assert(!std::is_array_v<T>, "allocate_lock_free_shared does not support arrays.");
 
-        // Allocate the control block first (or together with T in optimized version)
-        // Use default deleter since we are creating the object.
-        auto *cb = new ControlBlockImpl<T>(nullptr); // Temporarily null ptr
+        using Block = ControlBlockMakeShared<T, Allocator>;
+        using BlockAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Block>;
+        using Traits = std::allocator_traits<BlockAllocator>;
+
+        BlockAllocator block_alloc(alloc);
+        Block *cb = Traits::allocate(block_alloc, 1);
         try
         {
-            // Construct T using placement new if optimizing, or regular new here.
-            // If new T throws, cb is leaked unless we handle it.
-            // Let's allocate T first for simpler exception handling here.
-            T *obj = new T(std::forward<Args>(args)...);
-
-            // Now create the control block, passing the successfully created object.
-            // If this new throws, obj needs deletion.
-            ControlBlockBase *obj_cb = new ControlBlockImpl<T>(obj); // Takes ownership
-
-            // Use the private constructor
-            return LockFreeSharedPtrGemini<T>(obj, obj_cb);
+            ::new (static_cast<void *>(cb)) Block(alloc, std::forward<Args>(args)...);
         }
         catch (...)
         {
-            // If T construction or ControlBlockImpl construction fails after
-            // the other succeeded, clean up.
-            // Note: A truly optimized make_shared allocates T and CB together,
-            // simplifying cleanup. This basic version shows the principle.
-            // A more robust implementation is needed for full exception safety
-            // with separate allocations.
-            // For this example, we'll assume ControlBlockImpl constructor won't throw
-            // after T is constructed, which is reasonable for default deleter.
-            // If T construction throws, obj_cb isn't created.
-            // If ControlBlockImpl throws, obj needs deletion (handled by its constructor).
-            // Let's simplify the try-catch for this example:
-
-            /* Simplified approach (less robust than std::make_shared): */
-            T *obj = new T(std::forward<Args>(args)...);
-            ControlBlockBase *obj_cb = nullptr;
-            try
-            {
-                obj_cb = new ControlBlockImpl<T>(obj); // Takes ownership
-                return LockFreeSharedPtrGemini<T>(obj, obj_cb);
-            }
-            catch (...)
-            {
-                delete obj; // Clean up if control block fails
-                throw;
-            }
+            Traits::deallocate(block_alloc, cb, 1);
+            throw;
         }
-        // The above try-catch logic needs refinement for full standard compliance.
-        // A single allocation strategy is much preferred.
+        ControlBlockBase *base_cb = cb; // Selects the private (ptr, cb) constructor
+        return LockFreeSharedPtrGemini<T>(cb->get(), base_cb);
+    }
+
+    // --- `allocate_lock_free_shared_pmr` Factory Function ---
+    // Same, with the block taken from a memory resource such as a
+    // per-request monotonic arena.
+    template <typename T, typename... Args>
+    LockFreeSharedPtrGemini<T> allocate_lock_free_shared_pmr(std::pmr::memory_resource *mr, Args &&...args)
+    {
+        return allocate_lock_free_shared<T>(std::pmr::polymorphic_allocator<T>(mr), std::forward<Args>(args)...);
+    }
+
+    // --- `make_lock_free_shared` Factory Function ---
+    // Creates an object of type T and wraps it in a LockFreeSharedPtrGemini,
+    // allocating the object and control block together with std::allocator.
+    template <typename T, typename... Args>
+    LockFreeSharedPtrGemini<T> make_lock_free_shared(Args &&...args)
+    {
+        static_assert(!std::is_array_v<T>, "make_lock_free_shared does not support arrays.");
+        return allocate_lock_free_shared<T>(std::allocator<T>(), std::forward<Args>(args)...);
     }
 
     // --- Swap function ---
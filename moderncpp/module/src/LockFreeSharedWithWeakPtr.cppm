@@ -3,7 +3,19 @@ module;
 #include <utility>
 #include <memory>
 #include <functional>
+#include <cstdint>
+#include <cassert>
+#include <algorithm>
+#include <type_traits>
+#include <limits>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
 export module leonrahul.LockFreeSharedWithWeakPtr;
+export import leonrahul.HazardPointer;
+export import leonrahul.DeferredReclaimer;
+export import leonrahul.ContentionStats;
+import leonrahul.ControlBlockPool;
 
 using namespace std;
 
@@ -11,185 +23,856 @@ using namespace std;
 template<typename T> struct hash;
 
 export namespace ThreadSafeWorld {
-    template<typename T> class LockFreeWeakPtr;  // Forward declaration
+    template<typename T> class AtomicLockFreeSharedPtr;
+    template<typename T> class SharedRef;
     template<typename T, typename Deleter, typename Allocator> class ControlBlockWithDeleter;
     template<typename T, typename Allocator> class ControlBlockMakeShared;
+    template<typename T, size_t Align> class ControlBlockArray;
+
+    class ControlBlock;
+
+    // --- Biased reference counting ---
+    // A biased block belongs to the thread that created it. That thread counts
+    // its references in a plain int; every other thread uses the atomic shared
+    // count, which may go negative when references migrate. The two are merged
+    // when the owner drops its last biased reference. A non-owner that drives
+    // the shared count negative queues the block on the owner, who merges it at
+    // its next release, drain_biased_merges() or thread exit; once the owner
+    // has exited, that thread merges the block itself.
+
+    // Per-thread record that biased blocks point back to
+    struct BiasedOwner {
+        atomic<ControlBlock*> queue{nullptr};
+        // The owning thread plus every block still biased towards it
+        atomic<int> refs{1};
+
+        // Marks a queue whose owner has exited
+        static ControlBlock* closed() noexcept {
+            return reinterpret_cast<ControlBlock*>(uintptr_t{1});
+        }
+
+        void drain() noexcept;
+
+        void release() noexcept {
+            if (refs.fetch_sub(1, memory_order_acq_rel) == 1) {
+                delete this;
+            }
+        }
+    };
+
+    // Owner-side state of a biased block. Only the owner thread touches
+    // `biased` and `merged` until the block is merged or the owner exits.
+    struct BiasedCounts {
+        BiasedOwner* owner{nullptr};
+        int biased{1};
+        bool merged{false};
+        ControlBlock* next{nullptr};
+    };
+
+    // Gives each thread its BiasedOwner on first use and closes it at exit
+    struct BiasedOwnerSlot {
+        BiasedOwner* owner{nullptr};
+
+        BiasedOwner* get() {
+            if (!owner) {
+                owner = new BiasedOwner;
+            }
+            return owner;
+        }
+
+        ~BiasedOwnerSlot();
+    };
+
+    inline thread_local BiasedOwnerSlot biased_owner_slot;
+
+    // What happens once the last strong reference is gone
+    enum class Reclamation : uint8_t {
+        Immediate,  // destroy the object right away
+        Hazard,     // retire to the hazard domain, destroy once no reader holds it
+        Deferred    // queue for drain_deferred() or the background reclaimer
+    };
+
+    // How a LockFreeSharedWithWeakPtr stores its control block and object
+    // pointers
+    enum class PointerLayout : uint8_t {
+        Pair,   // both side by side, updated with a 16-byte CAS where there
+                // is one and behind a spin flag where there is not
+        Packed  // one 64-bit word: the block in the low 48 bits and the
+                // object's offset from the block's own object in the top 16
+    };
+
+    // Packed is opt-in: an aliased pointer must stay within 32 KiB of the
+    // owned object to fit in it, which code written against Pair, say one
+    // aliasing a global, cannot be assumed to respect
+    inline constexpr PointerLayout default_pointer_layout = PointerLayout::Pair;
+
+    template<typename T, PointerLayout Layout = default_pointer_layout> class LockFreeWeakPtr;
+
+    // Base control block. Instead of a vtable, each block type points it at
+    // one constant table of its type-specific steps.
+    class ControlBlock : private DeferredNode {
+    public:
+        struct Ops {
+            void (*destroy_object)(ControlBlock*) noexcept;
+            void (*destroy_this)(ControlBlock*) noexcept;
+        };
 
-    // Base control block with virtual destructor
-    class ControlBlock {
     private:
-        atomic<int> use_count{1};
-        atomic<int> weak_count{0};
-        atomic<bool> object_expired{false};
+        const Ops* table;
+        // Both counts in one word, so upgrading a weak reference, dropping
+        // the last strong one and deciding to free the block each take a
+        // single RMW on one cache line:
+        //   bits 63..32  strong count; in biased mode the shared count,
+        //                packed as (count << 2) | queued << 1 | merged
+        //   bits 31..1   weak count
+        //   bit  0       set until destroy_object() has run; it acts as
+        //                one more weak reference held for the strong side
+        // The strong half sits on top so that it can go negative, as
+        // biased counts do, without borrowing from the weak half.
+        atomic<uint64_t> counts{strong_one | object_alive};
+        Reclamation reclamation{Reclamation::Immediate};
+        BiasedCounts* bias{nullptr};
+        // The owned object, fixed at construction so packed pointers can
+        // recover it from the block alone
+        void* object_address{nullptr};
+#ifndef NDEBUG
+        // SharedRefs currently borrowing the object
+        atomic<int> borrows{0};
+#endif
+
+        static constexpr int strong_shift = 32;
+        static constexpr uint64_t strong_one = uint64_t{1} << strong_shift;
+        static constexpr uint64_t weak_one = 2;
+        static constexpr uint64_t object_alive = 1;
+        static constexpr uint64_t weak_mask = strong_one - 1;
+
+        static constexpr int bias_merged = 1;
+        static constexpr int bias_queued = 2;
+        static constexpr int bias_one = 4;
+
+        static int strongOf(uint64_t word) noexcept {
+            return static_cast<int32_t>(static_cast<uint32_t>(word >> strong_shift));
+        }
+
+        // Adds a signed amount to the strong half; wraps within that half
+        static uint64_t strongDelta(int delta) noexcept {
+            return uint64_t{static_cast<uint32_t>(delta)} << strong_shift;
+        }
+
+        static uint64_t withStrong(uint64_t word, int strong) noexcept {
+            return (word & weak_mask) | strongDelta(strong);
+        }
+
+        friend struct BiasedOwner;
+        friend struct BiasedOwnerSlot;
+
+    protected:
+        explicit ControlBlock(const Ops& ops) noexcept : table(&ops) {
+            ContentionStats::record(ContentionEvent::Allocation);
+        }
+        ~ControlBlock() = default;
+
+        void setObjectAddress(const volatile void* p) noexcept {
+            object_address = const_cast<void*>(p);
+        }
+
+        // Switches a freshly created block, still private to the creating
+        // thread, to biased counting with that thread as owner
+        void enableBiasing(BiasedCounts& counts) {
+            counts.owner = biased_owner_slot.get();
+            counts.owner->refs.fetch_add(1, memory_order_relaxed);
+            this->counts.store(object_alive, memory_order_relaxed);
+            bias = &counts;
+        }
 
     public:
-        virtual ~ControlBlock() = default;
-        virtual void destroy_object() noexcept = 0;
-        virtual void destroy_this() noexcept = 0;
+        void destroy_object() noexcept {
+            table->destroy_object(this);
+        }
+
+        void destroy_this() noexcept {
+            table->destroy_this(this);
+        }
+
+        // Still valid, as an address, after the object is destroyed
+        void* objectAddress() const noexcept {
+            return object_address;
+        }
 
         void addRef() noexcept {
-            use_count.fetch_add(1, memory_order_acq_rel);
+            if (bias) [[unlikely]] {
+                biasedAddRef();
+                return;
+            }
+            counts.fetch_add(strong_one, memory_order_acq_rel);
         }
 
         int removeRef() noexcept {
-            int prev = use_count.fetch_sub(1, memory_order_acq_rel);
-            if (prev == 1) {
-                atomic_thread_fence(memory_order_acquire);
-                object_expired.store(true, memory_order_release);
+            if (bias) [[unlikely]] {
+                return biasedRemoveRef();
+            }
+            // The only reference and no weak ones: no other thread can
+            // reach the counts any more, so skip the RMW
+            if (counts.load(memory_order_acquire) == (strong_one | object_alive)) {
+                counts.store(object_alive, memory_order_relaxed);
+                return 1;
             }
-            return prev;
+            return strongOf(counts.fetch_sub(strong_one, memory_order_acq_rel));
         }
 
-        void addWeakRef() noexcept {
-            weak_count.fetch_add(1, memory_order_acq_rel);
+        // Runs after the last strong reference is gone. Hazard blocks are
+        // retired instead, as readers may still be inside the object, and
+        // deferred blocks are queued to be destroyed off this thread's path.
+        void releaseLast() noexcept {
+            noteLastRelease();
+            switch (reclamation) {
+            case Reclamation::Hazard:
+                hazard_retire(this, [](void* cb) {
+                    static_cast<ControlBlock*>(cb)->reclaim();
+                });
+                return;
+            case Reclamation::Deferred:
+                deferred_reclaim = [](DeferredNode* node) {
+                    static_cast<ControlBlock*>(node)->reclaim();
+                };
+                defer_reclaim(this);
+                return;
+            case Reclamation::Immediate:
+                break;
+            }
+            reclaim();
         }
 
-        void removeWeakRef() noexcept {
-            if (weak_count.fetch_sub(1, memory_order_acq_rel) == 1) {
-                atomic_thread_fence(memory_order_acquire);
-                if (use_count_val() == 0) {
+        // Same, for a caller that expects a block of type Likely: when the
+        // guess is right the object and block are destroyed through direct
+        // calls the compiler can inline, not through the table
+        template<typename Likely>
+        void releaseLast() noexcept {
+            if (table == &Likely::ops && reclamation == Reclamation::Immediate) [[likely]] {
+                noteLastRelease();
+                reclaim<Likely>();
+                return;
+            }
+            releaseLast();
+        }
+
+        // Destroys the object, and the block too unless weak references
+        // remain. Block, if given, is the block's exact type.
+        template<typename Block = void>
+        void reclaim() noexcept {
+            if constexpr (is_void_v<Block>) {
+                destroy_object();
+            } else {
+                Block::destroyObject(this);
+            }
+            // Drops the strong side's weak reference. With no strong
+            // references left no new weak ones can appear, so if none exist
+            // the block is freed without an RMW.
+            if (counts.load(memory_order_acquire) == object_alive ||
+                (counts.fetch_sub(object_alive, memory_order_acq_rel) & weak_mask) == object_alive) {
+                if constexpr (is_void_v<Block>) {
                     destroy_this();
+                } else {
+                    Block::destroyThis(this);
                 }
             }
         }
 
+        // Debug builds count SharedRef borrows, so that losing the last
+        // owner while one is still in use is caught; release builds keep
+        // no count at all
+        void addBorrow() noexcept {
+#ifndef NDEBUG
+            borrows.fetch_add(1, memory_order_relaxed);
+#endif
+        }
+
+        void removeBorrow() noexcept {
+#ifndef NDEBUG
+            borrows.fetch_sub(1, memory_order_relaxed);
+#endif
+        }
+
+        // Must be set before the block is shared with other threads
+        void setReclamation(Reclamation mode) noexcept {
+            reclamation = mode;
+        }
+
+        void addWeakRef() noexcept {
+            counts.fetch_add(weak_one, memory_order_relaxed);
+        }
+
+        // The last weak reference frees the block only once the object is
+        // gone too, which also covers objects still retired or deferred
+        void removeWeakRef() noexcept {
+            if ((counts.fetch_sub(weak_one, memory_order_acq_rel) & weak_mask) == weak_one) {
+                destroy_this();
+            }
+        }
+
+        // One CAS on the combined word, so the upgrade cannot interleave
+        // with the final release
         bool tryAddRef() noexcept {
-            int count = use_count.load(memory_order_relaxed);
-            while (count != 0) {
-                if (use_count.compare_exchange_weak(count, count + 1,
+            if (bias) [[unlikely]] {
+                return biasedTryAddRef();
+            }
+            uint64_t word = counts.load(memory_order_relaxed);
+            while (strongOf(word) != 0) {
+                if (counts.compare_exchange_weak(word, word + strong_one,
                     memory_order_acq_rel, memory_order_relaxed)) {
                     return true;
                 }
+                ContentionStats::record(ContentionEvent::CasFailure);
             }
             return false;
         }
 
         bool isExpired() const noexcept {
-            return use_count.load(memory_order_acquire) == 0;
+            return use_count_val() == 0;
         }
 
         int use_count_val() const noexcept
         {
-            return use_count.load(memory_order_acquire);
+            if (bias) [[unlikely]] {
+                return biasedUseCount();
+            }
+            return strongOf(counts.load(memory_order_acquire));
         }
 
         int weak_count_val() const noexcept
         {
-            return weak_count.load(memory_order_acquire);
+            return static_cast<int>((counts.load(memory_order_acquire) & weak_mask) >> 1);
+        }
+
+    private:
+        void noteLastRelease() noexcept {
+            ContentionStats::record(ContentionEvent::FinalRelease);
+#ifndef NDEBUG
+            assert(borrows.load(memory_order_relaxed) == 0 &&
+                   "last owner released while a SharedRef still borrows the object");
+#endif
+        }
+
+        bool ownedByThisThread() const noexcept {
+            return bias->owner == biased_owner_slot.owner && !bias->merged;
+        }
+
+        void biasedAddRef() noexcept {
+            if (ownedByThisThread()) {
+                ++bias->biased;
+            } else {
+                counts.fetch_add(strongDelta(bias_one), memory_order_relaxed);
+            }
+        }
+
+        // Same contract as removeRef(): returns 1 when this call released
+        // the last reference and the caller must run releaseLast()
+        int biasedRemoveRef() noexcept {
+            if (bias->owner == biased_owner_slot.owner && bias->owner->queue.load(memory_order_relaxed)) {
+                // May merge this very block, so check ownership afterwards
+                bias->owner->drain();
+            }
+            if (ownedByThisThread()) {
+                if (--bias->biased > 0) {
+                    return 2;
+                }
+                return ownerMerge();
+            }
+
+            uint64_t word = counts.load(memory_order_relaxed);
+            int count;
+            int next;
+            do {
+                count = strongOf(word);
+                next = count - bias_one;
+                // First drop below zero while unmerged: the owner may hold
+                // the last references, so this thread must queue the block
+                if (!(count & bias_merged) && (next >> 2) < 0 && !(count & bias_queued)) {
+                    next |= bias_queued;
+                }
+            } while (ContentionStats::casFailed(counts.compare_exchange_weak(word, withStrong(word, next),
+                         memory_order_acq_rel, memory_order_relaxed)));
+
+            if (count & bias_merged) {
+                return finishMerge((count >> 2) - 1);
+            }
+            if ((next & bias_queued) && !(count & bias_queued)) {
+                queueForMerge();
+            }
+            return 2;
+        }
+
+        // The owner's biased count hit zero. A queued block is left to the
+        // drain, which will see the zero; otherwise merge right here.
+        // Once the merge is published other threads may free the block, so
+        // everything needed afterwards is read up front.
+        int ownerMerge() noexcept {
+            BiasedOwner* owner = bias->owner;
+            int biased = bias->biased;
+            bias->merged = true;
+            uint64_t word = counts.load(memory_order_relaxed);
+            int count;
+            do {
+                count = strongOf(word);
+                if (count & bias_queued) {
+                    bias->merged = false;
+                    return 2;
+                }
+            } while (ContentionStats::casFailed(counts.compare_exchange_weak(word,
+                         word + strongDelta((biased << 2) | bias_merged),
+                         memory_order_acq_rel, memory_order_relaxed)));
+            owner->release();
+            return finishMerge((count >> 2) + biased);
+        }
+
+        int finishMerge(int remaining) noexcept {
+            if (remaining != 0) {
+                return 2;
+            }
+            atomic_thread_fence(memory_order_acquire);
+            return 1;
+        }
+
+        // Unmerged blocks are never destroyed, so taking a reference is
+        // always safe; an object whose last owners are gone but which is
+        // still waiting for its merge can be revived this way.
+        bool biasedTryAddRef() noexcept {
+            if (ownedByThisThread()) {
+                ++bias->biased;
+                return true;
+            }
+            uint64_t word = counts.load(memory_order_relaxed);
+            for (int count = strongOf(word); !(count & bias_merged) || (count >> 2) > 0;
+                 count = strongOf(word)) {
+                if (counts.compare_exchange_weak(word, word + strongDelta(bias_one),
+                    memory_order_acq_rel, memory_order_relaxed)) {
+                    return true;
+                }
+                ContentionStats::record(ContentionEvent::CasFailure);
+            }
+            return false;
+        }
+
+        // Exact once merged and on the owner thread; elsewhere the owner's
+        // share is unknown and at least one reference is reported
+        int biasedUseCount() const noexcept {
+            int shared = strongOf(counts.load(memory_order_acquire));
+            if (shared & bias_merged) {
+                return shared >> 2;
+            }
+            if (ownedByThisThread()) {
+                return bias->biased + (shared >> 2);
+            }
+            return max(1, 1 + (shared >> 2));
+        }
+
+        void queueForMerge() noexcept {
+            BiasedOwner* owner = bias->owner;
+            ControlBlock* head = owner->queue.load(memory_order_acquire);
+            do {
+                if (head == BiasedOwner::closed()) {
+                    // The owner has exited, its biased count can no longer change
+                    mergeBias();
+                    return;
+                }
+                bias->next = head;
+            } while (ContentionStats::casFailed(owner->queue.compare_exchange_weak(head, this,
+                         memory_order_acq_rel, memory_order_acquire)));
+        }
+
+        // Folds the biased count into the shared one and destroys the object
+        // if nothing is left. Runs on the owner, or on the queuing thread once
+        // the owner is gone.
+        void mergeBias() noexcept {
+            BiasedOwner* owner = bias->owner;
+            int biased = bias->biased;
+            bias->merged = true;
+            int prev = strongOf(counts.fetch_add(strongDelta((biased << 2) | bias_merged), memory_order_acq_rel));
+            owner->release();
+            if (finishMerge((prev >> 2) + biased) == 1) {
+                releaseLast();
+            }
         }
     };
 
-    // Basic control block for raw pointer case
+    // The one-word encoding behind PointerLayout::Packed. The top 16 bits
+    // hold the object's signed offset from the block's own object, with
+    // INT16_MIN standing for a null object pointer.
+    struct PackedPointer {
+        static constexpr int offset_shift = 48;
+        static constexpr uintptr_t block_mask = (uintptr_t{1} << offset_shift) - 1;
+        static constexpr int16_t null_offset = numeric_limits<int16_t>::min();
+
+        // Whether cb and object can share one word: the block within 48 bits
+        // and the object null or within 32 KiB of the block's own object
+        static bool fits(const ControlBlock* cb, const void* object) noexcept {
+            auto block = reinterpret_cast<uintptr_t>(cb);
+            if ((block & ~block_mask) != 0) {
+                return false;
+            }
+            if (!object || !cb) {
+                return true;
+            }
+            intptr_t distance = reinterpret_cast<intptr_t>(object) -
+                                reinterpret_cast<intptr_t>(cb->objectAddress());
+            return distance > null_offset && distance <= numeric_limits<int16_t>::max();
+        }
+
+        // Pairs arriving from outside a packed pointer are checked with
+        // fits() first; one that still does not fit stops the program, in
+        // every build mode, rather than being stored as a wrong pointer
+        static uintptr_t pack(const ControlBlock* cb, const void* object) noexcept {
+            if (!cb) {
+                return 0;
+            }
+            if (!fits(cb, object)) [[unlikely]] {
+                assert(!"pointer pair does not fit PointerLayout::Packed");
+                terminate();
+            }
+            int16_t offset = null_offset;
+            if (object) {
+                offset = static_cast<int16_t>(reinterpret_cast<intptr_t>(object) -
+                                              reinterpret_cast<intptr_t>(cb->objectAddress()));
+            }
+            return reinterpret_cast<uintptr_t>(cb) | (uintptr_t{static_cast<uint16_t>(offset)} << offset_shift);
+        }
+
+        static ControlBlock* block(uintptr_t word) noexcept {
+            return reinterpret_cast<ControlBlock*>(word & block_mask);
+        }
+
+        // Reads the block, which must still be allocated
+        static void* object(uintptr_t word) noexcept {
+            auto offset = static_cast<int16_t>(word >> offset_shift);
+            ControlBlock* cb = block(word);
+            if (!cb || offset == null_offset) {
+                return nullptr;
+            }
+            return static_cast<char*>(cb->objectAddress()) + offset;
+        }
+    };
+
+    inline void BiasedOwner::drain() noexcept {
+        ControlBlock* pending = queue.exchange(nullptr, memory_order_acq_rel);
+        while (pending) {
+            ControlBlock* next = pending->bias->next;
+            pending->mergeBias();
+            pending = next;
+        }
+    }
+
+    inline BiasedOwnerSlot::~BiasedOwnerSlot() {
+        if (!owner) {
+            return;
+        }
+        ControlBlock* pending = owner->queue.exchange(BiasedOwner::closed(), memory_order_acq_rel);
+        while (pending) {
+            ControlBlock* next = pending->bias->next;
+            pending->mergeBias();
+            pending = next;
+        }
+        BiasedOwner* exiting = owner;
+        owner = nullptr;
+        exiting->release();
+    }
+
+    // Merges every block other threads have queued on the calling thread.
+    // Objects whose references all migrated to other threads are destroyed
+    // here at the latest.
+    inline void drain_biased_merges() noexcept {
+        if (BiasedOwner* owner = biased_owner_slot.owner) {
+            owner->drain();
+        }
+    }
+
+    // Basic control block for raw pointer case. The object is reached
+    // through the address the base already keeps, so the block stores no
+    // pointer of its own.
     template<typename T>
-    class BasicControlBlock : public ControlBlock {
-        T* ptr;
+    class BasicControlBlock : public ControlBlock, public PoolAllocated {
+    protected:
+        BasicControlBlock(T* p, const Ops& table) : ControlBlock(table) {
+            this->setObjectAddress(p);
+        }
+
     public:
-        explicit BasicControlBlock(T* p) : ptr(p) {}
-        
-        void destroy_object() noexcept override {
-            if (ptr) {
-                delete ptr;
-                ptr = nullptr;
-                atomic_thread_fence(memory_order_release);
-            }
+        static void destroyObject(ControlBlock* cb) noexcept {
+            delete static_cast<T*>(cb->objectAddress());
         }
-        
-        void destroy_this() noexcept override {
-            delete this;
+
+        static void destroyThis(ControlBlock* cb) noexcept {
+            delete static_cast<BasicControlBlock*>(cb);
+        }
+
+        static constexpr Ops ops{&destroyObject, &destroyThis};
+
+        explicit BasicControlBlock(T* p) : BasicControlBlock(p, ops) {}
+    };
+
+    // Raw pointer control block using biased reference counting
+    template<typename T>
+    class BiasedControlBlock : public BasicControlBlock<T> {
+        BiasedCounts counts;
+    public:
+        static void destroyThis(ControlBlock* cb) noexcept {
+            delete static_cast<BiasedControlBlock*>(cb);
+        }
+
+        static constexpr ControlBlock::Ops ops{&BasicControlBlock<T>::destroyObject, &destroyThis};
+
+        explicit BiasedControlBlock(T* p) : BasicControlBlock<T>(p, ops) {
+            this->enableBiasing(counts);
         }
     };
 
+    // Object and counts in one allocation made through Allocator, rebound
+    // to the block type. The object is constructed through the allocator
+    // too, so a pmr::polymorphic_allocator hands its resource on to
+    // allocator-aware members of T.
     template<typename T, typename Allocator>
     class ControlBlockMakeShared : public ControlBlock {
+        using CBAllocType = typename std::allocator_traits<Allocator>::
+            template rebind_alloc<ControlBlockMakeShared>;
+        using ObjectAllocType = typename std::allocator_traits<Allocator>::
+            template rebind_alloc<T>;
+
         alignas(T) unsigned char storage[sizeof(T)];
-        T* ptr_;
         [[no_unique_address]] Allocator alloc;
-    
-    public:
+
         template<typename... Args>
         explicit ControlBlockMakeShared(const Allocator& a, Args&&... args)
-            : alloc(a) {
-            ptr_ = new (storage) T(std::forward<Args>(args)...);
+            : ControlBlock(ops), alloc(a) {
+            ObjectAllocType object_alloc(alloc);
+            std::allocator_traits<ObjectAllocType>::construct(object_alloc,
+                reinterpret_cast<T*>(storage), std::forward<Args>(args)...);
+            setObjectAddress(storage);
         }
 
-        T* get_ptr() noexcept { return ptr_; }
+        // Blocks for the default allocator come from ControlBlockPool, as
+        // long as the pool's alignment suffices
+        static constexpr bool fromPool() noexcept {
+            return is_same_v<Allocator, allocator<T>> &&
+                alignof(ControlBlockMakeShared) <= ControlBlockPool::granularity;
+        }
+
+    public:
+        static void destroyObject(ControlBlock* cb) noexcept {
+            auto* self = static_cast<ControlBlockMakeShared*>(cb);
+            ObjectAllocType object_alloc(self->alloc);
+            std::allocator_traits<ObjectAllocType>::destroy(object_alloc, self->get_ptr());
+        }
 
-        void destroy_object() noexcept override {
-            if (ptr_) {
-                ptr_->~T();
-                ptr_ = nullptr;
+        static void destroyThis(ControlBlock* cb) noexcept {
+            auto* self = static_cast<ControlBlockMakeShared*>(cb);
+            if constexpr (fromPool()) {
+                self->~ControlBlockMakeShared();
+                ControlBlockPool::deallocate(self, sizeof(ControlBlockMakeShared));
+            } else {
+                CBAllocType cb_alloc(self->alloc);
+                self->~ControlBlockMakeShared();
+                cb_alloc.deallocate(self, 1);
             }
         }
 
-        void destroy_this() noexcept override {
-            using CBAllocType = typename std::allocator_traits<Allocator>::
-                template rebind_alloc<ControlBlockMakeShared>;
-            CBAllocType cb_alloc(alloc);
-            this->~ControlBlockMakeShared();
-            cb_alloc.deallocate(this, 1);
+        static constexpr Ops ops{&destroyObject, &destroyThis};
+
+        // If T's constructor throws, the storage is returned and the
+        // exception propagates
+        template<typename... Args>
+        static ControlBlockMakeShared* create(const Allocator& a, Args&&... args) {
+            if constexpr (fromPool()) {
+                void* memory = ControlBlockPool::allocate(sizeof(ControlBlockMakeShared));
+                try {
+                    return ::new (memory) ControlBlockMakeShared(a, std::forward<Args>(args)...);
+                } catch (...) {
+                    ControlBlockPool::deallocate(memory, sizeof(ControlBlockMakeShared));
+                    throw;
+                }
+            } else {
+                CBAllocType cb_alloc(a);
+                auto* cb = std::allocator_traits<CBAllocType>::allocate(cb_alloc, 1);
+                try {
+                    return ::new (static_cast<void*>(cb)) ControlBlockMakeShared(a, std::forward<Args>(args)...);
+                } catch (...) {
+                    std::allocator_traits<CBAllocType>::deallocate(cb_alloc, cb, 1);
+                    throw;
+                }
+            }
         }
+
+        T* get_ptr() noexcept { return std::launder(reinterpret_cast<T*>(storage)); }
     };
 
     template<typename T, typename Deleter, typename Allocator>
-    class ControlBlockWithDeleter : public ControlBlock {
-        T* ptr;
+    class ControlBlockWithDeleter : public ControlBlock, public PoolAllocated {
         [[no_unique_address]] Deleter deleter;
         [[no_unique_address]] Allocator alloc;
         
     public:
-        ControlBlockWithDeleter(T* p, Deleter d, const Allocator& a) 
-            : ptr(p), deleter(std::move(d)), alloc(a) {}
+        static void destroyObject(ControlBlock* cb) noexcept {
+            static_cast<ControlBlockWithDeleter*>(cb)->deleter(static_cast<T*>(cb->objectAddress()));
+        }
 
-        void destroy_object() noexcept override {
-            if (ptr) {
-                deleter(ptr);
-                ptr = nullptr;
+        static void destroyThis(ControlBlock* cb) noexcept {
+            auto* self = static_cast<ControlBlockWithDeleter*>(cb);
+            if constexpr (is_same_v<Allocator, allocator<T>>) {
+                delete self;
+            } else {
+                using CBAllocType = typename std::allocator_traits<Allocator>::
+                    template rebind_alloc<ControlBlockWithDeleter>;
+                CBAllocType cb_alloc(self->alloc);
+                self->~ControlBlockWithDeleter();
+                cb_alloc.deallocate(self, 1);
             }
         }
 
-        void destroy_this() noexcept override {
-            using CBAllocType = typename std::allocator_traits<Allocator>::
-                template rebind_alloc<ControlBlockWithDeleter>;
-            CBAllocType cb_alloc(alloc);
-            this->~ControlBlockWithDeleter();
-            cb_alloc.deallocate(this, 1);
+        static constexpr Ops ops{&destroyObject, &destroyThis};
+
+        ControlBlockWithDeleter(T* p, Deleter d, const Allocator& a) 
+            : ControlBlock(ops), deleter(std::move(d)), alloc(a) {
+            setObjectAddress(p);
+        }
+
+        // Blocks for the default allocator come from ControlBlockPool
+        static ControlBlockWithDeleter* create(T* p, Deleter d, const Allocator& a) {
+            if constexpr (is_same_v<Allocator, allocator<T>>) {
+                return new ControlBlockWithDeleter(p, std::move(d), a);
+            } else {
+                using CBAllocType = typename std::allocator_traits<Allocator>::
+                    template rebind_alloc<ControlBlockWithDeleter>;
+                CBAllocType cb_alloc(a);
+                auto* cb = cb_alloc.allocate(1);
+                return new (cb) ControlBlockWithDeleter(p, std::move(d), a);
+            }
         }
     };
 
-    // Add array support
-    template<typename T>
+    // Array block fused with its elements: one allocation holds the header
+    // and then the elements, starting at an Align boundary so that callers
+    // can ask for e.g. 64 for aligned vector loads
+    template<typename T, size_t Align = alignof(T)>
     class ControlBlockArray : public ControlBlock {
-        T* ptr;
+        static_assert(Align >= alignof(T) && (Align & (Align - 1)) == 0,
+            "Align must be a power of two no smaller than alignof(T)");
+
         size_t size;
-        
-    public:
-        explicit ControlBlockArray(size_t n) : size(n) {
-            ptr = static_cast<T*>(::operator new[](size * sizeof(T)));
+        // Start of the allocation, ahead of the block when it was aligned
+        void* allocation;
+        // Where the allocation came from; null for operator new
+        pmr::memory_resource* resource;
+
+        ControlBlockArray(size_t n, void* memory, pmr::memory_resource* mr)
+            : ControlBlock(ops), size(n), allocation(memory), resource(mr) {}
+
+        // The block sits elementsOffset() below the elements, so both
+        // are aligned to the stricter of the two
+        static constexpr size_t alignment() noexcept {
+            return std::max(Align, alignof(ControlBlockArray));
         }
-        
-        void destroy_object() noexcept override {
-            if (ptr) {
-                for (size_t i = 0; i < size; ++i) {
-                    ptr[i].~T();
+
+        static constexpr size_t elementsOffset() noexcept {
+            return (sizeof(ControlBlockArray) + alignment() - 1) & ~(alignment() - 1);
+        }
+
+        // Over-aligned requests are padded and aligned by hand: plain
+        // operator new is much faster than its aligned form for small sizes
+        static constexpr size_t alignmentSlack() noexcept {
+            return alignment() > __STDCPP_DEFAULT_NEW_ALIGNMENT__
+                ? alignment() - __STDCPP_DEFAULT_NEW_ALIGNMENT__ : 0;
+        }
+
+        static void destroyElements(T* elements, size_t n) noexcept {
+            if constexpr (!is_trivially_destructible_v<T>) {
+                while (n > 0) {
+                    elements[--n].~T();
                 }
-                ::operator delete[](ptr);
-                ptr = nullptr;
             }
         }
-        
-        void destroy_this() noexcept override {
-            delete this;
+
+    public:
+        static void destroyObject(ControlBlock* cb) noexcept {
+            auto* self = static_cast<ControlBlockArray*>(cb);
+            destroyElements(self->get(), self->size);
         }
-        
-        T* get() noexcept { return ptr; }
+
+        static void destroyThis(ControlBlock* cb) noexcept {
+            auto* self = static_cast<ControlBlockArray*>(cb);
+            void* memory = self->allocation;
+            pmr::memory_resource* mr = self->resource;
+            size_t bytes = elementsOffset() + self->size * sizeof(T);
+            self->~ControlBlockArray();
+            if (mr) {
+                mr->deallocate(memory, bytes, alignment());
+            } else {
+                ::operator delete(memory);
+            }
+        }
+
+        static constexpr Ops ops{&destroyObject, &destroyThis};
+
+        // Elements are value-initialized, or default-initialized (left
+        // indeterminate for trivial T) when ValueInit is false. A resource,
+        // if given, supplies aligned memory itself.
+        template<bool ValueInit>
+        static ControlBlockArray* create(size_t n, pmr::memory_resource* mr = nullptr) {
+            constexpr size_t overhead = elementsOffset() + alignmentSlack();
+            if (n > (numeric_limits<size_t>::max() - overhead) / sizeof(T)) {
+                throw bad_array_new_length();
+            }
+            void* memory;
+            T* elements;
+            if (mr) {
+                memory = mr->allocate(elementsOffset() + n * sizeof(T), alignment());
+                elements = reinterpret_cast<T*>(static_cast<unsigned char*>(memory) + elementsOffset());
+            } else {
+                memory = ::operator new(overhead + n * sizeof(T));
+                auto start = reinterpret_cast<uintptr_t>(memory) + elementsOffset();
+                elements = reinterpret_cast<T*>((start + alignment() - 1) & ~uintptr_t{alignment() - 1});
+            }
+            auto* self = ::new (reinterpret_cast<unsigned char*>(elements) - elementsOffset())
+                ControlBlockArray(n, memory, mr);
+            try {
+                // Both roll back what they built if a constructor throws,
+                // and reduce to a fill or nothing for trivial T
+                if constexpr (ValueInit) {
+                    uninitialized_value_construct_n(elements, n);
+                } else {
+                    uninitialized_default_construct_n(elements, n);
+                }
+            } catch (...) {
+                destroyThis(self);
+                throw;
+            }
+            self->setObjectAddress(elements);
+            return self;
+        }
+
+        T* get() noexcept { return static_cast<T*>(objectAddress()); }
     };
 
-    template <typename T>
+    template <typename T, PointerLayout Layout = default_pointer_layout>
     class LockFreeSharedWithWeakPtr
     {
+        static_assert(Layout != PointerLayout::Packed || sizeof(void*) == 8,
+            "PointerLayout::Packed needs 64-bit pointers");
+
         // Allow LockFreeWeakPtr to access our internals
-        friend class LockFreeWeakPtr<T>;
-        template<typename U> friend class LockFreeSharedWithWeakPtr;
+        template<typename U, PointerLayout> friend class LockFreeWeakPtr;
+        friend class AtomicLockFreeSharedPtr<T>;
+        template<typename U, typename... Args>
+        friend LockFreeSharedWithWeakPtr<U> make_biased_shared(Args&&... args);
+        template<typename U, typename Allocator, typename... Args>
+        friend LockFreeSharedWithWeakPtr<U> allocate_shared_custom(const Allocator& alloc, Args&&... args);
+        template<typename U, size_t Align>
+        friend LockFreeSharedWithWeakPtr<U> make_shared_array(size_t size);
+        template<typename U, size_t Align>
+        friend LockFreeSharedWithWeakPtr<U> make_shared_array_for_overwrite(size_t size);
+        template<typename U, size_t Align>
+        friend LockFreeSharedWithWeakPtr<U> allocate_shared_array_pmr(pmr::memory_resource* mr, size_t size);
+        template<typename U, size_t Align>
+        friend LockFreeSharedWithWeakPtr<U> allocate_shared_array_for_overwrite_pmr(pmr::memory_resource* mr, size_t size);
+        template<typename U, PointerLayout> friend class LockFreeSharedWithWeakPtr;
+        template<typename U> friend class SharedRef;
 
     private:
         struct alignas(16) PointerPair
@@ -210,17 +893,73 @@ export namespace ThreadSafeWorld {
             atomic<bool> in_progress{false};
         };
 
-        union
+        union PairStorage
         {
             atomic<PointerPair> ptrs;
             AtomicPointers fallback;
+
+            PairStorage() noexcept {}
+        };
+
+        struct PackedStorage
+        {
+            atomic<uintptr_t> packed;
         };
 
+        static constexpr bool is_packed()
+        {
+            return Layout == PointerLayout::Packed;
+        }
+
+        conditional_t<is_packed(), PackedStorage, PairStorage> storage;
+
         static constexpr bool has_native_dwcas()
         {
             return atomic<PointerPair>::is_always_lock_free;
         }
 
+        static uintptr_t pack(const PointerPair &pair) noexcept
+        {
+            return PackedPointer::pack(pair.cb, pair.ptr);
+        }
+
+        static PointerPair unpack(uintptr_t word) noexcept
+        {
+            return PointerPair{PackedPointer::block(word), static_cast<T *>(PackedPointer::object(word))};
+        }
+
+        // Throws invalid_argument if this layout cannot hold ptr next to cb,
+        // which only happens for Packed and an aliased ptr more than 32 KiB
+        // from cb's object. Run before taking the reference to be stored.
+        static void check_fits(const ControlBlock *cb, const T *ptr)
+        {
+            if constexpr (is_packed())
+            {
+                if (!PackedPointer::fits(cb, ptr))
+                {
+                    throw invalid_argument("aliased pointer too far from the owned object for PointerLayout::Packed");
+                }
+            }
+        }
+
+        // Starts the lifetime of whichever union member this target uses;
+        // every constructor must call this before touching the pointers.
+        void init_ptrs() noexcept
+        {
+            if constexpr (is_packed())
+            {
+                new (&storage.packed) atomic<uintptr_t>(0);
+            }
+            else if constexpr (has_native_dwcas())
+            {
+                new (&storage.ptrs) atomic<PointerPair>(PointerPair{nullptr, nullptr});
+            }
+            else
+            {
+                new (&storage.fallback) AtomicPointers{};
+            }
+        }
+
         bool try_update_pointers(ControlBlock *new_cb, T *new_ptr)
         {
             if constexpr (!has_native_dwcas())
@@ -228,16 +967,17 @@ export namespace ThreadSafeWorld {
                 while (true)
                 {
                     bool expected = false;
-                    if (!fallback.in_progress.compare_exchange_strong(
+                    if (!storage.fallback.in_progress.compare_exchange_strong(
                             expected, true, memory_order_acquire))
                     {
+                        ContentionStats::record(ContentionEvent::SpinIteration);
                         continue;
                     }
 
-                    fallback.cb.store(new_cb, memory_order_relaxed);
-                    fallback.ptr.store(new_ptr, memory_order_relaxed);
+                    storage.fallback.cb.store(new_cb, memory_order_relaxed);
+                    storage.fallback.ptr.store(new_ptr, memory_order_relaxed);
 
-                    fallback.in_progress.store(false, memory_order_release);
+                    storage.fallback.in_progress.store(false, memory_order_release);
                     return true;
                 }
             }
@@ -246,21 +986,34 @@ export namespace ThreadSafeWorld {
 
         bool compare_exchange_ptrs(PointerPair &expected, const PointerPair &desired) noexcept
         {
-            if constexpr (has_native_dwcas())
+            if constexpr (is_packed())
             {
-                return atomic_compare_exchange_strong_explicit(
-                    &ptrs, &expected, desired,
-                    memory_order_acq_rel, memory_order_acquire);
+                uintptr_t word = pack(expected);
+                if (storage.packed.compare_exchange_strong(word, pack(desired),
+                        memory_order_acq_rel, memory_order_acquire))
+                {
+                    return true;
+                }
+                ContentionStats::record(ContentionEvent::CasFailure);
+                expected = unpack(word);
+                return false;
+            }
+            else if constexpr (has_native_dwcas())
+            {
+                return !ContentionStats::casFailed(atomic_compare_exchange_strong_explicit(
+                    &storage.ptrs, &expected, desired,
+                    memory_order_acq_rel, memory_order_acquire));
             }
             else
             {
                 while (true)
                 {
-                    auto current_cb = fallback.cb.load(memory_order_acquire);
-                    auto current_ptr = fallback.ptr.load(memory_order_acquire);
+                    auto current_cb = storage.fallback.cb.load(memory_order_acquire);
+                    auto current_ptr = storage.fallback.ptr.load(memory_order_acquire);
 
                     if (current_cb != expected.cb || current_ptr != expected.ptr)
                     {
+                        ContentionStats::record(ContentionEvent::CasFailure);
                         expected.cb = current_cb;
                         expected.ptr = current_ptr;
                         return false;
@@ -276,26 +1029,35 @@ export namespace ThreadSafeWorld {
 
         PointerPair load_ptrs(memory_order order) const noexcept
         {
-            if constexpr (has_native_dwcas())
+            if constexpr (is_packed())
+            {
+                return unpack(storage.packed.load(order));
+            }
+            else if constexpr (has_native_dwcas())
             {
-                return ptrs.load(order);
+                return storage.ptrs.load(order);
             }
             else
             {
-                while (fallback.in_progress.load(memory_order_acquire))
+                while (storage.fallback.in_progress.load(memory_order_acquire))
                 {
+                    ContentionStats::record(ContentionEvent::SpinIteration);
                 }
                 return PointerPair{
-                    fallback.cb.load(order),
-                    fallback.ptr.load(order)};
+                    storage.fallback.cb.load(order),
+                    storage.fallback.ptr.load(order)};
             }
         }
 
         void store_ptrs(const PointerPair &new_ptrs, memory_order order) noexcept
         {
-            if constexpr (has_native_dwcas())
+            if constexpr (is_packed())
             {
-                ptrs.store(new_ptrs, order);
+                storage.packed.store(pack(new_ptrs), order);
+            }
+            else if constexpr (has_native_dwcas())
+            {
+                storage.ptrs.store(new_ptrs, order);
             }
             else
             {
@@ -303,28 +1065,34 @@ export namespace ThreadSafeWorld {
             }
         }
 
+        // Tag for taking over a strong reference the caller already holds
+        struct adopt_ref_t {};
+
+        LockFreeSharedWithWeakPtr(ControlBlock *cb, T *p, adopt_ref_t) noexcept
+        {
+            init_ptrs();
+            store_ptrs(PointerPair{cb, p}, memory_order_release);
+        }
+
     public:
         using element_type = T;
-        using weak_type = LockFreeWeakPtr<T>;
+        using weak_type = LockFreeWeakPtr<T, Layout>;
+
+        static constexpr PointerLayout layout = Layout;
 
         LockFreeSharedWithWeakPtr() noexcept
         {
-            if constexpr (has_native_dwcas())
-            {
-                ptrs = PointerPair{nullptr, nullptr};
-            }
+            init_ptrs();
         }
 
         constexpr LockFreeSharedWithWeakPtr(std::nullptr_t) noexcept
         {
-            if constexpr (has_native_dwcas())
-            {
-                ptrs = PointerPair{nullptr, nullptr};
-            }
+            init_ptrs();
         }
 
         explicit LockFreeSharedWithWeakPtr(T *p) noexcept
         {
+            init_ptrs();
             if (p) {
                 auto cb = new BasicControlBlock<T>(p);
                 store_ptrs(PointerPair{cb, p}, memory_order_release);
@@ -332,24 +1100,40 @@ export namespace ThreadSafeWorld {
         }
 
         template<typename Deleter = default_delete<T>, typename Allocator = allocator<T>>
+            requires (!is_convertible_v<Allocator, pmr::memory_resource*>)
         LockFreeSharedWithWeakPtr(T* ptr, Deleter d = Deleter(), 
                                  const Allocator& alloc = Allocator()) {
+            init_ptrs();
             if (ptr) {
-                using CBAllocType = typename allocator_traits<Allocator>::
-                    template rebind_alloc<ControlBlockWithDeleter<T, Deleter, Allocator>>;
-                CBAllocType cb_alloc(alloc);
-                auto* cb = cb_alloc.allocate(1);
-                new (cb) ControlBlockWithDeleter<T, Deleter, Allocator>(ptr, std::move(d), alloc);
+                ControlBlock* cb;
+                // Shares the plain block, and its direct release path
+                if constexpr (is_same_v<Deleter, default_delete<T>> && is_same_v<Allocator, allocator<T>>) {
+                    cb = new BasicControlBlock<T>(ptr);
+                } else {
+                    cb = ControlBlockWithDeleter<T, Deleter, Allocator>::create(ptr, std::move(d), alloc);
+                }
                 store_ptrs(PointerPair{cb, ptr}, memory_order_release);
             }
         }
 
-        // Add aliasing constructor support with proper reference handling
-        template<typename U>
-        LockFreeSharedWithWeakPtr(const LockFreeSharedWithWeakPtr<U>& other, element_type* ptr) noexcept {
+        // Places the control block in mr; the object stays wherever ptr
+        // came from, and d still frees it
+        template<typename Deleter>
+        LockFreeSharedWithWeakPtr(T* ptr, Deleter d, pmr::memory_resource* mr)
+            : LockFreeSharedWithWeakPtr(ptr, std::move(d), pmr::polymorphic_allocator<T>(mr)) {}
+
+        // Aliasing constructor: shares other's ownership, and so takes a
+        // reference of its own, while pointing at ptr. The packed layout
+        // throws invalid_argument if ptr is too far from other's object.
+        template<typename U, PointerLayout OtherLayout>
+        LockFreeSharedWithWeakPtr(const LockFreeSharedWithWeakPtr<U, OtherLayout>& other, element_type* ptr)
+            noexcept(Layout == PointerLayout::Pair) {
+            init_ptrs();
             PointerPair new_ptrs{nullptr, nullptr};
             auto other_ptrs = other.load_ptrs(memory_order_acquire);
             if (other_ptrs.cb) {
+                check_fits(other_ptrs.cb, ptr);
+                other_ptrs.cb->addRef();
                 new_ptrs.cb = other_ptrs.cb;
                 new_ptrs.ptr = ptr;
                 store_ptrs(new_ptrs, memory_order_release);
@@ -362,6 +1146,7 @@ export namespace ThreadSafeWorld {
 
         LockFreeSharedWithWeakPtr(const LockFreeSharedWithWeakPtr &other) noexcept
         {
+            init_ptrs();
             auto other_ptrs = other.load_ptrs(memory_order_acquire);
             if (other_ptrs.cb)
             {
@@ -440,10 +1225,57 @@ export namespace ThreadSafeWorld {
             return current.cb ? current.cb->weak_count_val() : 0;
         }
 
+        // Chooses how the object is destroyed once the last strong reference
+        // is gone. Call it before the pointer is shared with other threads.
+        void set_reclamation(Reclamation mode) noexcept
+        {
+            auto current = load_ptrs(memory_order_acquire);
+            if (current.cb)
+            {
+                current.cb->setReclamation(mode);
+            }
+        }
+
+        // Reads the object without taking a reference: hp keeps it alive
+        // until hp is reset or reused, even if this pointer is reassigned
+        // meanwhile. Only objects using Reclamation::Hazard are covered.
+        T *protect(HazardPointer &hp) const noexcept
+        {
+            if constexpr (is_packed())
+            {
+                // Finding the object reads the block, so the block is
+                // published and the word confirmed before it is unpacked
+                uintptr_t word = storage.packed.load(memory_order_acquire);
+                while (true)
+                {
+                    hp.set(PackedPointer::block(word));
+                    uintptr_t again = storage.packed.load(memory_order_seq_cst);
+                    if (again == word)
+                    {
+                        return static_cast<T *>(PackedPointer::object(word));
+                    }
+                    word = again;
+                }
+            }
+            auto current = load_ptrs(memory_order_acquire);
+            while (true)
+            {
+                hp.set(current.cb);
+                auto again = load_ptrs(memory_order_seq_cst);
+                if (again == current)
+                {
+                    return current.ptr;
+                }
+                current = again;
+            }
+        }
+
     private:
         PointerPair exchange_ptrs(const PointerPair& new_ptrs) noexcept {
-            if constexpr (has_native_dwcas()) {
-                return ptrs.exchange(new_ptrs, memory_order_acq_rel);
+            if constexpr (is_packed()) {
+                return unpack(storage.packed.exchange(pack(new_ptrs), memory_order_acq_rel));
+            } else if constexpr (has_native_dwcas()) {
+                return storage.ptrs.exchange(new_ptrs, memory_order_acq_rel);
             } else {
                 PointerPair expected;
                 do {
@@ -457,89 +1289,96 @@ export namespace ThreadSafeWorld {
         {
             if (old_ptrs.cb && old_ptrs.cb->removeRef() == 1) {
                 atomic_thread_fence(memory_order_acquire);
-                old_ptrs.cb->destroy_object();
-
-                if (old_ptrs.cb->weak_count_val() == 0) {
-                    old_ptrs.cb->destroy_this();
-                }
+                old_ptrs.cb->template releaseLast<BasicControlBlock<T>>();
             }
         }
     };
 
+    // Creates the object inside its control block, both allocated through
+    // alloc, like std::allocate_shared
+    template<typename T, typename Allocator, typename... Args>
+    LockFreeSharedWithWeakPtr<T> allocate_shared_custom(const Allocator& alloc, Args&&... args) {
+        auto* cb = ControlBlockMakeShared<T, Allocator>::create(alloc, std::forward<Args>(args)...);
+        return LockFreeSharedWithWeakPtr<T>(cb, cb->get_ptr(),
+            typename LockFreeSharedWithWeakPtr<T>::adopt_ref_t{});
+    }
+
+    // Same with the block taken from mr, e.g. a per-request monotonic arena
+    template<typename T, typename... Args>
+    LockFreeSharedWithWeakPtr<T> allocate_shared_pmr(pmr::memory_resource* mr, Args&&... args) {
+        return allocate_shared_custom<T>(pmr::polymorphic_allocator<T>(mr), std::forward<Args>(args)...);
+    }
+
     // make_shared implementation
     template<typename T, typename... Args>
     LockFreeSharedWithWeakPtr<T> make_shared_custom(Args&&... args) {
-        using AllocType = std::allocator<T>;
-        AllocType alloc;
-        using CB = ControlBlockMakeShared<T, AllocType>;
-        using CBAlloc = typename std::allocator_traits<AllocType>::template rebind_alloc<CB>;
-        
-        CBAlloc cb_alloc(alloc);
-        CB* cb = cb_alloc.allocate(1);
-        
+        return allocate_shared_custom<T>(std::allocator<T>(), std::forward<Args>(args)...);
+    }
+
+    // Creates an object whose references are biased towards the calling
+    // thread: copies and drops there cost no atomic RMW, while other threads
+    // still share it safely (see BiasedOwner).
+    template<typename T, typename... Args>
+    LockFreeSharedWithWeakPtr<T> make_biased_shared(Args&&... args) {
+        T* object = new T(std::forward<Args>(args)...);
         try {
-            new (cb) CB(alloc, std::forward<Args>(args)...);
-            return LockFreeSharedWithWeakPtr<T>(cb->get_ptr(), 
-                [cb](T*) { cb->destroy_this(); }, alloc);
+            auto* cb = new BiasedControlBlock<T>(object);
+            return LockFreeSharedWithWeakPtr<T>(cb, object,
+                typename LockFreeSharedWithWeakPtr<T>::adopt_ref_t{});
         } catch (...) {
-            cb_alloc.deallocate(cb, 1);
+            delete object;
             throw;
         }
     }
 
-    // Utility functions for array support
-    template<typename T>
+    // Array of size value-initialized elements in a single allocation with
+    // its control block; Align raises the alignment of the first element
+    template<typename T, size_t Align = alignof(T)>
     LockFreeSharedWithWeakPtr<T> make_shared_array(size_t size) {
-        auto cb = new ControlBlockArray<T>(size);
-        auto ptr = cb->get();
-        try {
-            for (size_t i = 0; i < size; ++i) {
-                new (ptr + i) T();
-            }
-            return LockFreeSharedWithWeakPtr<T>(ptr, [cb](T*) { 
-                cb->destroy_object();
-                cb->destroy_this(); 
-            });
-        } catch (...) {
-            delete cb;
-            throw;
-        }
+        auto* cb = ControlBlockArray<T, Align>::template create<true>(size);
+        return LockFreeSharedWithWeakPtr<T>(cb, cb->get(),
+            typename LockFreeSharedWithWeakPtr<T>::adopt_ref_t{});
+    }
+
+    // Same, but the elements are left uninitialized for the caller to fill,
+    // which saves a pass over large numeric buffers
+    template<typename T, size_t Align = alignof(T)>
+    LockFreeSharedWithWeakPtr<T> make_shared_array_for_overwrite(size_t size) {
+        static_assert(is_trivially_default_constructible_v<T>,
+            "make_shared_array_for_overwrite needs a trivially default-constructible T");
+        auto* cb = ControlBlockArray<T, Align>::template create<false>(size);
+        return LockFreeSharedWithWeakPtr<T>(cb, cb->get(),
+            typename LockFreeSharedWithWeakPtr<T>::adopt_ref_t{});
     }
 
-    // Enhanced make_shared with strong exception guarantee
+    // The two array factories with block and elements taken from mr
+    template<typename T, size_t Align = alignof(T)>
+    LockFreeSharedWithWeakPtr<T> allocate_shared_array_pmr(pmr::memory_resource* mr, size_t size) {
+        auto* cb = ControlBlockArray<T, Align>::template create<true>(size, mr);
+        return LockFreeSharedWithWeakPtr<T>(cb, cb->get(),
+            typename LockFreeSharedWithWeakPtr<T>::adopt_ref_t{});
+    }
+
+    template<typename T, size_t Align = alignof(T)>
+    LockFreeSharedWithWeakPtr<T> allocate_shared_array_for_overwrite_pmr(pmr::memory_resource* mr, size_t size) {
+        static_assert(is_trivially_default_constructible_v<T>,
+            "allocate_shared_array_for_overwrite_pmr needs a trivially default-constructible T");
+        auto* cb = ControlBlockArray<T, Align>::template create<false>(size, mr);
+        return LockFreeSharedWithWeakPtr<T>(cb, cb->get(),
+            typename LockFreeSharedWithWeakPtr<T>::adopt_ref_t{});
+    }
+
+    // Kept for source compatibility: make_shared_custom gives the same
+    // strong exception guarantee
     template<typename T, typename... Args>
     LockFreeSharedWithWeakPtr<T> make_shared_safe(Args&&... args) {
-        using AllocType = std::allocator<T>;
-        AllocType alloc;
-        using MakeSharedCB = ControlBlockMakeShared<T, AllocType>;
-        using MakeSharedCBAlloc = typename std::allocator_traits<AllocType>::
-            template rebind_alloc<MakeSharedCB>;
-
-        struct Guard {
-            MakeSharedCB* cb;
-            MakeSharedCBAlloc& alloc;
-            bool committed = false;
-            
-            Guard(MakeSharedCB* p, MakeSharedCBAlloc& a) : cb(p), alloc(a) {}
-            ~Guard() {
-                if (!committed && cb) {
-                    alloc.deallocate(cb, 1);
-                }
-            }
-        };
-
-        MakeSharedCBAlloc cb_alloc(alloc);
-        auto* cb = cb_alloc.allocate(1);
-        
-        Guard guard(cb, cb_alloc);
-        new (cb) MakeSharedCB(alloc, std::forward<Args>(args)...);
-        auto ptr = LockFreeSharedWithWeakPtr<T>(cb->get_ptr(), 
-            [cb](T*) { cb->destroy_this(); }, alloc);
-        guard.committed = true;
-        return ptr;
+        return make_shared_custom<T>(std::forward<Args>(args)...);
     }
 
-    // Atomic operations optimization
+    // Convenience wrappers kept for source compatibility. They are only as
+    // thread-safe as the copy/assignment they forward to: concurrent reads and
+    // writes of the same pointer object can race on the control block. Use
+    // AtomicLockFreeSharedPtr for a slot that is shared between threads.
     template<typename T>
     void atomic_store(LockFreeSharedWithWeakPtr<T>& ptr, 
                      LockFreeSharedWithWeakPtr<T> desired) noexcept {
@@ -560,77 +1399,264 @@ export namespace ThreadSafeWorld {
         return old;
     }
 
+    // Lock-free atomic slot holding a LockFreeSharedWithWeakPtr<T>, the
+    // counterpart of std::atomic<std::shared_ptr<T>>.
+    //
+    // Uses split reference counting. The slot is one 64-bit word packing a
+    // pointer to an immutable Node (low 48 bits) with an external count of
+    // in-flight readers (high 16 bits). A reader pins the node with a single
+    // fetch_add on that word, copies the strong pointer out of it and then
+    // hands its pin back. A writer swaps the node out and folds the external
+    // count into the node's internal count; whoever brings the sum to zero
+    // frees the node. So load() never dereferences a node or control block
+    // that may already be gone, and nobody ever takes a lock.
+    template<typename T>
+    class AtomicLockFreeSharedPtr {
+        static_assert(sizeof(void*) == 8,
+            "AtomicLockFreeSharedPtr packs its count into the top 16 bits of a 64-bit pointer");
+
+        struct Node {
+            // Pins moved over from the slot minus pins given back afterwards
+            atomic<int> internal_count{0};
+            // Owns the strong reference published through the slot
+            LockFreeSharedWithWeakPtr<T> value;
+
+            explicit Node(const LockFreeSharedWithWeakPtr<T>& v) : value(v) {}
+        };
+
+        static constexpr int count_shift = 48;
+        static constexpr uint64_t one_external = uint64_t{1} << count_shift;
+        static constexpr uint64_t pointer_mask = one_external - 1;
+
+        mutable atomic<uint64_t> word{0};
+
+        static Node* node_of(uint64_t w) noexcept {
+            return reinterpret_cast<Node*>(static_cast<uintptr_t>(w & pointer_mask));
+        }
+
+        static int external_of(uint64_t w) noexcept {
+            return static_cast<int>(w >> count_shift);
+        }
+
+        // Empty pointers are stored as a null word so they cost no allocation
+        static uint64_t make_word(const LockFreeSharedWithWeakPtr<T>& desired) {
+            if (!desired.load_ptrs(memory_order_acquire).cb) {
+                return 0;
+            }
+            auto address = reinterpret_cast<uintptr_t>(new Node(desired));
+            assert((address & ~pointer_mask) == 0 && "node address does not fit in 48 bits");
+            return address;
+        }
+
+        static void free_word(uint64_t w) noexcept {
+            delete node_of(w);
+        }
+
+        // Takes a pin on whatever node is currently published
+        uint64_t pin() const noexcept {
+            return word.fetch_add(one_external, memory_order_acquire) + one_external;
+        }
+
+        // Gives back a pin taken by pin(). While the node is still published
+        // the pin comes off the external count; once a writer has replaced
+        // it, the pin was moved onto the internal count and comes off there.
+        // Pins on an empty slot protect nothing, so any of them may be given
+        // back, and none are once the slot has been overwritten.
+        void unpin(Node* node) const noexcept {
+            uint64_t current = word.load(memory_order_relaxed);
+            while (node_of(current) == node && (node || external_of(current) > 0)) {
+                if (word.compare_exchange_weak(current, current - one_external,
+                        memory_order_release, memory_order_relaxed)) {
+                    return;
+                }
+                ContentionStats::record(ContentionEvent::CasFailure);
+            }
+            if (node && node->internal_count.fetch_sub(1, memory_order_acq_rel) == 1) {
+                delete node;
+            }
+        }
+
+        // Called by the writer that unpublished `old`
+        static void retire(uint64_t old) noexcept {
+            Node* node = node_of(old);
+            if (!node) {
+                return;
+            }
+            int external = external_of(old);
+            if (node->internal_count.fetch_add(external, memory_order_acq_rel) == -external) {
+                delete node;
+            }
+        }
+
+    public:
+        using value_type = LockFreeSharedWithWeakPtr<T>;
+
+        static constexpr bool is_always_lock_free = atomic<uint64_t>::is_always_lock_free;
+
+        AtomicLockFreeSharedPtr() noexcept = default;
+        AtomicLockFreeSharedPtr(std::nullptr_t) noexcept {}
+
+        AtomicLockFreeSharedPtr(const value_type& desired)
+            : word(make_word(desired)) {}
+
+        AtomicLockFreeSharedPtr(const AtomicLockFreeSharedPtr&) = delete;
+        AtomicLockFreeSharedPtr& operator=(const AtomicLockFreeSharedPtr&) = delete;
+
+        ~AtomicLockFreeSharedPtr() {
+            retire(word.load(memory_order_acquire));
+        }
+
+        bool is_lock_free() const noexcept {
+            return word.is_lock_free();
+        }
+
+        value_type load() const noexcept {
+            uint64_t pinned = pin();
+            Node* node = node_of(pinned);
+            value_type result = node ? node->value : value_type();
+            unpin(node);
+            return result;
+        }
+
+        operator value_type() const noexcept {
+            return load();
+        }
+
+        void store(const value_type& desired) {
+            retire(word.exchange(make_word(desired), memory_order_acq_rel));
+        }
+
+        AtomicLockFreeSharedPtr& operator=(const value_type& desired) {
+            store(desired);
+            return *this;
+        }
+
+        value_type exchange(const value_type& desired) {
+            uint64_t old = word.exchange(make_word(desired), memory_order_acq_rel);
+            // Until retire() folds the external count in, nobody else can
+            // free the old node, so its value is still safe to copy.
+            Node* node = node_of(old);
+            value_type previous = node ? node->value : value_type();
+            retire(old);
+            return previous;
+        }
+
+        // Compares owner and stored pointer, like std::atomic<shared_ptr>.
+        // On failure `expected` receives the current value.
+        bool compare_exchange_strong(value_type& expected, const value_type& desired) {
+            auto wanted = expected.load_ptrs(memory_order_acquire);
+            uint64_t fresh = make_word(desired);
+            while (true) {
+                uint64_t pinned = pin();
+                Node* node = node_of(pinned);
+                auto current = node ? node->value.load_ptrs(memory_order_acquire)
+                                    : typename value_type::PointerPair{nullptr, nullptr};
+                if (current.cb != wanted.cb || current.ptr != wanted.ptr) {
+                    expected = node ? node->value : value_type();
+                    unpin(node);
+                    free_word(fresh);
+                    return false;
+                }
+                // Retry only while the same node stays published; other
+                // readers moving the external count are not a mismatch.
+                uint64_t old = word.load(memory_order_acquire);
+                while (node_of(old) == node) {
+                    if (word.compare_exchange_weak(old, fresh,
+                            memory_order_acq_rel, memory_order_acquire)) {
+                        retire(old);
+                        unpin(node);
+                        return true;
+                    }
+                    ContentionStats::record(ContentionEvent::CasFailure);
+                }
+                unpin(node);
+            }
+        }
+
+        bool compare_exchange_weak(value_type& expected, const value_type& desired) {
+            return compare_exchange_strong(expected, desired);
+        }
+    };
+
     // Type traits support
     template<typename T>
     struct is_lock_free_shared_ptr : false_type {};
 
-    template<typename T>
-    struct is_lock_free_shared_ptr<LockFreeSharedWithWeakPtr<T>> : true_type {};
+    template<typename T, PointerLayout L>
+    struct is_lock_free_shared_ptr<LockFreeSharedWithWeakPtr<T, L>> : true_type {};
 
     template<typename T>
     inline constexpr bool is_lock_free_shared_ptr_v = 
         is_lock_free_shared_ptr<T>::value;
 
     // Comparison operators
-    template<typename T, typename U>
-    bool operator==(const LockFreeSharedWithWeakPtr<T>& lhs, 
-                   const LockFreeSharedWithWeakPtr<U>& rhs) noexcept {
+    template<typename T, PointerLayout L, typename U, PointerLayout M>
+    bool operator==(const LockFreeSharedWithWeakPtr<T, L>& lhs,
+                   const LockFreeSharedWithWeakPtr<U, M>& rhs) noexcept {
         return lhs.get() == rhs.get();
     }
 
-    template<typename T, typename U>
-    bool operator!=(const LockFreeSharedWithWeakPtr<T>& lhs,
-                   const LockFreeSharedWithWeakPtr<U>& rhs) noexcept {
+    template<typename T, PointerLayout L, typename U, PointerLayout M>
+    bool operator!=(const LockFreeSharedWithWeakPtr<T, L>& lhs,
+                   const LockFreeSharedWithWeakPtr<U, M>& rhs) noexcept {
         return !(lhs == rhs);
     }
 
-    template<typename T, typename U>
-    bool operator<(const LockFreeSharedWithWeakPtr<T>& lhs,
-                  const LockFreeSharedWithWeakPtr<U>& rhs) noexcept {
+    template<typename T, PointerLayout L, typename U, PointerLayout M>
+    bool operator<(const LockFreeSharedWithWeakPtr<T, L>& lhs,
+                  const LockFreeSharedWithWeakPtr<U, M>& rhs) noexcept {
         using P = typename common_type<T*, U*>::type;
         return less<P>()(lhs.get(), rhs.get());
     }
 
-    template<typename T, typename U>
-    bool operator<=(const LockFreeSharedWithWeakPtr<T>& lhs,
-                   const LockFreeSharedWithWeakPtr<U>& rhs) noexcept {
+    template<typename T, PointerLayout L, typename U, PointerLayout M>
+    bool operator<=(const LockFreeSharedWithWeakPtr<T, L>& lhs,
+                   const LockFreeSharedWithWeakPtr<U, M>& rhs) noexcept {
         return !(rhs < lhs);
     }
 
-    template<typename T, typename U>
-    bool operator>(const LockFreeSharedWithWeakPtr<T>& lhs,
-                  const LockFreeSharedWithWeakPtr<U>& rhs) noexcept {
+    template<typename T, PointerLayout L, typename U, PointerLayout M>
+    bool operator>(const LockFreeSharedWithWeakPtr<T, L>& lhs,
+                  const LockFreeSharedWithWeakPtr<U, M>& rhs) noexcept {
         return rhs < lhs;
     }
 
-    template<typename T, typename U>
-    bool operator>=(const LockFreeSharedWithWeakPtr<T>& lhs,
-                   const LockFreeSharedWithWeakPtr<U>& rhs) noexcept {
+    template<typename T, PointerLayout L, typename U, PointerLayout M>
+    bool operator>=(const LockFreeSharedWithWeakPtr<T, L>& lhs,
+                   const LockFreeSharedWithWeakPtr<U, M>& rhs) noexcept {
         return !(lhs < rhs);
     }
 
-    template<typename T>
-    bool operator==(const LockFreeSharedWithWeakPtr<T>& lhs, std::nullptr_t) noexcept {
+    template<typename T, PointerLayout L>
+    bool operator==(const LockFreeSharedWithWeakPtr<T, L>& lhs, std::nullptr_t) noexcept {
         return !lhs;
     }
 
-    template<typename T>
-    bool operator==(std::nullptr_t, const LockFreeSharedWithWeakPtr<T>& rhs) noexcept {
+    template<typename T, PointerLayout L>
+    bool operator==(std::nullptr_t, const LockFreeSharedWithWeakPtr<T, L>& rhs) noexcept {
         return !rhs;
     }
 
-    template<typename T>
-    bool operator!=(const LockFreeSharedWithWeakPtr<T>& lhs, std::nullptr_t) noexcept {
+    template<typename T, PointerLayout L>
+    bool operator!=(const LockFreeSharedWithWeakPtr<T, L>& lhs, std::nullptr_t) noexcept {
         return static_cast<bool>(lhs);
     }
 
-    template<typename T>
-    bool operator!=(std::nullptr_t, const LockFreeSharedWithWeakPtr<T>& rhs) noexcept {
+    template<typename T, PointerLayout L>
+    bool operator!=(std::nullptr_t, const LockFreeSharedWithWeakPtr<T, L>& rhs) noexcept {
         return static_cast<bool>(rhs);
     }
 
-    template<typename T>
+    // Weak counterpart of LockFreeSharedWithWeakPtr, in the same two
+    // layouts: a packed weak pointer is one word too, so locking, copying
+    // and assigning it are single-word atomics on every target
+    template<typename T, PointerLayout Layout>
     class LockFreeWeakPtr {
+        static_assert(Layout != PointerLayout::Packed || sizeof(void*) == 8,
+            "PointerLayout::Packed needs 64-bit pointers");
+
+        template<typename U, PointerLayout> friend class LockFreeWeakPtr;
+
     private:
         struct alignas(16) WeakPointerPair {
             ControlBlock* cb;
@@ -640,24 +1666,58 @@ export namespace ThreadSafeWorld {
             }
         };
 
-        atomic<WeakPointerPair> ptrs;
+        using Word = conditional_t<Layout == PointerLayout::Packed, uintptr_t, WeakPointerPair>;
+
+        atomic<Word> ptrs;
+
+        static Word encode(ControlBlock* cb, T* ptr) noexcept {
+            if constexpr (Layout == PointerLayout::Packed) {
+                return PackedPointer::pack(cb, ptr);
+            } else {
+                return WeakPointerPair{cb, ptr};
+            }
+        }
+
+        static ControlBlock* block(Word word) noexcept {
+            if constexpr (Layout == PointerLayout::Packed) {
+                return PackedPointer::block(word);
+            } else {
+                return word.cb;
+            }
+        }
+
+        // Reads the block in the packed layout: only for a word whose weak
+        // reference is still held
+        static T* object(Word word) noexcept {
+            if constexpr (Layout == PointerLayout::Packed) {
+                return static_cast<T*>(PackedPointer::object(word));
+            } else {
+                return word.ptr;
+            }
+        }
 
     public:
         constexpr LockFreeWeakPtr() noexcept = default;
 
-        LockFreeWeakPtr(const LockFreeSharedWithWeakPtr<T>& shared) noexcept {
+        // Packing a pointer that comes from the pair layout throws
+        // invalid_argument if it is aliased too far from the owned object
+        template<PointerLayout SharedLayout>
+        LockFreeWeakPtr(const LockFreeSharedWithWeakPtr<T, SharedLayout>& shared)
+            noexcept(Layout == PointerLayout::Pair || SharedLayout == PointerLayout::Packed) {
             auto shared_ptrs = shared.load_ptrs(memory_order_acquire);
             if (shared_ptrs.cb) {
+                if constexpr (SharedLayout != Layout) {
+                    LockFreeSharedWithWeakPtr<T, Layout>::check_fits(shared_ptrs.cb, shared_ptrs.ptr);
+                }
                 shared_ptrs.cb->addWeakRef();
-                ptrs.store(WeakPointerPair{shared_ptrs.cb, shared_ptrs.ptr}, 
-                          memory_order_release);
+                ptrs.store(encode(shared_ptrs.cb, shared_ptrs.ptr), memory_order_release);
             }
         }
 
         LockFreeWeakPtr(const LockFreeWeakPtr& other) noexcept {
             auto other_ptrs = other.ptrs.load(memory_order_acquire);
-            if (other_ptrs.cb) {
-                other_ptrs.cb->addWeakRef();
+            if (block(other_ptrs)) {
+                block(other_ptrs)->addWeakRef();
                 ptrs.store(other_ptrs, memory_order_release);
             }
         }
@@ -665,13 +1725,13 @@ export namespace ThreadSafeWorld {
         LockFreeWeakPtr& operator=(const LockFreeWeakPtr& other) noexcept {
             if (this != &other) {
                 auto new_ptrs = other.ptrs.load(memory_order_acquire);
-                if (new_ptrs.cb) {
-                    new_ptrs.cb->addWeakRef();
+                if (block(new_ptrs)) {
+                    block(new_ptrs)->addWeakRef();
                 }
 
                 auto old_ptrs = ptrs.exchange(new_ptrs, memory_order_acq_rel);
-                if (old_ptrs.cb) {
-                    old_ptrs.cb->removeWeakRef();
+                if (block(old_ptrs)) {
+                    block(old_ptrs)->removeWeakRef();
                 }
             }
             return *this;
@@ -679,71 +1739,187 @@ export namespace ThreadSafeWorld {
 
         ~LockFreeWeakPtr() noexcept {
             auto old_ptrs = ptrs.load(memory_order_acquire);
-            if (old_ptrs.cb) {
-                old_ptrs.cb->removeWeakRef();
+            if (block(old_ptrs)) {
+                block(old_ptrs)->removeWeakRef();
             }
         }
 
-        LockFreeSharedWithWeakPtr<T> lock() const noexcept {
-            WeakPointerPair current;
-            while (true) {
-                current = ptrs.load(memory_order_acquire);
-                if (!current.cb) {
-                    return LockFreeSharedWithWeakPtr<T>();
-                }
-
-                if (current.cb->tryAddRef()) {
-                    // Successfully increased reference count
-                    auto recheck = ptrs.load(memory_order_acquire);
-                    if (recheck.cb == current.cb) {
-                        return LockFreeSharedWithWeakPtr<T>(current.ptr,
-                            [cb = current.cb](T*) { cb->removeRef(); });
-                    }
-                    // Control block changed, undo reference increment
-                    current.cb->removeRef();
-                } else {
-                    // Control block is expired
-                    return LockFreeSharedWithWeakPtr<T>();
-                }
+        // Upgrades to a strong pointer sharing the original control block.
+        // Our weak reference keeps the block alive, so the only cost is the
+        // tryAddRef CAS; the strong reference it takes is adopted as-is.
+        // Locking a pair weak pointer into the packed layout throws
+        // invalid_argument if the pointer is aliased too far from the owned
+        // object.
+        template<PointerLayout SharedLayout = Layout>
+        LockFreeSharedWithWeakPtr<T, SharedLayout> lock() const
+            noexcept(SharedLayout == PointerLayout::Pair || Layout == PointerLayout::Packed) {
+            auto current = ptrs.load(memory_order_acquire);
+            ControlBlock* cb = block(current);
+            if (!cb) {
+                return LockFreeSharedWithWeakPtr<T, SharedLayout>();
+            }
+            T* ptr = object(current);
+            if constexpr (SharedLayout != Layout) {
+                LockFreeSharedWithWeakPtr<T, SharedLayout>::check_fits(cb, ptr);
+            }
+            if (!cb->tryAddRef()) {
+                // The control block is expired
+                return LockFreeSharedWithWeakPtr<T, SharedLayout>();
             }
+            return LockFreeSharedWithWeakPtr<T, SharedLayout>(cb, ptr,
+                typename LockFreeSharedWithWeakPtr<T, SharedLayout>::adopt_ref_t{});
         }
 
         long use_count() const noexcept {
-            auto current = ptrs.load(memory_order_acquire);
-            return current.cb ? current.cb->use_count_val() : 0;
+            ControlBlock* cb = block(ptrs.load(memory_order_acquire));
+            return cb ? cb->use_count_val() : 0;
         }
 
         bool expired() const noexcept {
-            auto current = ptrs.load(memory_order_acquire);
-            return !current.cb || current.cb->isExpired();
+            ControlBlock* cb = block(ptrs.load(memory_order_acquire));
+            return !cb || cb->isExpired();
         }
 
         void reset() noexcept {
-            WeakPointerPair new_ptrs{nullptr, nullptr};
-            auto old_ptrs = ptrs.exchange(new_ptrs, memory_order_acq_rel);
-            if (old_ptrs.cb) {
+            auto old_ptrs = ptrs.exchange(Word{}, memory_order_acq_rel);
+            if (block(old_ptrs)) {
                 atomic_thread_fence(memory_order_acquire);
-                old_ptrs.cb->removeWeakRef();
+                block(old_ptrs)->removeWeakRef();
             }
         }
 
-        bool owner_before(const LockFreeWeakPtr& other) const noexcept {
-            return ptrs.load(memory_order_acquire).cb < 
-                   other.ptrs.load(memory_order_acquire).cb;
+        template<PointerLayout OtherLayout>
+        bool owner_before(const LockFreeWeakPtr<T, OtherLayout>& other) const noexcept {
+            return block(ptrs.load(memory_order_acquire)) <
+                   other.block(other.ptrs.load(memory_order_acquire));
         }
 
-        bool owner_before(const LockFreeSharedWithWeakPtr<T>& other) const noexcept {
-            return ptrs.load(memory_order_acquire).cb < 
+        template<PointerLayout SharedLayout>
+        bool owner_before(const LockFreeSharedWithWeakPtr<T, SharedLayout>& other) const noexcept {
+            return block(ptrs.load(memory_order_acquire)) <
                    other.load_ptrs(memory_order_acquire).cb;
         }
     };
+
+    // Non-owning borrow of a LockFreeSharedWithWeakPtr, for read-only call
+    // chains. It copies the block and object pointers out of the source
+    // once and touches no count afterwards, so passing it down several
+    // layers costs neither an RMW nor a reload of the source; promote()
+    // takes a reference of its own when a callee has to keep the object.
+    //
+    // The source must outlive the borrow and keep pointing at the same
+    // object meanwhile. Debug builds check both: the block asserts that no
+    // borrow is left when its last owner lets go, and every access asserts
+    // that the source still holds the same block. Release builds carry just
+    // the two pointers and are trivially copyable, so a SharedRef passed by
+    // value travels in registers.
+    template<typename T>
+    class SharedRef {
+    public:
+        template<typename U, PointerLayout Layout>
+            requires is_convertible_v<U*, T*>
+        SharedRef(const LockFreeSharedWithWeakPtr<U, Layout>& owner) noexcept {
+            auto current = owner.load_ptrs(memory_order_acquire);
+            cb = current.cb;
+            ptr = current.ptr;
+#ifndef NDEBUG
+            source = &owner;
+            source_block = [](const void* s) noexcept {
+                return static_cast<const LockFreeSharedWithWeakPtr<U, Layout>*>(s)
+                    ->load_ptrs(memory_order_acquire).cb;
+            };
+            if (cb) {
+                cb->addBorrow();
+            }
+#endif
+        }
+
+        // A temporary would be gone before the borrow is used
+        template<typename U, PointerLayout Layout>
+        SharedRef(const LockFreeSharedWithWeakPtr<U, Layout>&&) = delete;
+
+#ifndef NDEBUG
+        SharedRef(const SharedRef& other) noexcept
+            : cb(other.cb), ptr(other.ptr), source(other.source), source_block(other.source_block) {
+            if (cb) {
+                cb->addBorrow();
+            }
+        }
+
+        SharedRef& operator=(const SharedRef& other) noexcept {
+            if (other.cb) {
+                other.cb->addBorrow();
+            }
+            if (cb) {
+                cb->removeBorrow();
+            }
+            cb = other.cb;
+            ptr = other.ptr;
+            source = other.source;
+            source_block = other.source_block;
+            return *this;
+        }
+
+        ~SharedRef() {
+            if (cb) {
+                cb->removeBorrow();
+            }
+        }
+#endif
+
+        T* get() const noexcept {
+            checkSource();
+            return ptr;
+        }
+
+        T& operator*() const noexcept { return *get(); }
+        T* operator->() const noexcept { return get(); }
+
+        explicit operator bool() const noexcept {
+            return get() != nullptr;
+        }
+
+        int use_count() const noexcept {
+            checkSource();
+            return cb ? cb->use_count_val() : 0;
+        }
+
+        // An owning pointer sharing the source's block. The source still
+        // holds a reference, so a plain increment is enough. Promoting into
+        // the packed layout throws like its aliasing constructor.
+        template<PointerLayout Layout = default_pointer_layout>
+        LockFreeSharedWithWeakPtr<T, Layout> promote() const noexcept(Layout == PointerLayout::Pair) {
+            checkSource();
+            if (!cb) {
+                return LockFreeSharedWithWeakPtr<T, Layout>();
+            }
+            LockFreeSharedWithWeakPtr<T, Layout>::check_fits(cb, ptr);
+            cb->addRef();
+            return LockFreeSharedWithWeakPtr<T, Layout>(cb, ptr,
+                typename LockFreeSharedWithWeakPtr<T, Layout>::adopt_ref_t{});
+        }
+
+    private:
+        ControlBlock* cb;
+        T* ptr;
+#ifndef NDEBUG
+        const void* source;
+        ControlBlock* (*source_block)(const void*) noexcept;
+#endif
+
+        void checkSource() const noexcept {
+#ifndef NDEBUG
+            assert(source_block(source) == cb && "SharedRef source was reset or reassigned during the borrow");
+#endif
+        }
+    };
 }
 
 // Hash specialization in std namespace
 export namespace std {
-    template<typename T>
-    struct hash<ThreadSafeWorld::LockFreeSharedWithWeakPtr<T>> {
-        size_t operator()(const ThreadSafeWorld::LockFreeSharedWithWeakPtr<T>& ptr) const noexcept {
+    template<typename T, ThreadSafeWorld::PointerLayout L>
+    struct hash<ThreadSafeWorld::LockFreeSharedWithWeakPtr<T, L>> {
+        size_t operator()(const ThreadSafeWorld::LockFreeSharedWithWeakPtr<T, L>& ptr) const noexcept {
             return hash<T*>()(ptr.get());
         }
     };
@@ -0,0 +1,306 @@
+module;
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <thread>
+#include <utility>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+export module leonrahul.RcuCell;
+export import leonrahul.LockFreeSharedPtr;
+
+using namespace std;
+
+export namespace ThreadSafeWorld
+{
+    // Process-wide epoch manager for read-copy-update.
+    //
+    // A reader announces the global epoch in its thread's slot when it
+    // enters a read-side critical section and clears it when it leaves.
+    // A writer that unpublishes a version bumps the epoch and tags the
+    // version with the epoch it closed; the version can be freed once every
+    // active reader announces a later epoch.
+    class EpochManager
+    {
+    public:
+        static constexpr uint64_t quiescent = 0;
+
+        // Padded so each reader's announcements stay in its own cache line
+        struct alignas(64) ThreadSlot
+        {
+            atomic<uint64_t> epoch{quiescent};
+            atomic<bool> in_use{false};
+            ThreadSlot *next = nullptr;
+            // Nesting depth of read sections, touched only by the owner
+            unsigned depth = 0;
+        };
+
+        static EpochManager &global()
+        {
+            static EpochManager manager;
+            return manager;
+        }
+
+        EpochManager() = default;
+        EpochManager(const EpochManager &) = delete;
+        EpochManager &operator=(const EpochManager &) = delete;
+
+        ~EpochManager()
+        {
+            ThreadSlot *slot = slots.load(memory_order_acquire);
+            while (slot)
+            {
+                ThreadSlot *next = slot->next;
+                delete slot;
+                slot = next;
+            }
+        }
+
+        // Reuses the slot of an exited thread when there is one
+        ThreadSlot *acquire_slot()
+        {
+            for (ThreadSlot *slot = slots.load(memory_order_acquire); slot; slot = slot->next)
+            {
+                bool expected = false;
+                if (!slot->in_use.load(memory_order_relaxed) &&
+                    slot->in_use.compare_exchange_strong(expected, true, memory_order_acquire))
+                {
+                    return slot;
+                }
+            }
+
+            auto *slot = new ThreadSlot;
+            slot->in_use.store(true, memory_order_relaxed);
+            ThreadSlot *head = slots.load(memory_order_relaxed);
+            do
+            {
+                slot->next = head;
+            } while (!slots.compare_exchange_weak(head, slot, memory_order_release, memory_order_relaxed));
+            return slot;
+        }
+
+        void release_slot(ThreadSlot *slot) noexcept
+        {
+            slot->depth = 0;
+            slot->epoch.store(quiescent, memory_order_release);
+            slot->in_use.store(false, memory_order_release);
+        }
+
+        void enter(ThreadSlot &slot) noexcept
+        {
+            if (slot.depth++ == 0)
+            {
+                slot.epoch.store(current.load(memory_order_relaxed), memory_order_relaxed);
+                // Orders the announcement before every read of published data
+                atomic_thread_fence(memory_order_seq_cst);
+            }
+        }
+
+        void exit(ThreadSlot &slot) noexcept
+        {
+            if (--slot.depth == 0)
+            {
+                slot.epoch.store(quiescent, memory_order_release);
+            }
+        }
+
+        // Closes the current epoch and returns it. Readers that may have
+        // seen anything unpublished before the call announce at most this.
+        uint64_t advance() noexcept
+        {
+            return current.fetch_add(1, memory_order_seq_cst);
+        }
+
+        // Oldest epoch any reader is still in, or the maximum if none is
+        uint64_t oldest_active() const noexcept
+        {
+            atomic_thread_fence(memory_order_seq_cst);
+            uint64_t oldest = numeric_limits<uint64_t>::max();
+            for (ThreadSlot *slot = slots.load(memory_order_acquire); slot; slot = slot->next)
+            {
+                uint64_t epoch = slot->epoch.load(memory_order_acquire);
+                if (epoch != quiescent)
+                {
+                    oldest = min(oldest, epoch);
+                }
+            }
+            return oldest;
+        }
+
+        // Waits until every reader that entered before the call has left.
+        // Must not be called from inside a read section.
+        void synchronize() noexcept
+        {
+            uint64_t closed = advance();
+            while (oldest_active() <= closed)
+            {
+                this_thread::yield();
+            }
+        }
+
+    private:
+        atomic<uint64_t> current{1};
+        atomic<ThreadSlot *> slots{nullptr};
+    };
+
+    // Binds the calling thread to a slot of the global manager for its lifetime
+    struct EpochThreadState
+    {
+        EpochManager::ThreadSlot *slot = nullptr;
+
+        EpochManager::ThreadSlot &get()
+        {
+            if (!slot)
+            {
+                slot = EpochManager::global().acquire_slot();
+            }
+            return *slot;
+        }
+
+        ~EpochThreadState()
+        {
+            if (slot)
+            {
+                EpochManager::global().release_slot(slot);
+            }
+        }
+    };
+
+    inline thread_local EpochThreadState epoch_thread_state;
+
+    // Read-side critical section: whatever an RcuCell hands out while it is
+    // alive stays valid. Sections nest; they cost a store and a fence on
+    // entry and a store on exit, and never touch a reference count.
+    class RcuReadGuard
+    {
+    private:
+        EpochManager::ThreadSlot &slot_;
+
+    public:
+        RcuReadGuard() : slot_(epoch_thread_state.get())
+        {
+            EpochManager::global().enter(slot_);
+        }
+
+        RcuReadGuard(const RcuReadGuard &) = delete;
+        RcuReadGuard &operator=(const RcuReadGuard &) = delete;
+
+        ~RcuReadGuard()
+        {
+            EpochManager::global().exit(slot_);
+        }
+    };
+
+    // Read-mostly value published through RCU. Readers see a consistent
+    // snapshot with plain loads; writers are serialized, publish a whole new
+    // version and free old ones once every reader has moved past them.
+    // Versions are owned through LockFreeSharedPtr, so a reader that needs
+    // one beyond its read section can take a counted snapshot().
+    template <typename T>
+    class RcuCell
+    {
+    private:
+        atomic<T *> current;
+
+        mutable mutex writer;
+        LockFreeSharedPtr<T> owner;
+        // Unpublished versions with the epoch they were unpublished in
+        vector<pair<uint64_t, LockFreeSharedPtr<T>>> retired;
+
+        // Requires the writer lock
+        void publishLocked(LockFreeSharedPtr<T> next)
+        {
+            current.store(next.get(), memory_order_seq_cst);
+            uint64_t closed = EpochManager::global().advance();
+            retired.emplace_back(closed, std::move(owner));
+            owner = std::move(next);
+            reclaim(EpochManager::global().oldest_active());
+        }
+
+        // Requires the writer lock
+        void reclaim(uint64_t oldest_active)
+        {
+            retired.erase(remove_if(retired.begin(), retired.end(),
+                                    [oldest_active](const auto &entry)
+                                    { return entry.first < oldest_active; }),
+                          retired.end());
+        }
+
+    public:
+        explicit RcuCell(LockFreeSharedPtr<T> initial)
+            : current{initial.get()}, owner{std::move(initial)}
+        {
+        }
+
+        RcuCell(const RcuCell &) = delete;
+        RcuCell &operator=(const RcuCell &) = delete;
+
+        // No reader may still be inside the cell
+        ~RcuCell() = default;
+
+        // Current version; valid for the lifetime of the guard
+        const T *read(const RcuReadGuard &) const noexcept
+        {
+            return current.load(memory_order_acquire);
+        }
+
+        // Runs f on the current version inside its own read section
+        template <typename F>
+        decltype(auto) visit(F &&f) const
+        {
+            RcuReadGuard guard;
+            return std::forward<F>(f)(*read(guard));
+        }
+
+        // Counted handle to the current version, usable outside read sections
+        LockFreeSharedPtr<T> snapshot() const
+        {
+            lock_guard<mutex> lock(writer);
+            return owner;
+        }
+
+        // Makes next visible to new readers and frees the versions no
+        // reader can still see
+        void publish(LockFreeSharedPtr<T> next)
+        {
+            lock_guard<mutex> lock(writer);
+            publishLocked(std::move(next));
+        }
+
+        // Copy-modify-publish of the current version; concurrent updates
+        // are applied one after the other
+        template <typename F>
+        void update(F &&modify)
+        {
+            lock_guard<mutex> lock(writer);
+            T *copy = new T(*owner);
+            try
+            {
+                std::forward<F>(modify)(*copy);
+            }
+            catch (...)
+            {
+                delete copy;
+                throw;
+            }
+            publishLocked(LockFreeSharedPtr<T>(copy));
+        }
+
+        // Waits for readers of old versions and frees all of them. Must not
+        // be called from inside a read section.
+        void synchronize()
+        {
+            lock_guard<mutex> lock(writer);
+            EpochManager::global().synchronize();
+            retired.clear();
+        }
+
+        // Unpublished versions still waiting for readers
+        size_t pending() const
+        {
+            lock_guard<mutex> lock(writer);
+            return retired.size();
+        }
+    };
+}
@@ -0,0 +1,435 @@
+module;
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+#include "CustomString.h"
+#include "StringKernels.h"
+export module leonrahul.StringInternPool;
+export import leonrahul.CustomStringArray;
+
+namespace StringWorld
+{
+    // One interned string: header, then the characters and a '\0'. Entries
+    // live in their pool's arena and are never moved or freed before it.
+    struct InternEntry
+    {
+        size_t hash;
+        uint32_t id;
+        uint32_t length;
+
+        const char *text() const noexcept
+        {
+            return reinterpret_cast<const char *>(this + 1);
+        }
+    };
+}
+
+export namespace StringWorld
+{
+    class StringInternPool;
+
+    // Handle to a string in a StringInternPool. Equal contents interned in
+    // the same pool give the same entry, so equality and hashing compare a
+    // pointer and never look at the characters. A default-constructed
+    // handle, or one interned from nullptr, is null.
+    //
+    // Handles are plain pointers: copying them is free, and they must not
+    // outlive the pool.
+    class InternedString
+    {
+    public:
+        InternedString() noexcept = default;
+
+        const char *c_str() const noexcept
+        {
+            return entry_ != nullptr ? entry_->text() : nullptr;
+        }
+
+        size_t size() const noexcept
+        {
+            return entry_ != nullptr ? entry_->length : 0;
+        }
+
+        // Dense per-pool number, assigned in interning order from 0. The
+        // null handle has none and reports null_id.
+        static constexpr uint32_t null_id = std::numeric_limits<uint32_t>::max();
+
+        uint32_t id() const noexcept
+        {
+            return entry_ != nullptr ? entry_->id : null_id;
+        }
+
+        // Hash of the contents, computed once when interning
+        size_t hash() const noexcept
+        {
+            return entry_ != nullptr ? entry_->hash : 0;
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return entry_ != nullptr;
+        }
+
+        CustomString str() const
+        {
+            return entry_ != nullptr ? CustomString(entry_->text(), entry_->length) : CustomString();
+        }
+
+        friend bool operator==(InternedString, InternedString) noexcept = default;
+
+    private:
+        friend class StringInternPool;
+
+        explicit InternedString(const InternEntry *entry) noexcept : entry_{entry} {}
+
+        const InternEntry *entry_ = nullptr;
+    };
+
+    // What a pool holds, in bytes unless noted
+    struct InternPoolStats
+    {
+        size_t strings = 0;     // distinct strings interned
+        size_t text_bytes = 0;  // their characters, without terminators
+        size_t arena_bytes = 0; // arena chunks allocated for the entries
+        size_t table_bytes = 0; // hash tables, including retired ones
+    };
+
+    // Concurrent string interning. Each distinct string is stored once, and
+    // intern() hands back an InternedString for it.
+    //
+    // Strings are spread over shards by hash. Each shard has an open
+    // addressing table of entry pointers that readers probe with acquire
+    // loads and no lock, so interning a string that is already there never
+    // blocks. A miss takes the shard's mutex, probes again and inserts;
+    // slots are only ever filled, never cleared, so a reader sees either
+    // the entry or an empty slot. When a table gets three quarters full the
+    // writer publishes a table twice the size. Readers may still be probing
+    // the old one, so retired tables are kept until the pool is destroyed;
+    // their total stays below the size of the live table.
+    class StringInternPool
+    {
+    public:
+        static constexpr int shard_bits = 4;
+        static constexpr size_t shard_count = size_t{1} << shard_bits;
+        static constexpr size_t initial_slots = 64;
+        static constexpr size_t chunk_size = 64 * 1024;
+
+        StringInternPool() = default;
+        StringInternPool(const StringInternPool &) = delete;
+        StringInternPool &operator=(const StringInternPool &) = delete;
+
+        // Process-wide pool
+        static StringInternPool &global()
+        {
+            static StringInternPool pool;
+            return pool;
+        }
+
+        // The handle for the first length characters of text, which may
+        // contain '\0'. A null text gives the null handle.
+        InternedString intern(const char *text, size_t length)
+        {
+            if (text == nullptr)
+            {
+                return InternedString();
+            }
+            size_t hash = hashOf(text, length);
+            Shard &shard = shards[shardOf(hash)];
+            if (const InternEntry *found = shard.find(text, length, hash))
+            {
+                return InternedString(found);
+            }
+            std::lock_guard<std::mutex> lock(shard.write);
+            return InternedString(insertLocked(shard, text, length, hash));
+        }
+
+        InternedString intern(const char *text)
+        {
+            return text != nullptr ? intern(text, StringKernels::length(text)) : InternedString();
+        }
+
+        InternedString intern(const CustomString &text)
+        {
+            return text.c_str() != nullptr ? intern(text.c_str(), text.size()) : InternedString();
+        }
+
+        // Interns every element, null elements giving null handles. Strings
+        // already in the pool are looked up without locking, and each shard
+        // is locked once for all of the misses that fall into it.
+        std::vector<InternedString> intern(const CustomStringArray &texts)
+        {
+            int count = texts.getSize();
+            std::vector<InternedString> result(count);
+            std::vector<size_t> hashes(count);
+            std::vector<int> misses;
+            for (int i = 0; i < count; ++i)
+            {
+                const char *text = texts.get(i);
+                if (text == nullptr)
+                {
+                    continue;
+                }
+                hashes[i] = hashOf(text, texts.length(i));
+                const InternEntry *found = shards[shardOf(hashes[i])].find(text, texts.length(i), hashes[i]);
+                if (found != nullptr)
+                {
+                    result[i] = InternedString(found);
+                }
+                else
+                {
+                    misses.push_back(i);
+                }
+            }
+            std::sort(misses.begin(), misses.end(), [&](int a, int b)
+                      { return shardOf(hashes[a]) < shardOf(hashes[b]); });
+            for (size_t first = 0; first < misses.size();)
+            {
+                size_t index = shardOf(hashes[misses[first]]);
+                Shard &shard = shards[index];
+                std::lock_guard<std::mutex> lock(shard.write);
+                for (; first < misses.size() && shardOf(hashes[misses[first]]) == index; ++first)
+                {
+                    int i = misses[first];
+                    result[i] = InternedString(insertLocked(shard, texts.get(i), texts.length(i), hashes[i]));
+                }
+            }
+            return result;
+        }
+
+        // The handle for text if it has been interned, else the null handle;
+        // never inserts and never locks
+        InternedString find(const char *text, size_t length) const
+        {
+            if (text == nullptr)
+            {
+                return InternedString();
+            }
+            size_t hash = hashOf(text, length);
+            return InternedString(shards[shardOf(hash)].find(text, length, hash));
+        }
+
+        InternedString find(const char *text) const
+        {
+            return text != nullptr ? find(text, StringKernels::length(text)) : InternedString();
+        }
+
+        size_t size() const noexcept
+        {
+            return static_cast<size_t>(next_id.load(std::memory_order_relaxed));
+        }
+
+        // Sums the shards' counters, which each writer updates under its
+        // shard lock; with writers running the totals are approximate
+        InternPoolStats memoryUsage() const
+        {
+            InternPoolStats stats;
+            for (const Shard &shard : shards)
+            {
+                stats.strings += shard.strings.load(std::memory_order_relaxed);
+                stats.text_bytes += shard.text_bytes.load(std::memory_order_relaxed);
+                stats.arena_bytes += shard.arena_bytes.load(std::memory_order_relaxed);
+                stats.table_bytes += shard.table_bytes.load(std::memory_order_relaxed);
+            }
+            return stats;
+        }
+
+    private:
+        struct Table
+        {
+            size_t mask;
+            std::unique_ptr<std::atomic<const InternEntry *>[]> slots;
+
+            explicit Table(size_t capacity) : mask{capacity - 1}, slots{new std::atomic<const InternEntry *>[capacity]}
+            {
+                for (size_t i = 0; i < capacity; ++i)
+                {
+                    slots[i].store(nullptr, std::memory_order_relaxed);
+                }
+            }
+
+            size_t capacity() const noexcept
+            {
+                return mask + 1;
+            }
+        };
+
+        struct alignas(64) Shard
+        {
+            std::atomic<const Table *> table{nullptr};
+            std::mutex write;
+            // Everything below is written under write
+            std::vector<std::unique_ptr<Table>> tables; // live one last
+            std::vector<std::unique_ptr<char[]>> chunks;
+            char *cursor = nullptr;
+            size_t left = 0;
+            size_t filled = 0;
+            std::atomic<size_t> strings{0};
+            std::atomic<size_t> text_bytes{0};
+            std::atomic<size_t> arena_bytes{0};
+            std::atomic<size_t> table_bytes{0};
+
+            static bool matches(const InternEntry *entry, const char *text, size_t length, size_t hash) noexcept
+            {
+                return entry->hash == hash && StringKernels::equal(entry->text(), entry->length, text, length);
+            }
+
+            const InternEntry *find(const char *text, size_t length, size_t hash) const noexcept
+            {
+                const Table *current = table.load(std::memory_order_acquire);
+                if (current == nullptr)
+                {
+                    return nullptr;
+                }
+                for (size_t i = slotOf(hash) & current->mask;; i = (i + 1) & current->mask)
+                {
+                    const InternEntry *entry = current->slots[i].load(std::memory_order_acquire);
+                    if (entry == nullptr || matches(entry, text, length, hash))
+                    {
+                        return entry;
+                    }
+                }
+            }
+
+            // Slot for entry in a table no reader can see yet
+            static void place(Table &into, const InternEntry *entry) noexcept
+            {
+                size_t i = slotOf(entry->hash) & into.mask;
+                while (into.slots[i].load(std::memory_order_relaxed) != nullptr)
+                {
+                    i = (i + 1) & into.mask;
+                }
+                into.slots[i].store(entry, std::memory_order_relaxed);
+            }
+
+            // Publishes a table with room for one more entry under the load
+            // limit, rehashing the current one into it
+            void growTable()
+            {
+                const Table *current = tables.empty() ? nullptr : tables.back().get();
+                size_t capacity = current == nullptr ? initial_slots : current->capacity() * 2;
+                auto bigger = std::make_unique<Table>(capacity);
+                if (current != nullptr)
+                {
+                    for (size_t i = 0; i < current->capacity(); ++i)
+                    {
+                        if (const InternEntry *entry = current->slots[i].load(std::memory_order_relaxed))
+                        {
+                            place(*bigger, entry);
+                        }
+                    }
+                }
+                tables.push_back(std::move(bigger));
+                table_bytes.fetch_add(capacity * sizeof(std::atomic<const InternEntry *>), std::memory_order_relaxed);
+                table.store(tables.back().get(), std::memory_order_release);
+            }
+
+            // Carves room for an entry and its text out of the arena
+            void *allocate(size_t bytes)
+            {
+                bytes = (bytes + alignof(InternEntry) - 1) & ~(alignof(InternEntry) - 1);
+                if (bytes > left)
+                {
+                    // an oversized string gets a chunk of its own, and the
+                    // current chunk keeps serving the small ones
+                    size_t size = std::max(bytes, chunk_size);
+                    chunks.push_back(std::unique_ptr<char[]>(new char[size]));
+                    arena_bytes.fetch_add(size, std::memory_order_relaxed);
+                    if (size > chunk_size)
+                    {
+                        return chunks.back().get();
+                    }
+                    cursor = chunks.back().get();
+                    left = size;
+                }
+                void *at = cursor;
+                cursor += bytes;
+                left -= bytes;
+                return at;
+            }
+        };
+
+        Shard shards[shard_count];
+        std::atomic<uint32_t> next_id{0};
+
+        static size_t hashOf(const char *text, size_t length) noexcept
+        {
+            return std::hash<std::string_view>{}(std::string_view(text, length));
+        }
+
+        // The low bits pick the shard and the rest the slot, so entries of
+        // one shard do not all crowd into the same slots
+        static size_t shardOf(size_t hash) noexcept
+        {
+            return hash & (shard_count - 1);
+        }
+
+        static size_t slotOf(size_t hash) noexcept
+        {
+            return hash >> shard_bits;
+        }
+
+        // Caller holds shard.write
+        const InternEntry *insertLocked(Shard &shard, const char *text, size_t length, size_t hash)
+        {
+            if (const InternEntry *found = shard.find(text, length, hash))
+            {
+                return found;
+            }
+            if (length >= std::numeric_limits<uint32_t>::max())
+            {
+                throw std::length_error{"string too long to intern"};
+            }
+            const Table *current = shard.table.load(std::memory_order_relaxed);
+            if (current == nullptr || (shard.filled + 1) * 4 > current->capacity() * 3)
+            {
+                shard.growTable();
+                current = shard.table.load(std::memory_order_relaxed);
+            }
+            void *at = shard.allocate(sizeof(InternEntry) + length + 1);
+            uint32_t id = next_id.load(std::memory_order_relaxed);
+            do
+            {
+                if (id == InternedString::null_id)
+                {
+                    throw std::length_error{"intern pool is full"};
+                }
+            } while (!next_id.compare_exchange_weak(id, id + 1, std::memory_order_relaxed));
+
+            InternEntry *entry = new (at) InternEntry{hash, id, static_cast<uint32_t>(length)};
+            char *chars = reinterpret_cast<char *>(entry + 1);
+            memcpy(chars, text, length);
+            chars[length] = '\0';
+
+            size_t i = slotOf(hash) & current->mask;
+            while (current->slots[i].load(std::memory_order_relaxed) != nullptr)
+            {
+                i = (i + 1) & current->mask;
+            }
+            // release: a reader that finds the pointer also sees the text
+            current->slots[i].store(entry, std::memory_order_release);
+            ++shard.filled;
+            shard.strings.fetch_add(1, std::memory_order_relaxed);
+            shard.text_bytes.fetch_add(length, std::memory_order_relaxed);
+            return entry;
+        }
+    };
+}
+
+template <>
+struct std::hash<StringWorld::InternedString>
+{
+    size_t operator()(StringWorld::InternedString s) const noexcept
+    {
+        return s.hash();
+    }
+};
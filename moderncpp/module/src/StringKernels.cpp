@@ -0,0 +1,607 @@
+#include "../include/StringKernels.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define STRING_KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+// length() loads aligned blocks that may run past the terminator. They stay
+// inside the page, so the reads are safe, but the address and thread
+// sanitizers would report the bytes outside the string.
+#define STRING_KERNELS_WHOLE_BLOCKS __attribute__((no_sanitize("address", "thread")))
+
+namespace
+{
+    using StringKernels::npos;
+
+    int byteDiff(char a, char b)
+    {
+        return static_cast<int>(static_cast<unsigned char>(a)) - static_cast<int>(static_cast<unsigned char>(b));
+    }
+
+    // --- Scalar: the reference results, and the tails of the vector loops ---
+
+    size_t scalarLength(const char* s)
+    {
+        size_t n = 0;
+        while (s[n] != '\0')
+        {
+            ++n;
+        }
+        return n;
+    }
+
+    int scalarCompare(const char* a, size_t an, const char* b, size_t bn)
+    {
+        size_t n = std::min(an, bn);
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (a[i] != b[i])
+            {
+                return byteDiff(a[i], b[i]);
+            }
+        }
+        return an < bn ? -1 : (an > bn ? 1 : 0);
+    }
+
+    bool scalarEqual(const char* a, const char* b, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (a[i] != b[i])
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    size_t scalarFind(const char* haystack, size_t hn, const char* needle, size_t nn)
+    {
+        if (nn == 0)
+        {
+            return 0;
+        }
+        for (size_t i = 0; i + nn <= hn; ++i)
+        {
+            if (haystack[i] == needle[0] && scalarEqual(haystack + i + 1, needle + 1, nn - 1))
+            {
+                return i;
+            }
+        }
+        return npos;
+    }
+
+    size_t scalarFindFirstOf(const char* s, size_t n, const char* set, size_t setSize)
+    {
+        bool wanted[256] = {};
+        for (size_t k = 0; k < setSize; ++k)
+        {
+            wanted[static_cast<unsigned char>(set[k])] = true;
+        }
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (wanted[static_cast<unsigned char>(s[i])])
+            {
+                return i;
+            }
+        }
+        return npos;
+    }
+
+    // Runs the scalar search from offset on, for what the vectors left over
+    size_t findFrom(size_t offset, const char* haystack, size_t hn, const char* needle, size_t nn)
+    {
+        size_t found = scalarFind(haystack + offset, hn - offset, needle, nn);
+        return found == npos ? npos : offset + found;
+    }
+
+    size_t findFirstOfFrom(size_t offset, const char* s, size_t n, const char* set, size_t setSize)
+    {
+        size_t found = scalarFindFirstOf(s + offset, n - offset, set, setSize);
+        return found == npos ? npos : offset + found;
+    }
+
+    constexpr size_t max_vector_set = 16;
+
+    const StringKernels::Table scalarTable{
+        StringKernels::Level::Scalar, "scalar",
+        scalarLength, scalarCompare, scalarEqual, scalarFind, scalarFindFirstOf};
+
+#ifdef STRING_KERNELS_X86
+
+    // --- SSE2: 16 bytes at a time ---
+
+    // The first block is loaded from s rounded down to the vector width and
+    // its bits before s are dropped. Once p is aligned to the unrolled
+    // stride, whole strides are loaded at a time; a stride never crosses a
+    // page boundary, so it never touches a page the string does not reach.
+    STRING_KERNELS_WHOLE_BLOCKS __attribute__((target("sse2")))
+    unsigned sse2Zeros(const char* at)
+    {
+        return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(
+            _mm_load_si128(reinterpret_cast<const __m128i*>(at)), _mm_setzero_si128())));
+    }
+
+    STRING_KERNELS_WHOLE_BLOCKS __attribute__((target("sse2")))
+    size_t sse2Length(const char* s)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        size_t misalign = reinterpret_cast<uintptr_t>(s) & 15;
+        const char* p = s - misalign;
+        unsigned mask = sse2Zeros(p) >> misalign;
+        if (mask != 0)
+        {
+            return __builtin_ctz(mask);
+        }
+        for (p += 16; (reinterpret_cast<uintptr_t>(p) & 63) != 0; p += 16)
+        {
+            if ((mask = sse2Zeros(p)) != 0)
+            {
+                return static_cast<size_t>(p - s) + __builtin_ctz(mask);
+            }
+        }
+        for (;; p += 64)
+        {
+            // the unsigned minimum of the four blocks has a zero byte iff one of them does
+            const __m128i* v = reinterpret_cast<const __m128i*>(p);
+            __m128i low = _mm_min_epu8(_mm_load_si128(v), _mm_load_si128(v + 1));
+            __m128i high = _mm_min_epu8(_mm_load_si128(v + 2), _mm_load_si128(v + 3));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(low, high), zero)) != 0)
+            {
+                break;
+            }
+        }
+        for (;; p += 16)
+        {
+            if ((mask = sse2Zeros(p)) != 0)
+            {
+                return static_cast<size_t>(p - s) + __builtin_ctz(mask);
+            }
+        }
+    }
+
+    // Bit i set where a[i] != b[i]
+    __attribute__((target("sse2")))
+    unsigned sse2Differences(const char* a, const char* b)
+    {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b));
+        return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb))) ^ 0xFFFFu;
+    }
+
+    __attribute__((target("sse2")))
+    int sse2Compare(const char* a, size_t an, const char* b, size_t bn)
+    {
+        size_t n = std::min(an, bn);
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            if (unsigned diff = sse2Differences(a + i, b + i))
+            {
+                size_t j = i + __builtin_ctz(diff);
+                return byteDiff(a[j], b[j]);
+            }
+        }
+        return scalarCompare(a + i, an - i, b + i, bn - i);
+    }
+
+    __attribute__((target("sse2")))
+    bool sse2Equal(const char* a, const char* b, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            if (sse2Differences(a + i, b + i) != 0)
+            {
+                return false;
+            }
+        }
+        return scalarEqual(a + i, b + i, n - i);
+    }
+
+    // Candidates are the positions where both the first and the last byte
+    // of the needle match; only those are compared in full
+    __attribute__((target("sse2")))
+    size_t sse2Find(const char* haystack, size_t hn, const char* needle, size_t nn)
+    {
+        if (nn == 0 || nn > hn)
+        {
+            return nn == 0 ? 0 : npos;
+        }
+        const __m128i first = _mm_set1_epi8(needle[0]);
+        const __m128i last = _mm_set1_epi8(needle[nn - 1]);
+        size_t i = 0;
+        for (; i + nn - 1 + 16 <= hn; i += 16)
+        {
+            __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i));
+            __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i + nn - 1));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last))));
+            while (mask != 0)
+            {
+                size_t at = i + __builtin_ctz(mask);
+                if (scalarEqual(haystack + at, needle, nn))
+                {
+                    return at;
+                }
+                mask &= mask - 1;
+            }
+        }
+        return findFrom(i, haystack, hn, needle, nn);
+    }
+
+    __attribute__((target("sse2")))
+    size_t sse2FindFirstOf(const char* s, size_t n, const char* set, size_t setSize)
+    {
+        if (setSize == 0 || setSize > max_vector_set)
+        {
+            return scalarFindFirstOf(s, n, set, setSize);
+        }
+        __m128i wanted[max_vector_set];
+        for (size_t k = 0; k < setSize; ++k)
+        {
+            wanted[k] = _mm_set1_epi8(set[k]);
+        }
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+            __m128i hits = _mm_setzero_si128();
+            for (size_t k = 0; k < setSize; ++k)
+            {
+                hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, wanted[k]));
+            }
+            if (unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hits)))
+            {
+                return i + __builtin_ctz(mask);
+            }
+        }
+        return findFirstOfFrom(i, s, n, set, setSize);
+    }
+
+    // --- AVX2: 32 bytes at a time ---
+
+    STRING_KERNELS_WHOLE_BLOCKS __attribute__((target("avx2")))
+    uint32_t avx2Zeros(const char* at)
+    {
+        return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(
+            _mm256_load_si256(reinterpret_cast<const __m256i*>(at)), _mm256_setzero_si256())));
+    }
+
+    STRING_KERNELS_WHOLE_BLOCKS __attribute__((target("avx2")))
+    size_t avx2Length(const char* s)
+    {
+        const __m256i zero = _mm256_setzero_si256();
+        size_t misalign = reinterpret_cast<uintptr_t>(s) & 31;
+        const char* p = s - misalign;
+        uint32_t mask = avx2Zeros(p) >> misalign;
+        if (mask != 0)
+        {
+            return __builtin_ctz(mask);
+        }
+        for (p += 32; (reinterpret_cast<uintptr_t>(p) & 127) != 0; p += 32)
+        {
+            if ((mask = avx2Zeros(p)) != 0)
+            {
+                return static_cast<size_t>(p - s) + __builtin_ctz(mask);
+            }
+        }
+        for (;; p += 128)
+        {
+            const __m256i* v = reinterpret_cast<const __m256i*>(p);
+            __m256i low = _mm256_min_epu8(_mm256_load_si256(v), _mm256_load_si256(v + 1));
+            __m256i high = _mm256_min_epu8(_mm256_load_si256(v + 2), _mm256_load_si256(v + 3));
+            if (!_mm256_testz_si256(_mm256_cmpeq_epi8(_mm256_min_epu8(low, high), zero),
+                                    _mm256_set1_epi8(-1)))
+            {
+                break;
+            }
+        }
+        for (;; p += 32)
+        {
+            if ((mask = avx2Zeros(p)) != 0)
+            {
+                return static_cast<size_t>(p - s) + __builtin_ctz(mask);
+            }
+        }
+    }
+
+    __attribute__((target("avx2")))
+    uint32_t avx2Differences(const char* a, const char* b)
+    {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b));
+        return ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)));
+    }
+
+    __attribute__((target("avx2")))
+    int avx2Compare(const char* a, size_t an, const char* b, size_t bn)
+    {
+        size_t n = std::min(an, bn);
+        size_t i = 0;
+        for (; i + 32 <= n; i += 32)
+        {
+            if (uint32_t diff = avx2Differences(a + i, b + i))
+            {
+                size_t j = i + __builtin_ctz(diff);
+                return byteDiff(a[j], b[j]);
+            }
+        }
+        return sse2Compare(a + i, an - i, b + i, bn - i);
+    }
+
+    __attribute__((target("avx2")))
+    bool avx2Equal(const char* a, const char* b, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 32 <= n; i += 32)
+        {
+            if (avx2Differences(a + i, b + i) != 0)
+            {
+                return false;
+            }
+        }
+        return sse2Equal(a + i, b + i, n - i);
+    }
+
+    __attribute__((target("avx2")))
+    size_t avx2Find(const char* haystack, size_t hn, const char* needle, size_t nn)
+    {
+        if (nn == 0 || nn > hn)
+        {
+            return nn == 0 ? 0 : npos;
+        }
+        const __m256i first = _mm256_set1_epi8(needle[0]);
+        const __m256i last = _mm256_set1_epi8(needle[nn - 1]);
+        size_t i = 0;
+        for (; i + nn - 1 + 32 <= hn; i += 32)
+        {
+            __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(haystack + i));
+            __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(haystack + i + nn - 1));
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(
+                _mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last))));
+            while (mask != 0)
+            {
+                size_t at = i + __builtin_ctz(mask);
+                if (scalarEqual(haystack + at, needle, nn))
+                {
+                    return at;
+                }
+                mask &= mask - 1;
+            }
+        }
+        return findFrom(i, haystack, hn, needle, nn);
+    }
+
+    __attribute__((target("avx2")))
+    size_t avx2FindFirstOf(const char* s, size_t n, const char* set, size_t setSize)
+    {
+        if (setSize == 0 || setSize > max_vector_set)
+        {
+            return scalarFindFirstOf(s, n, set, setSize);
+        }
+        __m256i wanted[max_vector_set];
+        for (size_t k = 0; k < setSize; ++k)
+        {
+            wanted[k] = _mm256_set1_epi8(set[k]);
+        }
+        size_t i = 0;
+        for (; i + 32 <= n; i += 32)
+        {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+            __m256i hits = _mm256_setzero_si256();
+            for (size_t k = 0; k < setSize; ++k)
+            {
+                hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(block, wanted[k]));
+            }
+            if (uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(hits)))
+            {
+                return i + __builtin_ctz(mask);
+            }
+        }
+        return findFirstOfFrom(i, s, n, set, setSize);
+    }
+
+    // --- AVX-512BW: 64 bytes at a time, with masked loads for the tails ---
+
+    STRING_KERNELS_WHOLE_BLOCKS __attribute__((target("avx512f,avx512bw")))
+    size_t avx512Length(const char* s)
+    {
+        const __m512i zero = _mm512_setzero_si512();
+        size_t misalign = reinterpret_cast<uintptr_t>(s) & 63;
+        const char* p = s - misalign;
+        uint64_t mask = _mm512_cmpeq_epi8_mask(_mm512_load_si512(p), zero) >> misalign;
+        if (mask != 0)
+        {
+            return __builtin_ctzll(mask);
+        }
+        for (p += 64; (reinterpret_cast<uintptr_t>(p) & 255) != 0; p += 64)
+        {
+            if ((mask = _mm512_cmpeq_epi8_mask(_mm512_load_si512(p), zero)) != 0)
+            {
+                return static_cast<size_t>(p - s) + __builtin_ctzll(mask);
+            }
+        }
+        for (;; p += 256)
+        {
+            __m512i low = _mm512_min_epu8(_mm512_load_si512(p), _mm512_load_si512(p + 64));
+            __m512i high = _mm512_min_epu8(_mm512_load_si512(p + 128), _mm512_load_si512(p + 192));
+            if (_mm512_cmpeq_epi8_mask(_mm512_min_epu8(low, high), zero) != 0)
+            {
+                break;
+            }
+        }
+        for (;; p += 64)
+        {
+            if ((mask = _mm512_cmpeq_epi8_mask(_mm512_load_si512(p), zero)) != 0)
+            {
+                return static_cast<size_t>(p - s) + __builtin_ctzll(mask);
+            }
+        }
+    }
+
+    // The low n bits, for n up to 64
+    uint64_t lowBits(size_t n)
+    {
+        return n >= 64 ? ~uint64_t{0} : (uint64_t{1} << n) - 1;
+    }
+
+    // Bit i set where a[i] != b[i], for i below n (at most 64). Masked
+    // loads do not touch, and cannot fault on, the bytes past n.
+    __attribute__((target("avx512f,avx512bw")))
+    uint64_t avx512Differences(const char* a, const char* b, size_t n)
+    {
+        __mmask64 valid = lowBits(n);
+        __m512i va = _mm512_maskz_loadu_epi8(valid, a);
+        __m512i vb = _mm512_maskz_loadu_epi8(valid, b);
+        return _mm512_mask_cmpneq_epi8_mask(valid, va, vb);
+    }
+
+    __attribute__((target("avx512f,avx512bw")))
+    int avx512Compare(const char* a, size_t an, const char* b, size_t bn)
+    {
+        size_t n = std::min(an, bn);
+        for (size_t i = 0; i < n; i += 64)
+        {
+            if (uint64_t diff = avx512Differences(a + i, b + i, std::min<size_t>(64, n - i)))
+            {
+                size_t j = i + __builtin_ctzll(diff);
+                return byteDiff(a[j], b[j]);
+            }
+        }
+        return an < bn ? -1 : (an > bn ? 1 : 0);
+    }
+
+    __attribute__((target("avx512f,avx512bw")))
+    bool avx512Equal(const char* a, const char* b, size_t n)
+    {
+        for (size_t i = 0; i < n; i += 64)
+        {
+            if (avx512Differences(a + i, b + i, std::min<size_t>(64, n - i)) != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    __attribute__((target("avx512f,avx512bw")))
+    size_t avx512Find(const char* haystack, size_t hn, const char* needle, size_t nn)
+    {
+        if (nn == 0 || nn > hn)
+        {
+            return nn == 0 ? 0 : npos;
+        }
+        const __m512i first = _mm512_set1_epi8(needle[0]);
+        const __m512i last = _mm512_set1_epi8(needle[nn - 1]);
+        // candidates are the positions 0 .. hn - nn
+        size_t candidates = hn - nn + 1;
+        for (size_t i = 0; i < candidates; i += 64)
+        {
+            __mmask64 valid = lowBits(candidates - i);
+            __m512i blockFirst = _mm512_maskz_loadu_epi8(valid, haystack + i);
+            __m512i blockLast = _mm512_maskz_loadu_epi8(valid, haystack + i + nn - 1);
+            uint64_t mask = _mm512_mask_cmpeq_epi8_mask(_mm512_mask_cmpeq_epi8_mask(valid, blockFirst, first),
+                                                        blockLast, last);
+            while (mask != 0)
+            {
+                size_t at = i + __builtin_ctzll(mask);
+                if (scalarEqual(haystack + at, needle, nn))
+                {
+                    return at;
+                }
+                mask &= mask - 1;
+            }
+        }
+        return npos;
+    }
+
+    __attribute__((target("avx512f,avx512bw")))
+    size_t avx512FindFirstOf(const char* s, size_t n, const char* set, size_t setSize)
+    {
+        if (setSize == 0 || setSize > max_vector_set)
+        {
+            return scalarFindFirstOf(s, n, set, setSize);
+        }
+        __m512i wanted[max_vector_set];
+        for (size_t k = 0; k < setSize; ++k)
+        {
+            wanted[k] = _mm512_set1_epi8(set[k]);
+        }
+        for (size_t i = 0; i < n; i += 64)
+        {
+            __mmask64 valid = lowBits(n - i);
+            __m512i block = _mm512_maskz_loadu_epi8(valid, s + i);
+            uint64_t hits = 0;
+            for (size_t k = 0; k < setSize; ++k)
+            {
+                hits |= _mm512_mask_cmpeq_epi8_mask(valid, block, wanted[k]);
+            }
+            if (hits != 0)
+            {
+                return i + __builtin_ctzll(hits);
+            }
+        }
+        return npos;
+    }
+
+    const StringKernels::Table sse2Table{
+        StringKernels::Level::SSE2, "sse2",
+        sse2Length, sse2Compare, sse2Equal, sse2Find, sse2FindFirstOf};
+
+    const StringKernels::Table avx2Table{
+        StringKernels::Level::AVX2, "avx2",
+        avx2Length, avx2Compare, avx2Equal, avx2Find, avx2FindFirstOf};
+
+    const StringKernels::Table avx512Table{
+        StringKernels::Level::AVX512, "avx512",
+        avx512Length, avx512Compare, avx512Equal, avx512Find, avx512FindFirstOf};
+
+#endif
+}
+
+namespace StringKernels
+{
+    const Table* forLevel(Level level)
+    {
+        switch (level)
+        {
+        case Level::Scalar:
+            return &scalarTable;
+#ifdef STRING_KERNELS_X86
+        case Level::SSE2:
+            // may run before the constructors that set up the CPU model
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("sse2") ? &sse2Table : nullptr;
+        case Level::AVX2:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") ? &avx2Table : nullptr;
+        case Level::AVX512:
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") ? &avx512Table : nullptr;
+#endif
+        default:
+            return nullptr;
+        }
+    }
+
+    const Table& active()
+    {
+        static const Table& best = []() -> const Table&
+        {
+            for (Level level : {Level::AVX512, Level::AVX2, Level::SSE2})
+            {
+                if (const Table* table = forLevel(level))
+                {
+                    return *table;
+                }
+            }
+            return scalarTable;
+        }();
+        return best;
+    }
+}
@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+import leonrahul.ConcurrentObjectCache;
+
+using namespace std;
+using namespace std::chrono_literals;
+using ThreadSafeWorld::ConcurrentObjectCache;
+using ThreadSafeWorld::LockFreeSharedWithWeakPtr;
+using ThreadSafeWorld::make_shared_custom;
+
+// Stands in for a parsed schema; counts how many are alive
+struct CachedSchema {
+    static atomic<int> alive;
+    string source;
+
+    explicit CachedSchema(string s) : source(std::move(s)) {
+        alive.fetch_add(1, memory_order_relaxed);
+    }
+    ~CachedSchema() {
+        alive.fetch_sub(1, memory_order_relaxed);
+    }
+};
+
+atomic<int> CachedSchema::alive(0);
+
+using SchemaCache = ConcurrentObjectCache<string, CachedSchema>;
+
+class ConcurrentObjectCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        CachedSchema::alive = 0;
+    }
+
+    void TearDown() override {
+        EXPECT_EQ(CachedSchema::alive.load(), 0);
+    }
+};
+
+TEST_F(ConcurrentObjectCacheTest, SameKeySharesOneObject) {
+    SchemaCache cache;
+    int built = 0;
+    auto make = [&] {
+        ++built;
+        return make_shared_custom<CachedSchema>("user");
+    };
+    auto first = cache.get_or_create("user", make);
+    auto second = cache.get_or_create("user", make);
+    auto other = cache.get_or_create("order", [] { return make_shared_custom<CachedSchema>("order"); });
+
+    EXPECT_EQ(first.get(), second.get());
+    EXPECT_NE(first.get(), other.get());
+    EXPECT_EQ(built, 1);
+    EXPECT_EQ(cache.find("user").get(), first.get());
+    EXPECT_EQ(cache.size(), 2u);
+}
+
+TEST_F(ConcurrentObjectCacheTest, EntriesDoNotKeepObjectsAlive) {
+    SchemaCache cache;
+    auto make = [] { return make_shared_custom<CachedSchema>("user"); };
+    auto schema = cache.get_or_create("user", make);
+    EXPECT_EQ(CachedSchema::alive.load(), 1);
+
+    schema.reset();
+    EXPECT_EQ(CachedSchema::alive.load(), 0);
+    EXPECT_FALSE(cache.find("user"));
+
+    // The expired entry is rebuilt in place
+    schema = cache.get_or_create("user", make);
+    EXPECT_TRUE(schema);
+    EXPECT_EQ(cache.size(), 1u);
+}
+
+TEST_F(ConcurrentObjectCacheTest, ConcurrentMissesBuildOnce) {
+    SchemaCache cache;
+    atomic<int> built{0};
+    atomic<bool> go{false};
+    constexpr int num_threads = 8;
+    vector<LockFreeSharedWithWeakPtr<CachedSchema>> results(num_threads);
+    vector<thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t] {
+            while (!go.load(memory_order_acquire)) {
+                this_thread::yield();
+            }
+            results[t] = cache.get_or_create("schema", [&] {
+                built.fetch_add(1, memory_order_relaxed);
+                // Long enough for the other threads to find the entry pending
+                this_thread::sleep_for(20ms);
+                return make_shared_custom<CachedSchema>("schema");
+            });
+        });
+    }
+    go.store(true, memory_order_release);
+    for (auto& th : threads) {
+        th.join();
+    }
+
+    EXPECT_EQ(built.load(), 1);
+    for (auto& result : results) {
+        EXPECT_EQ(result.get(), results[0].get());
+    }
+}
+
+TEST_F(ConcurrentObjectCacheTest, FactoryFailureReachesWaitersAndAllowsRetry) {
+    SchemaCache cache;
+    atomic<bool> entered{false};
+    thread creator([&] {
+        EXPECT_THROW(cache.get_or_create("bad", [&]() -> LockFreeSharedWithWeakPtr<CachedSchema> {
+            entered.store(true, memory_order_release);
+            this_thread::sleep_for(20ms);
+            throw runtime_error("parse error");
+        }), runtime_error);
+    });
+    while (!entered.load(memory_order_acquire)) {
+        this_thread::yield();
+    }
+    EXPECT_THROW(cache.get_or_create("bad", [] { return make_shared_custom<CachedSchema>("never"); }),
+                 runtime_error);
+    creator.join();
+
+    EXPECT_EQ(cache.size(), 0u);
+    auto fixed = cache.get_or_create("bad", [] { return make_shared_custom<CachedSchema>("fixed"); });
+    EXPECT_EQ(fixed->source, "fixed");
+}
+
+TEST_F(ConcurrentObjectCacheTest, ExpiredEntriesAreSweptLazily) {
+    SchemaCache cache;
+    auto keep = cache.get_or_create("keep", [] { return make_shared_custom<CachedSchema>("keep"); });
+    constexpr int num_keys = 10000;
+    for (int i = 0; i < num_keys; ++i) {
+        string key = "k" + to_string(i);
+        cache.get_or_create(key, [&] { return make_shared_custom<CachedSchema>(key); });
+    }
+    // Stripes sweep on growth, so dead entries never pile up
+    EXPECT_LT(cache.size(), static_cast<size_t>(SchemaCache::stripe_count * SchemaCache::min_sweep_size * 4));
+
+    cache.sweep();
+    EXPECT_EQ(cache.size(), 1u);
+    EXPECT_EQ(cache.find("keep").get(), keep.get());
+}
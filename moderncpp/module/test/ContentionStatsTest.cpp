@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+import leonrahul.LockFreeSharedWithWeakPtr;
+
+using namespace std;
+using ThreadSafeWorld::ContentionEvent;
+using ThreadSafeWorld::ContentionSnapshot;
+using ThreadSafeWorld::ContentionStats;
+using ThreadSafeWorld::contention_stats_enabled;
+using ThreadSafeWorld::LockFreeSharedWithWeakPtr;
+using ThreadSafeWorld::LockFreeWeakPtr;
+using ThreadSafeWorld::make_shared_custom;
+
+// Every expectation holds in both builds: with the stats compiled out all
+// counts stay at zero
+static uint64_t expected(uint64_t count) {
+    return contention_stats_enabled ? count : 0;
+}
+
+TEST(ContentionStatsTest, SnapshotSumsAllThreads) {
+    auto before = ContentionStats::snapshot();
+    vector<thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([] {
+            ContentionStats::record(ContentionEvent::CasFailure, 10);
+            ContentionStats::record(ContentionEvent::SpinIteration, 3);
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    // The threads have exited; their counts stay in the totals
+    auto delta = ContentionStats::snapshot() - before;
+    EXPECT_EQ(delta.cas_failures, expected(40));
+    EXPECT_EQ(delta.spin_iterations, expected(12));
+    EXPECT_EQ(delta.allocations, 0u);
+    EXPECT_EQ(delta.final_releases, 0u);
+}
+
+TEST(ContentionStatsTest, CasFailedCountsOnlyFailures) {
+    auto before = ContentionStats::snapshot();
+    EXPECT_FALSE(ContentionStats::casFailed(true));
+    EXPECT_TRUE(ContentionStats::casFailed(false));
+    EXPECT_EQ((ContentionStats::snapshot() - before).cas_failures, expected(1));
+}
+
+TEST(ContentionStatsTest, CountsBlocksAndFinalReleases) {
+    auto before = ContentionStats::snapshot();
+    {
+        auto made = make_shared_custom<int>(1);
+        LockFreeSharedWithWeakPtr<int> adopted(new int(2));
+        auto copy = made;
+        LockFreeWeakPtr<int> weak(adopted);
+        EXPECT_EQ((ContentionStats::snapshot() - before).allocations, expected(2));
+        EXPECT_EQ((ContentionStats::snapshot() - before).final_releases, 0u);
+
+        adopted.reset();
+        EXPECT_EQ((ContentionStats::snapshot() - before).final_releases, expected(1));
+        EXPECT_FALSE(weak.lock());
+    }
+    auto delta = ContentionStats::snapshot() - before;
+    EXPECT_EQ(delta.allocations, expected(2));
+    EXPECT_EQ(delta.final_releases, expected(2));
+}
+
+TEST(ContentionStatsTest, ResetClearsEveryThread) {
+    thread([] { ContentionStats::record(ContentionEvent::Allocation, 5); }).join();
+    ContentionStats::record(ContentionEvent::FinalRelease, 5);
+    ContentionStats::reset();
+    auto totals = ContentionStats::snapshot();
+    EXPECT_EQ(totals.cas_failures, 0u);
+    EXPECT_EQ(totals.spin_iterations, 0u);
+    EXPECT_EQ(totals.allocations, 0u);
+    EXPECT_EQ(totals.final_releases, 0u);
+}
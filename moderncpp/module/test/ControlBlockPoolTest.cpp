@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+import leonrahul.ControlBlockPool;
+
+using namespace std;
+using ThreadSafeWorld::ControlBlockPool;
+using ThreadSafeWorld::PoolAllocated;
+
+// Stand-in for a small control block
+struct PooledBlock : PoolAllocated {
+    atomic<int> count{1};
+    void* object = nullptr;
+};
+
+TEST(ControlBlockPoolTest, FreedBlockIsReusedOnSameThread) {
+    void* first = ControlBlockPool::allocate(24);
+    ControlBlockPool::deallocate(first, 24);
+    void* second = ControlBlockPool::allocate(24);
+    EXPECT_EQ(first, second);
+    ControlBlockPool::deallocate(second, 24);
+}
+
+TEST(ControlBlockPoolTest, BlocksAreAlignedAndDistinct) {
+    vector<void*> blocks;
+    for (int i = 0; i < 5000; ++i) {
+        void* p = ControlBlockPool::allocate(40);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % ControlBlockPool::granularity, 0u);
+        blocks.push_back(p);
+    }
+    vector<void*> sorted = blocks;
+    sort(sorted.begin(), sorted.end());
+    EXPECT_EQ(adjacent_find(sorted.begin(), sorted.end()), sorted.end());
+    for (void* p : blocks) {
+        ControlBlockPool::deallocate(p, 40);
+    }
+}
+
+TEST(ControlBlockPoolTest, LargeRequestsBypassThePool) {
+    void* p = ControlBlockPool::allocate(ControlBlockPool::max_size + 1);
+    ASSERT_NE(p, nullptr);
+    ControlBlockPool::deallocate(p, ControlBlockPool::max_size + 1);
+}
+
+TEST(ControlBlockPoolTest, ClassOperatorsUseThePool) {
+    auto* block = new PooledBlock;
+    block->object = block;
+    delete block;
+
+    // LIFO free list hands the same block back
+    auto* again = new PooledBlock;
+    EXPECT_EQ(static_cast<void*>(again), static_cast<void*>(block));
+    delete again;
+}
+
+TEST(ControlBlockPoolTest, CrossThreadFreesReturnToOwner) {
+    const int count = 1000;
+    vector<PooledBlock*> blocks;
+    for (int i = 0; i < count; ++i) {
+        blocks.push_back(new PooledBlock);
+    }
+
+    // Freed elsewhere, in batches, and flushed when that thread exits
+    thread([&blocks] {
+        for (auto* block : blocks) {
+            delete block;
+        }
+    }).join();
+
+    // Allocating keeps working and eventually draws on the returned blocks
+    vector<PooledBlock*> again;
+    for (int i = 0; i < 4 * count; ++i) {
+        again.push_back(new PooledBlock);
+    }
+    for (auto* block : again) {
+        delete block;
+    }
+}
+
+TEST(ControlBlockPoolTest, ConcurrentProducersAndConsumers) {
+    const int num_pairs = 4;
+    const int per_thread = 20000;
+    vector<atomic<PooledBlock*>> mailboxes(num_pairs);
+    vector<thread> threads;
+    for (int i = 0; i < num_pairs; ++i) {
+        threads.emplace_back([&mailboxes, i] {
+            for (int j = 0; j < per_thread; ++j) {
+                auto* block = new PooledBlock;
+                block->count.store(j, memory_order_relaxed);
+                PooledBlock* expected = nullptr;
+                while (!mailboxes[i].compare_exchange_weak(expected, block, memory_order_release)) {
+                    expected = nullptr;
+                    this_thread::yield();
+                }
+            }
+        });
+        threads.emplace_back([&mailboxes, i] {
+            for (int j = 0; j < per_thread; ++j) {
+                PooledBlock* block;
+                while (!(block = mailboxes[i].exchange(nullptr, memory_order_acquire))) {
+                    this_thread::yield();
+                }
+                EXPECT_EQ(block->count.load(memory_order_relaxed), j);
+                delete block;
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+TEST(ControlBlockPoolTest, FreeOnlyThreadReturnsPartialBatch) {
+    // Fewer than a batch, from a size class the other tests leave alone
+    const size_t bytes = 200;
+    const int count = 10;
+    vector<void*> blocks;
+    for (int i = 0; i < count; ++i) {
+        blocks.push_back(ControlBlockPool::allocate(bytes));
+    }
+
+    // This thread never allocates from the pool, so only its exit can
+    // hand the batch back
+    thread([&blocks] {
+        for (void* p : blocks) {
+            ControlBlockPool::deallocate(p, bytes);
+        }
+    }).join();
+
+    // Once the local free list runs dry the owner takes them back
+    vector<void*> again;
+    size_t seen = 0;
+    size_t per_slab = ControlBlockPool::slab_size / bytes;
+    while (seen < blocks.size() && again.size() < 2 * per_slab) {
+        void* p = ControlBlockPool::allocate(bytes);
+        seen += count_if(blocks.begin(), blocks.end(), [p](void* b) { return b == p; });
+        again.push_back(p);
+    }
+    EXPECT_EQ(seen, blocks.size());
+    for (void* p : again) {
+        ControlBlockPool::deallocate(p, bytes);
+    }
+}
@@ -1,6 +1,9 @@
 #include "gtest/gtest.h"
 #include <cstring> // For strcmp, strlen
 #include <vector>
+#include <string>
+#include <algorithm>
+#include <random>
 #include <utility> // For std::move
 
 // Import the module containing the class under test
@@ -541,3 +544,214 @@ TEST_F(CustomStringArrayTest, Destructor) {
 
     SUCCEED(); // If we reach here without crashing, it's a good sign.
 }
+
+TEST_F(CustomStringArrayTest, ManyAddsKeepContents)
+{
+    // Enough adds to grow the table and the blob several times over
+    CustomStringArray arr;
+    const int count = 10000;
+    for (int i = 0; i < count; ++i)
+    {
+        arr.add(std::to_string(i).c_str());
+    }
+
+    ASSERT_EQ(arr.getSize(), count);
+    for (int i = 0; i < count; ++i)
+    {
+        ASSERT_STREQ(arr.get(i), std::to_string(i).c_str());
+        ASSERT_EQ(arr.length(i), std::to_string(i).size());
+    }
+}
+
+TEST_F(CustomStringArrayTest, AddNullAndOwnElement)
+{
+    CustomStringArray arr;
+    arr.add("first");
+    arr.add(nullptr);
+    ASSERT_EQ(arr.getSize(), 2);
+    ASSERT_EQ(arr.get(1), nullptr);
+    ASSERT_EQ(arr.length(1), 0u);
+
+    // Adding an element of the array itself must survive the blob growing
+    for (int i = 0; i < 100; ++i)
+    {
+        arr.add(arr.get(0));
+    }
+    ASSERT_EQ(arr.getSize(), 102);
+    ASSERT_STREQ(arr.get(101), "first");
+}
+
+TEST_F(CustomStringArrayTest, CopyAfterAddsPreservesNulls)
+{
+    CustomStringArray original;
+    original.add("a");
+    original.add(nullptr);
+    original.add("");
+    original.add("long enough to need its own bytes");
+
+    CustomStringArray copy = original;
+    ASSERT_EQ(copy.getSize(), 4);
+    ASSERT_STREQ(copy.get(0), "a");
+    ASSERT_EQ(copy.get(1), nullptr);
+    ASSERT_STREQ(copy.get(2), "");
+    ASSERT_STREQ(copy.get(3), "long enough to need its own bytes");
+
+    // The copy has exact-size buffers, so its next add grows them
+    copy.add("more");
+    ASSERT_STREQ(copy.get(4), "more");
+    ASSERT_STREQ(copy.get(3), "long enough to need its own bytes");
+    ASSERT_EQ(original.getSize(), 4);
+}
+
+TEST_F(CustomStringArrayTest, CompareAndFind)
+{
+    CustomStringArray arr;
+    arr.add("pear");
+    arr.add(nullptr);
+    arr.add("apple");
+    arr.add("pear");
+
+    EXPECT_GT(arr.compare(0, 2), 0);
+    EXPECT_EQ(arr.compare(0, 3), 0);
+    EXPECT_LT(arr.compare(1, 2), 0);
+    EXPECT_EQ(arr.find("pear"), 0);
+    EXPECT_EQ(arr.find("apple"), 2);
+    EXPECT_EQ(arr.find("plum"), -1);
+    EXPECT_EQ(arr.find(nullptr), -1);
+}
+
+namespace
+{
+    // Strings with long shared prefixes, repeats and bytes above 0x7F, so
+    // the sorts go past the first 8 cached bytes and see equal keys
+    std::vector<std::string> sortInput(size_t count, unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        const std::vector<std::string> prefixes = {"", "a", "https://example.com/api/", "https://example.com/api/v2/users/", "\xC3\xA9t\xC3\xA9"};
+        std::vector<std::string> words;
+        for (size_t i = 0; i < count; ++i)
+        {
+            std::string word = prefixes[rng() % prefixes.size()];
+            size_t tail = rng() % 12;
+            for (size_t k = 0; k < tail; ++k)
+            {
+                word += static_cast<char>('a' + rng() % 4);
+            }
+            words.push_back(word);
+        }
+        return words;
+    }
+
+    CustomStringArray toArray(const std::vector<std::string> &words)
+    {
+        CustomStringArray arr;
+        for (const auto &word : words)
+        {
+            arr.add(word.c_str());
+        }
+        return arr;
+    }
+
+    void expectSorted(const CustomStringArray &arr, std::vector<std::string> words)
+    {
+        // std::string compares as unsigned bytes, like the sorts
+        std::sort(words.begin(), words.end());
+        ASSERT_EQ(arr.getSize(), static_cast<int>(words.size()));
+        for (int i = 0; i < arr.getSize(); ++i)
+        {
+            ASSERT_STREQ(arr.get(i), words[i].c_str()) << "at " << i;
+        }
+    }
+}
+
+TEST_F(CustomStringArrayTest, SortMatchesStdSort)
+{
+    for (size_t count : {0u, 1u, 15u, 200u, 5000u})
+    {
+        auto words = sortInput(count, static_cast<unsigned>(count));
+        CustomStringArray arr = toArray(words);
+        arr.sort(1);
+        expectSorted(arr, words);
+
+        CustomStringArray stable = toArray(words);
+        stable.stableSort(1);
+        expectSorted(stable, words);
+    }
+}
+
+TEST_F(CustomStringArrayTest, SortNullsFirstAndStable)
+{
+    CustomStringArray arr;
+    arr.add("pear");
+    arr.add(nullptr);
+    arr.add("apple");
+    arr.add("pear");
+    arr.add(nullptr);
+    arr.add("apple");
+    char *firstPear = arr.get(0);
+    char *secondPear = arr.get(3);
+
+    arr.stableSort();
+    ASSERT_EQ(arr.get(0), nullptr);
+    ASSERT_EQ(arr.get(1), nullptr);
+    ASSERT_STREQ(arr.get(2), "apple");
+    ASSERT_STREQ(arr.get(3), "apple");
+    // the table is permuted, the strings stay where they are
+    ASSERT_EQ(arr.get(4), firstPear);
+    ASSERT_EQ(arr.get(5), secondPear);
+
+    // Stability across the radix passes and the small-range insertion sort
+    auto words = sortInput(3000, 7);
+    CustomStringArray many = toArray(words);
+    std::vector<const char *> before;
+    for (int i = 0; i < many.getSize(); ++i)
+    {
+        before.push_back(many.get(i));
+    }
+    many.stableSort(1);
+    for (int i = 1; i < many.getSize(); ++i)
+    {
+        if (std::strcmp(many.get(i - 1), many.get(i)) == 0)
+        {
+            // the blob holds the strings in insertion order
+            ASSERT_LT(many.get(i - 1), many.get(i));
+        }
+    }
+}
+
+TEST_F(CustomStringArrayTest, SortInParallel)
+{
+    // Large enough to hand ranges to helper threads
+    auto words = sortInput(150000, 11);
+    CustomStringArray arr = toArray(words);
+    arr.sort(4);
+    expectSorted(arr, words);
+
+    CustomStringArray stable = toArray(words);
+    stable.stableSort(4);
+    expectSorted(stable, words);
+}
+
+TEST_F(CustomStringArrayTest, SortNestedPrefixes)
+{
+    // "a", "aa", "aaa", ... peel one string off per byte, which once made
+    // the recursion as deep as the longest string
+    std::vector<std::string> words;
+    for (size_t length = 1; length <= 6000; ++length)
+    {
+        words.push_back(std::string(length, 'a'));
+    }
+    std::shuffle(words.begin(), words.end(), std::mt19937(5));
+    CustomStringArray arr = toArray(words);
+    arr.sort(1);
+    expectSorted(arr, words);
+
+    CustomStringArray stable = toArray(words);
+    stable.stableSort(1);
+    expectSorted(stable, words);
+
+    std::reverse(words.begin(), words.end());
+    CustomStringArray reversed = toArray(words);
+    reversed.sort(1);
+    expectSorted(reversed, words);
+}
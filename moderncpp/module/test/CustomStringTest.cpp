@@ -1,7 +1,13 @@
 #include "gtest/gtest.h"
 #include "../include/CustomString.h"
 #include <cstring>
+#include <sstream>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
 
 TEST(CustomStringTest, DefaultConstructor) {
     CustomString s;
@@ -297,3 +303,195 @@ TEST(CustomStringTest, AdditionOperatorWithNullptr) {
     EXPECT_THROW(s_null + s1, std::logic_error);
     EXPECT_THROW(s_null + s_null, std::logic_error);
 }
+
+// --- Small-string optimization ---
+
+TEST(CustomStringTest, ShortStringsStayInline) {
+    EXPECT_EQ(sizeof(CustomString), 24u);
+
+    CustomString key("id");
+    EXPECT_TRUE(key.isInline());
+    std::string longest(CustomString::inline_capacity, 'a');
+    CustomString edge(longest.c_str());
+    EXPECT_TRUE(edge.isInline());
+    EXPECT_EQ(edge.size(), CustomString::inline_capacity);
+    EXPECT_STREQ(edge.c_str(), longest.c_str());
+
+    std::string spilled(CustomString::inline_capacity + 1, 'b');
+    CustomString heap(spilled.c_str());
+    EXPECT_FALSE(heap.isInline());
+    EXPECT_EQ(heap.size(), spilled.size());
+    EXPECT_STREQ(heap.c_str(), spilled.c_str());
+
+    EXPECT_FALSE(CustomString(nullptr).isInline());
+}
+
+TEST(CustomStringTest, CopyAndMoveAcrossRepresentations) {
+    CustomString small("short");
+    CustomString large("a string well past the inline capacity");
+
+    CustomString target(small);
+    target = large;
+    EXPECT_FALSE(target.isInline());
+    EXPECT_STREQ(target.c_str(), large.c_str());
+    target = small;
+    EXPECT_TRUE(target.isInline());
+    EXPECT_STREQ(target.c_str(), "short");
+
+    // Moves carry either representation over and leave a null string
+    CustomString movedSmall(std::move(small));
+    EXPECT_STREQ(movedSmall.c_str(), "short");
+    EXPECT_EQ(small.c_str(), nullptr);
+    target = std::move(large);
+    EXPECT_STREQ(target.c_str(), "a string well past the inline capacity");
+    EXPECT_EQ(large.c_str(), nullptr);
+
+    // A copy of an inline string owns its own bytes
+    CustomString copy(movedSmall);
+    copy[0] = 'S';
+    EXPECT_STREQ(movedSmall.c_str(), "short");
+}
+
+TEST(CustomStringTest, ConcatenationCrossesInlineBoundary) {
+    CustomString half("eleven char");
+    CustomString joined = half + half;
+    EXPECT_EQ(joined.size(), 22u);
+    EXPECT_TRUE(joined.isInline());
+
+    CustomString spilled = joined + CustomString("!");
+    EXPECT_FALSE(spilled.isInline());
+    EXPECT_STREQ(spilled.c_str(), "eleven chareleven char!");
+
+    CustomString pair("ab", "cd");
+    EXPECT_TRUE(pair.isInline());
+    EXPECT_STREQ(pair.c_str(), "abcd");
+    CustomString prefix("abcdef", 3);
+    EXPECT_STREQ(prefix.c_str(), "abc");
+
+    std::stringstream ss;
+    ss << pair << '|' << spilled;
+    EXPECT_EQ(ss.str(), "abcd|eleven chareleven char!");
+
+    // Dropping characters moves a heap string back inline
+    ++spilled;
+    EXPECT_TRUE(spilled.isInline());
+    EXPECT_STREQ(spilled.c_str(), "leven chareleven char!");
+}
+
+// --- Lazy concatenation ---
+
+TEST(CustomStringTest, ChainedConcatenationMixesOperands) {
+    CustomString service("billing");
+    CustomString level("WARN");
+    std::string host = "node-7";
+    std::string_view sep = " | ";
+
+    CustomString line = level + sep + service + "@" + std::string_view(host) + sep + "disk almost full";
+    EXPECT_STREQ(line.c_str(), "WARN | billing@node-7 | disk almost full");
+    EXPECT_EQ(line.size(), std::strlen("WARN | billing@node-7 | disk almost full"));
+
+    // Plain strings may lead as long as a CustomString comes second
+    CustomString key = "tenant:" + service + ":" + CustomString("42");
+    EXPECT_STREQ(key.c_str(), "tenant:billing:42");
+
+    // Nothing is copied until the expression is converted
+    auto expr = service + "/" + level;
+    EXPECT_EQ(expr.size(), 12u);
+    EXPECT_EQ(expr.pieces()[0].data(), service.c_str());
+    EXPECT_STREQ(expr.str().c_str(), "billing/WARN");
+
+    std::stringstream ss;
+    ss << (level + ": " + service);
+    EXPECT_EQ(ss.str(), "WARN: billing");
+
+    // Two expressions join into one
+    CustomString both = (level + "/") + (service + "/" + level);
+    EXPECT_STREQ(both.c_str(), "WARN/billing/WARN");
+}
+
+TEST(CustomStringTest, ChainedConcatenationRejectsNulls) {
+    CustomString s("x");
+    CustomString none;
+    const char* nullText = nullptr;
+    EXPECT_THROW(s + "a" + none, std::logic_error);
+    EXPECT_THROW(s + nullText, std::logic_error);
+    EXPECT_THROW(none + std::string_view("a"), std::logic_error);
+
+    // Assigning an expression that reads the target is safe
+    s = s + "y" + s;
+    EXPECT_STREQ(s.c_str(), "xyx");
+}
+
+// --- Kernels and sharing ---
+
+TEST(CustomStringTest, CompareAndFind) {
+    CustomString apple("apple"), apples("apples"), banana("banana"), none;
+    EXPECT_LT(apple.compare(apples), 0);
+    EXPECT_GT(banana.compare(apple), 0);
+    EXPECT_LT(none.compare(CustomString("")), 0);
+    EXPECT_EQ(none.compare(CustomString()), 0);
+    EXPECT_TRUE(apple == CustomString("apple"));
+    EXPECT_TRUE(apple < apples);
+    EXPECT_FALSE(none == CustomString(""));
+
+    CustomString line("GET /api/v1/users?id=42 HTTP/1.1");
+    EXPECT_EQ(line.find("/api"), 4u);
+    EXPECT_EQ(line.find("HTTP", 10), 24u);
+    EXPECT_EQ(line.find("POST"), CustomString::npos);
+    EXPECT_EQ(line.findFirstOf("?#"), 17u);
+    EXPECT_EQ(line.findFirstOf(" ", 4), 23u);
+    EXPECT_EQ(none.find("a"), CustomString::npos);
+}
+
+TEST(CustomStringTest, SharedCopiesCountInsteadOfCopying) {
+    std::string payload(4096, 'p');
+    CustomString original(payload.c_str());
+    EXPECT_FALSE(original.isShared());
+    original.share();
+    ASSERT_TRUE(original.isShared());
+
+    CustomString copy(original);
+    CustomString assigned;
+    assigned = copy;
+    EXPECT_EQ(original.useCount(), 3u);
+    EXPECT_EQ(copy.c_str(), original.c_str());
+    EXPECT_EQ(assigned.c_str(), original.c_str());
+
+    // Writing gives the writer its own bytes and leaves the others alone
+    copy[0] = 'w';
+    EXPECT_FALSE(copy.isShared());
+    EXPECT_NE(copy.c_str(), original.c_str());
+    // reads through a const reference, which does not detach
+    EXPECT_EQ(std::as_const(original)[0], 'p');
+    EXPECT_EQ(original.useCount(), 2u);
+
+    // Moving hands the share over without touching the count
+    CustomString moved(std::move(assigned));
+    EXPECT_EQ(original.useCount(), 2u);
+    EXPECT_EQ(moved.size(), payload.size());
+
+    // Inline strings are left alone
+    CustomString small("tiny");
+    small.share();
+    EXPECT_TRUE(small.isInline());
+    EXPECT_EQ(small.useCount(), 1u);
+}
+
+TEST(CustomStringTest, SharedCopiesAcrossThreads) {
+    std::string payload(1000, 's');
+    CustomString original(payload.c_str());
+    original.share();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&original] {
+            for (int i = 0; i < 10000; ++i) {
+                CustomString copy(original);
+                ASSERT_EQ(copy.size(), 1000u);
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+    EXPECT_EQ(original.useCount(), 1u);
+}
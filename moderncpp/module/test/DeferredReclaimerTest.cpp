@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+import leonrahul.DeferredReclaimer;
+
+using namespace std;
+using namespace std::chrono_literals;
+using ThreadSafeWorld::DeferredNode;
+using ThreadSafeWorld::DeferredReclaimer;
+using ThreadSafeWorld::defer_reclaim;
+using ThreadSafeWorld::drain_deferred;
+
+// Heap node that counts its destruction and may queue a child when it dies
+struct DeferredItem : DeferredNode {
+    static atomic<int> destroyed;
+    DeferredItem* child = nullptr;
+
+    DeferredItem() {
+        deferred_reclaim = [](DeferredNode* node) {
+            delete static_cast<DeferredItem*>(node);
+        };
+    }
+
+    ~DeferredItem() {
+        destroyed.fetch_add(1, memory_order_relaxed);
+        if (child) {
+            defer_reclaim(child);
+        }
+    }
+};
+
+atomic<int> DeferredItem::destroyed(0);
+
+class DeferredReclaimerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        drain_deferred();
+        DeferredItem::destroyed = 0;
+    }
+};
+
+TEST_F(DeferredReclaimerTest, NothingIsDestroyedUntilDrained) {
+    for (int i = 0; i < 10; ++i) {
+        defer_reclaim(new DeferredItem);
+    }
+    EXPECT_EQ(DeferredItem::destroyed, 0);
+    EXPECT_EQ(drain_deferred(), 10u);
+    EXPECT_EQ(DeferredItem::destroyed, 10);
+    EXPECT_EQ(drain_deferred(), 0u);
+}
+
+TEST_F(DeferredReclaimerTest, DrainCollectsEveryThread) {
+    vector<thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([] {
+            for (int j = 0; j < 100; ++j) {
+                defer_reclaim(new DeferredItem);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(drain_deferred(), 400u);
+    EXPECT_EQ(DeferredItem::destroyed, 400);
+}
+
+TEST_F(DeferredReclaimerTest, DrainFollowsCascadingDrops) {
+    auto* parent = new DeferredItem;
+    parent->child = new DeferredItem;
+    parent->child->child = new DeferredItem;
+    defer_reclaim(parent);
+
+    EXPECT_EQ(drain_deferred(), 3u);
+    EXPECT_EQ(DeferredItem::destroyed, 3);
+}
+
+TEST_F(DeferredReclaimerTest, BackgroundReclaimerDrains) {
+    auto& reclaimer = DeferredReclaimer::global();
+    reclaimer.start_background(100us);
+    for (int i = 0; i < 50; ++i) {
+        defer_reclaim(new DeferredItem);
+    }
+
+    auto deadline = chrono::steady_clock::now() + 5s;
+    while (DeferredItem::destroyed < 50 && chrono::steady_clock::now() < deadline) {
+        this_thread::sleep_for(1ms);
+    }
+    reclaimer.stop_background();
+    EXPECT_EQ(DeferredItem::destroyed, 50);
+}
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+import leonrahul.HazardPointer;
+
+using namespace std;
+using ThreadSafeWorld::HazardDomain;
+using ThreadSafeWorld::HazardPointer;
+using ThreadSafeWorld::hazard_retire;
+using ThreadSafeWorld::hazard_flush;
+
+// Counts destructions so tests can see when the domain reclaims a node
+struct HazardNode {
+    static atomic<int> destroyed;
+    int value;
+
+    explicit HazardNode(int v) : value(v) {}
+    ~HazardNode() { destroyed.fetch_add(1, memory_order_relaxed); }
+};
+
+atomic<int> HazardNode::destroyed(0);
+
+class HazardPointerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        HazardNode::destroyed = 0;
+    }
+};
+
+TEST_F(HazardPointerTest, ProtectedNodeIsNotReclaimed) {
+    atomic<HazardNode*> source{new HazardNode(1)};
+    HazardPointer hp;
+    HazardNode* seen = hp.protect(source);
+
+    hazard_retire(source.exchange(new HazardNode(2)));
+    hazard_flush();
+    EXPECT_EQ(HazardNode::destroyed, 0);
+    EXPECT_EQ(seen->value, 1);
+
+    hp.reset();
+    hazard_flush();
+    EXPECT_EQ(HazardNode::destroyed, 1);
+    delete source.load();
+}
+
+TEST_F(HazardPointerTest, RetiredNodesAreReclaimedInBatches) {
+    const size_t threshold = HazardDomain::global().scan_threshold();
+    for (size_t i = 0; i + 1 < threshold; ++i) {
+        hazard_retire(new HazardNode(0));
+    }
+    EXPECT_EQ(HazardNode::destroyed, 0);
+
+    hazard_retire(new HazardNode(0));
+    EXPECT_EQ(HazardNode::destroyed, static_cast<int>(threshold));
+}
+
+TEST_F(HazardPointerTest, SlotsAreLimitedPerThread) {
+    vector<unique_ptr<HazardPointer>> held;
+    for (int i = 0; i < HazardDomain::slots_per_thread; ++i) {
+        held.push_back(make_unique<HazardPointer>());
+    }
+    EXPECT_THROW(HazardPointer{}, runtime_error);
+
+    // Released slots are handed out again
+    held.pop_back();
+    EXPECT_NO_THROW(HazardPointer{});
+}
+
+TEST_F(HazardPointerTest, LeftoversOfExitedThreadAreAdopted) {
+    HazardNode* node = new HazardNode(1);
+    HazardPointer hp;
+    hp.set(node);
+
+    thread([node] { hazard_retire(node); }).join();
+    EXPECT_EQ(HazardNode::destroyed, 0);
+
+    hp.reset();
+    hazard_flush();
+    EXPECT_EQ(HazardNode::destroyed, 1);
+}
+
+TEST_F(HazardPointerTest, ConcurrentReadersAndWriter) {
+    const int num_readers = 4;
+    const int updates = 5000;
+    atomic<HazardNode*> source{new HazardNode(0)};
+    atomic<bool> done{false};
+
+    vector<thread> readers;
+    for (int i = 0; i < num_readers; ++i) {
+        readers.emplace_back([&source, &done] {
+            HazardPointer hp;
+            int last = 0;
+            while (!done.load(memory_order_acquire)) {
+                int value = hp.protect(source)->value;
+                EXPECT_GE(value, last);
+                last = value;
+            }
+        });
+    }
+    for (int i = 1; i <= updates; ++i) {
+        hazard_retire(source.exchange(new HazardNode(i)));
+    }
+    done.store(true, memory_order_release);
+    for (auto& t : readers) {
+        t.join();
+    }
+
+    hazard_flush();
+    EXPECT_EQ(HazardNode::destroyed, updates);
+    delete source.load();
+}
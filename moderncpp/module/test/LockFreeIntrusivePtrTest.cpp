@@ -0,0 +1,266 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <unordered_set>
+#include <utility>
+
+import leonrahul.LockFreeIntrusivePtr;
+import leonrahul.HazardPointer;
+
+using namespace std;
+using ThreadSafeWorld::IntrusiveRefCounted;
+using ThreadSafeWorld::IntrusiveRefTraits;
+using ThreadSafeWorld::LockFreeIntrusivePtr;
+using ThreadSafeWorld::AtomicLockFreeIntrusivePtr;
+using ThreadSafeWorld::make_intrusive;
+using ThreadSafeWorld::hazard_flush;
+
+// Object carrying its count through the CRTP base
+struct IntrusiveNode : IntrusiveRefCounted<IntrusiveNode> {
+    static atomic<int> constructed;
+    static atomic<int> destroyed;
+    int value;
+
+    explicit IntrusiveNode(int v = 0) : value(v) {
+        constructed.fetch_add(1, memory_order_relaxed);
+    }
+    IntrusiveNode(const IntrusiveNode& other) : IntrusiveRefCounted(other), value(other.value) {
+        constructed.fetch_add(1, memory_order_relaxed);
+    }
+    ~IntrusiveNode() {
+        destroyed.fetch_add(1, memory_order_relaxed);
+    }
+};
+
+atomic<int> IntrusiveNode::constructed(0);
+atomic<int> IntrusiveNode::destroyed(0);
+
+// Legacy type with its own counting API, adapted through the traits
+struct LegacyCounted {
+    static atomic<int> released;
+    atomic<int> refs{0};
+    void retain() { refs.fetch_add(1, memory_order_relaxed); }
+    int unretain() { return refs.fetch_sub(1, memory_order_acq_rel) - 1; }
+};
+
+atomic<int> LegacyCounted::released(0);
+
+template <>
+struct ThreadSafeWorld::IntrusiveRefTraits<LegacyCounted> {
+    static void AddRef(LegacyCounted* p) noexcept { p->retain(); }
+    static bool DelRef(LegacyCounted* p) noexcept { return p->unretain() == 0; }
+    static void Destroy(LegacyCounted* p) noexcept {
+        LegacyCounted::released.fetch_add(1, memory_order_relaxed);
+        delete p;
+    }
+};
+
+class LockFreeIntrusivePtrTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        hazard_flush();
+        IntrusiveNode::constructed = 0;
+        IntrusiveNode::destroyed = 0;
+        LegacyCounted::released = 0;
+    }
+};
+
+TEST_F(LockFreeIntrusivePtrTest, DefaultAndNull) {
+    LockFreeIntrusivePtr<IntrusiveNode> empty;
+    LockFreeIntrusivePtr<IntrusiveNode> null(nullptr);
+    EXPECT_FALSE(empty);
+    EXPECT_EQ(empty.get(), nullptr);
+    EXPECT_TRUE(null == nullptr);
+    EXPECT_TRUE(empty == null);
+}
+
+TEST_F(LockFreeIntrusivePtrTest, CountLivesInObject) {
+    {
+        auto ptr = make_intrusive<IntrusiveNode>(5);
+        EXPECT_EQ(ptr->value, 5);
+        EXPECT_EQ(ptr->use_count(), 1u);
+        {
+            auto copy = ptr;
+            EXPECT_EQ(ptr->use_count(), 2u);
+            EXPECT_TRUE(copy == ptr);
+        }
+        EXPECT_EQ(ptr->use_count(), 1u);
+    }
+    EXPECT_EQ(IntrusiveNode::destroyed, 1);
+}
+
+TEST_F(LockFreeIntrusivePtrTest, RawPointerCanBeRewrapped) {
+    auto* raw = new IntrusiveNode(1);
+    LockFreeIntrusivePtr<IntrusiveNode> first(raw);
+    {
+        // No control block: a second wrapper of the same raw pointer shares the count
+        LockFreeIntrusivePtr<IntrusiveNode> second(raw);
+        EXPECT_EQ(raw->use_count(), 2u);
+    }
+    EXPECT_EQ(IntrusiveNode::destroyed, 0);
+    first.reset();
+    EXPECT_EQ(IntrusiveNode::destroyed, 1);
+}
+
+TEST_F(LockFreeIntrusivePtrTest, MoveAndAssign) {
+    auto a = make_intrusive<IntrusiveNode>(1);
+    auto b = make_intrusive<IntrusiveNode>(2);
+
+    LockFreeIntrusivePtr<IntrusiveNode> moved(std::move(a));
+    EXPECT_FALSE(a);
+    EXPECT_EQ(moved->use_count(), 1u);
+
+    moved = b;
+    EXPECT_EQ(IntrusiveNode::destroyed, 1);
+    EXPECT_EQ(b->use_count(), 2u);
+
+    moved = std::move(b);
+    EXPECT_FALSE(b);
+    EXPECT_EQ(moved->use_count(), 1u);
+
+    moved = moved;
+    EXPECT_EQ(moved->use_count(), 1u);
+    EXPECT_EQ(moved->value, 2);
+}
+
+TEST_F(LockFreeIntrusivePtrTest, ResetSwapDetach) {
+    auto a = make_intrusive<IntrusiveNode>(1);
+    auto b = make_intrusive<IntrusiveNode>(2);
+    swap(a, b);
+    EXPECT_EQ(a->value, 2);
+    EXPECT_EQ(b->value, 1);
+
+    a.reset(new IntrusiveNode(3));
+    EXPECT_EQ(IntrusiveNode::destroyed, 1);
+    EXPECT_EQ(a->value, 3);
+
+    IntrusiveNode* raw = b.detach();
+    EXPECT_FALSE(b);
+    EXPECT_EQ(raw->use_count(), 1u);
+    LockFreeIntrusivePtr<IntrusiveNode> adopted(raw, LockFreeIntrusivePtr<IntrusiveNode>::adopt_ref);
+    EXPECT_EQ(raw->use_count(), 1u);
+}
+
+TEST_F(LockFreeIntrusivePtrTest, CopiedObjectStartsWithFreshCount) {
+    auto ptr = make_intrusive<IntrusiveNode>(4);
+    auto copy = make_intrusive<IntrusiveNode>(*ptr);
+    EXPECT_EQ(copy->value, 4);
+    EXPECT_EQ(copy->use_count(), 1u);
+    EXPECT_EQ(ptr->use_count(), 1u);
+}
+
+TEST_F(LockFreeIntrusivePtrTest, TraitsCustomizationPoint) {
+    {
+        LockFreeIntrusivePtr<LegacyCounted> ptr(new LegacyCounted);
+        auto copy = ptr;
+        EXPECT_EQ(ptr->refs.load(), 2);
+    }
+    EXPECT_EQ(LegacyCounted::released, 1);
+}
+
+TEST_F(LockFreeIntrusivePtrTest, HashMatchesRawPointer) {
+    auto ptr = make_intrusive<IntrusiveNode>(1);
+    EXPECT_EQ(hash<LockFreeIntrusivePtr<IntrusiveNode>>()(ptr), hash<IntrusiveNode*>()(ptr.get()));
+
+    unordered_set<LockFreeIntrusivePtr<IntrusiveNode>> set;
+    set.insert(ptr);
+    set.insert(ptr);
+    EXPECT_EQ(set.size(), 1u);
+}
+
+TEST_F(LockFreeIntrusivePtrTest, ConcurrentCopiesOfSharedPointer) {
+    auto shared = make_intrusive<IntrusiveNode>(9);
+    vector<thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&shared] {
+            for (int j = 0; j < 10000; ++j) {
+                auto copy = shared;
+                EXPECT_EQ(copy->value, 9);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(shared->use_count(), 1u);
+}
+
+// --- Atomic slot ---
+
+TEST_F(LockFreeIntrusivePtrTest, AtomicSlotLoadStore) {
+    EXPECT_TRUE(AtomicLockFreeIntrusivePtr<IntrusiveNode>::is_always_lock_free);
+    {
+        AtomicLockFreeIntrusivePtr<IntrusiveNode> slot(make_intrusive<IntrusiveNode>(1));
+        EXPECT_TRUE(slot.is_lock_free());
+
+        auto loaded = slot.load();
+        EXPECT_EQ(loaded->value, 1);
+        EXPECT_EQ(loaded->use_count(), 2u);
+
+        slot.store(make_intrusive<IntrusiveNode>(2));
+        LockFreeIntrusivePtr<IntrusiveNode> current = slot;
+        EXPECT_EQ(current->value, 2);
+        EXPECT_EQ(loaded->value, 1);
+
+        slot = nullptr;
+        EXPECT_FALSE(slot.load());
+    }
+    hazard_flush();
+    EXPECT_EQ(IntrusiveNode::destroyed, 2);
+}
+
+TEST_F(LockFreeIntrusivePtrTest, AtomicSlotExchangeAndCompareExchange) {
+    {
+        AtomicLockFreeIntrusivePtr<IntrusiveNode> slot(make_intrusive<IntrusiveNode>(1));
+        auto old = slot.exchange(make_intrusive<IntrusiveNode>(2));
+        EXPECT_EQ(old->value, 1);
+
+        LockFreeIntrusivePtr<IntrusiveNode> expected = old;
+        EXPECT_FALSE(slot.compare_exchange_strong(expected, make_intrusive<IntrusiveNode>(3)));
+        EXPECT_EQ(expected->value, 2);
+
+        EXPECT_TRUE(slot.compare_exchange_strong(expected, make_intrusive<IntrusiveNode>(4)));
+        EXPECT_EQ(slot.load()->value, 4);
+    }
+    hazard_flush();
+    EXPECT_EQ(IntrusiveNode::destroyed, IntrusiveNode::constructed);
+}
+
+TEST_F(LockFreeIntrusivePtrTest, AtomicSlotConcurrentReadersAndWriters) {
+    const int num_readers = 4;
+    const int updates = 2000;
+    {
+        AtomicLockFreeIntrusivePtr<IntrusiveNode> slot(make_intrusive<IntrusiveNode>(0));
+        atomic<bool> done{false};
+
+        vector<thread> readers;
+        for (int i = 0; i < num_readers; ++i) {
+            readers.emplace_back([&slot, &done] {
+                int last = 0;
+                while (!done.load(memory_order_acquire)) {
+                    auto current = slot.load();
+                    EXPECT_GE(current->value, last);
+                    last = current->value;
+                }
+            });
+        }
+        thread cas_writer([&slot] {
+            for (int i = 0; i < 500; ++i) {
+                auto expected = slot.load();
+                auto next = make_intrusive<IntrusiveNode>(expected->value);
+                slot.compare_exchange_strong(expected, next);
+            }
+        });
+        for (int i = 1; i <= updates; ++i) {
+            slot.store(make_intrusive<IntrusiveNode>(updates + i));
+        }
+        cas_writer.join();
+        done.store(true, memory_order_release);
+        for (auto& t : readers) {
+            t.join();
+        }
+    }
+    hazard_flush();
+    EXPECT_EQ(IntrusiveNode::destroyed, IntrusiveNode::constructed);
+}
@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <memory_resource>
+#include <utility>
+#include <type_traits>
+
+import leonrahul.LockFreeSharedPtrGemini;
+
+using namespace std;
+using ThreadSafeWorld::LockFreeSharedPtrGemini;
+using ThreadSafeWorld::make_lock_free_shared;
+using ThreadSafeWorld::allocate_lock_free_shared;
+using ThreadSafeWorld::allocate_lock_free_shared_pmr;
+using ThreadSafeWorld::ControlBlockImpl;
+using ThreadSafeWorld::ControlBlockMakeShared;
+
+// Test helper class with tracking
+class GeminiTracked {
+public:
+    static atomic<int> constructor_calls;
+    static atomic<int> destructor_calls;
+    int value;
+
+    explicit GeminiTracked(int v = 0, bool throw_in_constructor = false) : value(v) {
+        if (throw_in_constructor) {
+            throw runtime_error("constructor failed");
+        }
+        constructor_calls.fetch_add(1, memory_order_release);
+    }
+
+    ~GeminiTracked() {
+        destructor_calls.fetch_add(1, memory_order_release);
+    }
+
+    static void reset_counters() {
+        constructor_calls = 0;
+        destructor_calls = 0;
+    }
+};
+
+atomic<int> GeminiTracked::constructor_calls(0);
+atomic<int> GeminiTracked::destructor_calls(0);
+
+// Allocator counting every allocation made through any of its rebinds
+template<typename T>
+class CountingAllocator {
+public:
+    using value_type = T;
+    static inline atomic<int> allocate_calls{0};
+    static inline atomic<int> deallocate_calls{0};
+
+    CountingAllocator() = default;
+    template<typename U>
+    CountingAllocator(const CountingAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) {
+        CountingAllocator<void>::allocate_calls.fetch_add(1, memory_order_relaxed);
+        return allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) {
+        CountingAllocator<void>::deallocate_calls.fetch_add(1, memory_order_relaxed);
+        allocator<T>().deallocate(p, n);
+    }
+
+    template<typename U>
+    bool operator==(const CountingAllocator<U>&) const noexcept { return true; }
+
+    static void reset_counters() {
+        CountingAllocator<void>::allocate_calls = 0;
+        CountingAllocator<void>::deallocate_calls = 0;
+    }
+};
+
+class LockFreeSharedPtrGeminiTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        GeminiTracked::reset_counters();
+        CountingAllocator<void>::reset_counters();
+    }
+};
+
+TEST_F(LockFreeSharedPtrGeminiTest, MakeSharedConstructsAndDestroys) {
+    {
+        auto ptr = make_lock_free_shared<GeminiTracked>(42);
+        ASSERT_TRUE(ptr);
+        EXPECT_EQ(ptr->value, 42);
+        EXPECT_EQ(ptr.use_count(), 1);
+        EXPECT_EQ(GeminiTracked::constructor_calls, 1);
+
+        auto copy = ptr;
+        EXPECT_EQ(ptr.use_count(), 2);
+        EXPECT_EQ(copy.get(), ptr.get());
+    }
+    EXPECT_EQ(GeminiTracked::destructor_calls, 1);
+}
+
+TEST_F(LockFreeSharedPtrGeminiTest, AllocateSharedUsesOneAllocation) {
+    {
+        auto ptr = allocate_lock_free_shared<GeminiTracked>(CountingAllocator<GeminiTracked>(), 7);
+        EXPECT_EQ(ptr->value, 7);
+        EXPECT_EQ(CountingAllocator<void>::allocate_calls, 1);
+        EXPECT_EQ(CountingAllocator<void>::deallocate_calls, 0);
+
+        auto copy = ptr;
+        ptr.reset();
+        EXPECT_EQ(GeminiTracked::destructor_calls, 0);
+    }
+    EXPECT_EQ(GeminiTracked::destructor_calls, 1);
+    EXPECT_EQ(CountingAllocator<void>::allocate_calls, 1);
+    EXPECT_EQ(CountingAllocator<void>::deallocate_calls, 1);
+}
+
+TEST_F(LockFreeSharedPtrGeminiTest, AllocateSharedReturnsStorageWhenConstructorThrows) {
+    EXPECT_THROW({
+        auto ptr = allocate_lock_free_shared<GeminiTracked>(CountingAllocator<GeminiTracked>(), 1, true);
+    }, runtime_error);
+
+    EXPECT_EQ(GeminiTracked::constructor_calls, 0);
+    EXPECT_EQ(GeminiTracked::destructor_calls, 0);
+    EXPECT_EQ(CountingAllocator<void>::allocate_calls, 1);
+    EXPECT_EQ(CountingAllocator<void>::deallocate_calls, 1);
+}
+
+TEST_F(LockFreeSharedPtrGeminiTest, AllocateSharedPmrPlacesObjectInArena) {
+    alignas(64) unsigned char buffer[1024];
+    pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), pmr::null_memory_resource());
+    {
+        auto ptr = allocate_lock_free_shared_pmr<GeminiTracked>(&arena, 8);
+        auto *object = reinterpret_cast<unsigned char *>(ptr.get());
+        EXPECT_GE(object, buffer);
+        EXPECT_LT(object, buffer + sizeof(buffer));
+        EXPECT_EQ(ptr->value, 8);
+    }
+    EXPECT_EQ(GeminiTracked::destructor_calls, 1);
+}
+
+TEST_F(LockFreeSharedPtrGeminiTest, RawPointerConstructorStillOwns) {
+    {
+        LockFreeSharedPtrGemini<GeminiTracked> ptr(new GeminiTracked(3));
+        LockFreeSharedPtrGemini<GeminiTracked> other = make_lock_free_shared<GeminiTracked>(4);
+        other = ptr;
+        EXPECT_EQ(GeminiTracked::destructor_calls, 1);
+        EXPECT_EQ(other->value, 3);
+    }
+    EXPECT_EQ(GeminiTracked::destructor_calls, 2);
+}
+
+TEST_F(LockFreeSharedPtrGeminiTest, ControlBlocksCarryNoVtable) {
+    EXPECT_FALSE(is_polymorphic_v<ControlBlockImpl<GeminiTracked>>);
+    EXPECT_FALSE(is_polymorphic_v<ControlBlockMakeShared<GeminiTracked>>);
+}
+
+struct GeminiDerived : GeminiTracked {
+    static inline atomic<int> derived_destroyed{0};
+    ~GeminiDerived() { derived_destroyed.fetch_add(1, memory_order_relaxed); }
+};
+
+// Blocks that miss the default-delete fast path still dispose correctly
+TEST_F(LockFreeSharedPtrGeminiTest, CustomDeleterAndConvertedOwnerUseTheirTable) {
+    GeminiDerived::derived_destroyed = 0;
+    int deleter_calls = 0;
+    {
+        LockFreeSharedPtrGemini<GeminiTracked> custom(new GeminiTracked(1), [&deleter_calls](GeminiTracked* p) {
+            ++deleter_calls;
+            delete p;
+        });
+        LockFreeSharedPtrGemini<GeminiTracked> base(LockFreeSharedPtrGemini<GeminiDerived>(new GeminiDerived));
+    }
+    EXPECT_EQ(deleter_calls, 1);
+    EXPECT_EQ(GeminiDerived::derived_destroyed, 1);
+    EXPECT_EQ(GeminiTracked::destructor_calls, 2);
+}
@@ -137,6 +137,154 @@ TEST_F(LockFreeSharedPtrTest, MultipleThreadAccess)
     EXPECT_EQ(testPtr_.getCount(), 1); 
 }
 
+// --- Thread-confined count policy ---
+
+TEST_F(LockFreeSharedPtrTest, LocalSharedPtrLifecycle)
+{
+    {
+        ThreadSafeWorld::LocalSharedPtr<CallsTracker> local{new CallsTracker(2)};
+        EXPECT_EQ(local.getCount(), 1);
+        {
+            ThreadSafeWorld::LocalSharedPtr<CallsTracker> copy(local);
+            EXPECT_EQ(local.getCount(), 2);
+            ThreadSafeWorld::LocalSharedPtr<CallsTracker> moved(std::move(copy));
+            EXPECT_EQ(copy.get(), nullptr);
+            EXPECT_EQ(moved->id, 2);
+            EXPECT_EQ(local.getCount(), 2);
+        }
+        EXPECT_EQ(local.getCount(), 1);
+        EXPECT_EQ(CallsTracker::destructor_calls, 0);
+    }
+    EXPECT_EQ(CallsTracker::constructor_calls, 2);
+    EXPECT_EQ(CallsTracker::destructor_calls, 1);
+}
+
+#ifndef NDEBUG
+TEST_F(LockFreeSharedPtrTest, LocalSharedPtrTrapsOnForeignThread)
+{
+    GTEST_FLAG_SET(death_test_style, "threadsafe");
+    ThreadSafeWorld::LocalSharedPtr<CallsTracker> local{new CallsTracker(3)};
+    EXPECT_DEATH(
+        {
+            thread([&local] { ThreadSafeWorld::LocalSharedPtr<CallsTracker> copy(local); }).join();
+        },
+        "owning thread");
+}
+#endif
+
+// --- Deferred destruction ---
+
+TEST_F(LockFreeSharedPtrTest, DeferredSharedPtrDestroysOnDrain)
+{
+    ThreadSafeWorld::drain_deferred();
+    {
+        ThreadSafeWorld::DeferredSharedPtr<CallsTracker> deferred{new CallsTracker(4)};
+        ThreadSafeWorld::DeferredSharedPtr<CallsTracker> copy(deferred);
+    }
+    // The last drop only queued the object
+    EXPECT_EQ(CallsTracker::destructor_calls, 0);
+    EXPECT_EQ(ThreadSafeWorld::drain_deferred(), 1u);
+    EXPECT_EQ(CallsTracker::destructor_calls, 1);
+}
+
+TEST_F(LockFreeSharedPtrTest, DeferredSharedPtrDroppedOnOtherThreads)
+{
+    ThreadSafeWorld::drain_deferred();
+    {
+        vector<thread> threads;
+        for (int i = 0; i < 4; ++i)
+        {
+            threads.emplace_back([]
+                                 {
+                for (int j = 0; j < 100; ++j)
+                {
+                    ThreadSafeWorld::DeferredSharedPtr<CallsTracker> local{new CallsTracker(j)};
+                } });
+        }
+        for (auto &t : threads)
+        {
+            t.join();
+        }
+    }
+    EXPECT_EQ(CallsTracker::destructor_calls, 0);
+    EXPECT_EQ(ThreadSafeWorld::drain_deferred(), 400u);
+    EXPECT_EQ(CallsTracker::destructor_calls, 400);
+}
+
+// --- Sharded count policy ---
+
+TEST_F(LockFreeSharedPtrTest, ShardedSharedPtrLifecycle)
+{
+    {
+        ThreadSafeWorld::ShardedSharedPtr<CallsTracker> sharded{new CallsTracker(5)};
+        {
+            ThreadSafeWorld::ShardedSharedPtr<CallsTracker> copy(sharded);
+            ThreadSafeWorld::ShardedSharedPtr<CallsTracker> moved(std::move(copy));
+            EXPECT_EQ(sharded.getCount(), 2);
+        }
+        EXPECT_EQ(sharded.getCount(), 1);
+        EXPECT_EQ(CallsTracker::destructor_calls, 0);
+    }
+    EXPECT_EQ(CallsTracker::destructor_calls, 1);
+}
+
+TEST_F(LockFreeSharedPtrTest, ShardedSharedPtrCopiedByManyThreads)
+{
+    {
+        ThreadSafeWorld::ShardedSharedPtr<CallsTracker> sharded{new CallsTracker(6)};
+        vector<thread> threads;
+        for (int i = 0; i < 8; ++i)
+        {
+            threads.emplace_back([&sharded]
+                                 {
+                for (int j = 0; j < 10000; ++j)
+                {
+                    ThreadSafeWorld::ShardedSharedPtr<CallsTracker> copy(sharded);
+                    EXPECT_EQ(copy->id, 6);
+                } });
+        }
+        for (auto &t : threads)
+        {
+            t.join();
+        }
+        EXPECT_EQ(sharded.getCount(), 1);
+        EXPECT_EQ(CallsTracker::destructor_calls, 0);
+    }
+    EXPECT_EQ(CallsTracker::destructor_calls, 1);
+}
+
+// Copies taken on one thread and dropped on others drive shards negative,
+// which folds the counts; the last of the racing drops must still win
+TEST_F(LockFreeSharedPtrTest, ShardedSharedPtrDroppedOnOtherThreads)
+{
+    const int rounds = 200;
+    const int num_threads = 4;
+    for (int round = 0; round < rounds; ++round)
+    {
+        vector<ThreadSafeWorld::ShardedSharedPtr<CallsTracker>> copies;
+        {
+            ThreadSafeWorld::ShardedSharedPtr<CallsTracker> sharded{new CallsTracker(round)};
+            for (int i = 0; i < num_threads; ++i)
+            {
+                copies.push_back(sharded);
+            }
+        }
+        vector<thread> threads;
+        for (auto &copy : copies)
+        {
+            threads.emplace_back([&copy]
+                                 {
+                ThreadSafeWorld::ShardedSharedPtr<CallsTracker> again(copy);
+                copy.reset(); });
+        }
+        for (auto &t : threads)
+        {
+            t.join();
+        }
+        EXPECT_EQ(CallsTracker::destructor_calls, round + 1);
+    }
+}
+
 // TEST_F(LockFreeSharedPtrTest, DefaultConstructor)
 // {
 //     ThreadSafeWorld::LockFreeSharedPtr<CallsTracker> ptr;
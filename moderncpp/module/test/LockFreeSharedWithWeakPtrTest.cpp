@@ -5,6 +5,7 @@
 #include <atomic>
 #include <chrono>
 #include <mutex>
+#include <memory_resource>
 #include <type_traits>
 
 // Since modules aren't fully supported in all environments yet,
@@ -16,7 +17,22 @@ using ThreadSafeWorld::LockFreeSharedWithWeakPtr;
 using ThreadSafeWorld::LockFreeWeakPtr;
 using ThreadSafeWorld::make_shared_custom;
 using ThreadSafeWorld::make_shared_array;
+using ThreadSafeWorld::make_shared_array_for_overwrite;
+using ThreadSafeWorld::allocate_shared_pmr;
+using ThreadSafeWorld::allocate_shared_array_pmr;
+using ThreadSafeWorld::allocate_shared_array_for_overwrite_pmr;
 using ThreadSafeWorld::make_shared_safe;
+using ThreadSafeWorld::AtomicLockFreeSharedPtr;
+using ThreadSafeWorld::make_biased_shared;
+using ThreadSafeWorld::drain_biased_merges;
+using ThreadSafeWorld::Reclamation;
+using ThreadSafeWorld::HazardPointer;
+using ThreadSafeWorld::hazard_flush;
+using ThreadSafeWorld::drain_deferred;
+using ThreadSafeWorld::PointerLayout;
+using ThreadSafeWorld::BasicControlBlock;
+using ThreadSafeWorld::ControlBlockWithDeleter;
+using ThreadSafeWorld::SharedRef;
 
 // Test helper class with tracking
 class TrackingType {
@@ -145,6 +161,32 @@ TEST_F(LockFreeSharedWithWeakPtrTest, WeakPtr) {
     }
 }
 
+// lock() must share the original control block rather than wrap it
+TEST_F(LockFreeSharedWithWeakPtrTest, WeakLockSharesControlBlock) {
+    LockFreeSharedWithWeakPtr<TrackingType> shared(new TrackingType(42));
+    LockFreeWeakPtr<TrackingType> weak(shared);
+
+    auto locked = weak.lock();
+    ASSERT_TRUE(locked);
+    EXPECT_EQ(locked.get(), shared.get());
+    EXPECT_EQ(shared.use_count(), 2);
+    EXPECT_EQ(locked.use_count(), 2);
+    EXPECT_FALSE(locked.owner_before(shared));
+    EXPECT_FALSE(shared.owner_before(locked));
+
+    // The locked copy alone keeps the object alive ...
+    shared.reset();
+    EXPECT_FALSE(weak.expired());
+    EXPECT_EQ(locked->value, 42);
+    EXPECT_EQ(TrackingType::destructor_calls, 0);
+
+    // ... and dropping it destroys the object exactly once
+    locked.reset();
+    EXPECT_TRUE(weak.expired());
+    EXPECT_EQ(weak.lock(), nullptr);
+    EXPECT_EQ(TrackingType::destructor_calls, 1);
+}
+
 // Test atomic operations
 TEST_F(LockFreeSharedWithWeakPtrTest, BasicThreadSafety) {
     auto ptr1 = make_shared_custom<TrackingType>(1);
@@ -301,9 +343,16 @@ TEST_F(LockFreeSharedWithWeakPtrTest, AliasingConstructor) {
     
     EXPECT_EQ(data_ptr->value, 42);
     EXPECT_EQ(data_ptr.use_count(), container.use_count());
+    EXPECT_EQ(data_ptr.use_count(), 2);
     
+    // The alias keeps the container alive
     container.reset();
-    EXPECT_EQ(data_ptr.use_count(), 0);
+    EXPECT_EQ(data_ptr.use_count(), 1);
+    EXPECT_EQ(data_ptr->value, 42);
+    EXPECT_EQ(TrackingType::destructor_calls, 0);
+
+    data_ptr.reset();
+    EXPECT_EQ(TrackingType::destructor_calls, 1);
 }
 
 // Test comparison operations
@@ -405,4 +454,798 @@ TEST_F(LockFreeSharedWithWeakPtrTest, ConcurrentWeakOperations) {
     for (const auto& weak : weak_ptrs) {
         EXPECT_TRUE(weak.expired());
     }
-}
\ No newline at end of file
+}
+
+// Test the atomic slot
+TEST_F(LockFreeSharedWithWeakPtrTest, AtomicSlotLoadStore) {
+    AtomicLockFreeSharedPtr<TrackingType> slot;
+    EXPECT_TRUE(slot.is_lock_free());
+    EXPECT_EQ(slot.load(), nullptr);
+
+    LockFreeSharedWithWeakPtr<TrackingType> first(new TrackingType(1));
+    slot.store(first);
+    EXPECT_EQ(first.use_count(), 2);
+    {
+        auto loaded = slot.load();
+        EXPECT_EQ(loaded.get(), first.get());
+        EXPECT_EQ(first.use_count(), 3);
+    }
+    EXPECT_EQ(first.use_count(), 2);
+
+    slot = LockFreeSharedWithWeakPtr<TrackingType>(new TrackingType(2));
+    EXPECT_EQ(first.use_count(), 1);
+    EXPECT_EQ(slot.load()->value, 2);
+
+    slot.store(nullptr);
+    EXPECT_EQ(slot.load(), nullptr);
+    EXPECT_EQ(TrackingType::destructor_calls, 1);
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, AtomicSlotExchangeAndCompareExchange) {
+    LockFreeSharedWithWeakPtr<TrackingType> first(new TrackingType(1));
+    LockFreeSharedWithWeakPtr<TrackingType> second(new TrackingType(2));
+    AtomicLockFreeSharedPtr<TrackingType> slot(first);
+
+    auto previous = slot.exchange(second);
+    EXPECT_EQ(previous.get(), first.get());
+    EXPECT_EQ(first.use_count(), 2);
+    EXPECT_EQ(second.use_count(), 2);
+
+    // Expected value is stale: fails and reports the current one
+    auto expected = first;
+    EXPECT_FALSE(slot.compare_exchange_strong(expected, first));
+    EXPECT_EQ(expected.get(), second.get());
+
+    EXPECT_TRUE(slot.compare_exchange_strong(expected, first));
+    EXPECT_EQ(slot.load().get(), first.get());
+    EXPECT_EQ(second.use_count(), 2); // second and expected
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, AtomicSlotConcurrentReadersAndWriter) {
+    const int num_readers = 4;
+    const int writes = 2000;
+    atomic<bool> done{false};
+    vector<thread> readers;
+
+    {
+        AtomicLockFreeSharedPtr<TrackingType> slot(
+            LockFreeSharedWithWeakPtr<TrackingType>(new TrackingType(0)));
+
+        for (int i = 0; i < num_readers; ++i) {
+            readers.emplace_back([&] {
+                int last_seen = 0;
+                while (!done.load(memory_order_acquire)) {
+                    auto current = slot.load();
+                    ASSERT_TRUE(current);
+                    // The single writer publishes increasing values
+                    EXPECT_GE(current->value, last_seen);
+                    last_seen = current->value;
+                }
+            });
+        }
+
+        for (int i = 1; i <= writes; ++i) {
+            slot.store(LockFreeSharedWithWeakPtr<TrackingType>(new TrackingType(i)));
+        }
+        done.store(true, memory_order_release);
+        for (auto& t : readers) {
+            t.join();
+        }
+    }
+
+    EXPECT_EQ(TrackingType::constructor_calls, writes + 1);
+    EXPECT_EQ(TrackingType::destructor_calls, writes + 1);
+}
+
+// Test biased reference counting
+TEST_F(LockFreeSharedWithWeakPtrTest, BiasedOwnerOnly) {
+    {
+        auto ptr = make_biased_shared<TrackingType>(42);
+        EXPECT_EQ(ptr->value, 42);
+        EXPECT_EQ(ptr.use_count(), 1);
+        {
+            auto copy = ptr;
+            auto another = copy;
+            EXPECT_EQ(ptr.use_count(), 3);
+        }
+        EXPECT_EQ(ptr.use_count(), 1);
+
+        LockFreeWeakPtr<TrackingType> weak(ptr);
+        EXPECT_EQ(weak.lock()->value, 42);
+        EXPECT_EQ(TrackingType::destructor_calls, 0);
+    }
+    EXPECT_EQ(TrackingType::destructor_calls, 1);
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, BiasedCopyDroppedByOtherThread) {
+    auto ptr = make_biased_shared<TrackingType>(1);
+    LockFreeWeakPtr<TrackingType> weak(ptr);
+
+    auto copy = ptr;
+    thread([&copy, &weak] {
+        EXPECT_EQ(weak.lock()->value, 1);
+        copy.reset();
+    }).join();
+
+    EXPECT_EQ(TrackingType::destructor_calls, 0);
+    ptr.reset();
+    EXPECT_EQ(TrackingType::destructor_calls, 1);
+    EXPECT_TRUE(weak.expired());
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, BiasedMigratedObjectMergedByOwner) {
+    auto ptr = make_biased_shared<TrackingType>(2);
+    LockFreeWeakPtr<TrackingType> weak(ptr);
+
+    // Hand the only reference to another thread, which drops it there
+    auto handed_off = ptr;
+    ptr.reset();
+    thread([&handed_off] { handed_off.reset(); }).join();
+
+    // The owner still holds the biased count until it merges
+    drain_biased_merges();
+    EXPECT_EQ(TrackingType::destructor_calls, 1);
+    EXPECT_TRUE(weak.expired());
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, BiasedObjectOutlivesOwnerThread) {
+    LockFreeSharedWithWeakPtr<TrackingType> survivor;
+    thread([&survivor] {
+        auto ptr = make_biased_shared<TrackingType>(3);
+        survivor = ptr;
+    }).join();
+
+    EXPECT_EQ(survivor->value, 3);
+    auto copy = survivor;
+    EXPECT_EQ(survivor.use_count(), 2);
+    copy.reset();
+    survivor.reset();
+    EXPECT_EQ(TrackingType::destructor_calls, 1);
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, BiasedConcurrentSharing) {
+    const int num_threads = 4;
+    const int iterations = 2000;
+    {
+        auto ptr = make_biased_shared<TrackingType>(7);
+        vector<thread> threads;
+        for (int i = 0; i < num_threads; ++i) {
+            threads.emplace_back([ptr, iterations] {
+                for (int j = 0; j < iterations; ++j) {
+                    auto copy = ptr;
+                    EXPECT_EQ(copy->value, 7);
+                }
+            });
+        }
+        for (int j = 0; j < iterations; ++j) {
+            auto copy = ptr;
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        EXPECT_EQ(ptr.use_count(), 1);
+    }
+    EXPECT_EQ(TrackingType::destructor_calls, 1);
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, HazardProtectedReadSurvivesReassign) {
+    LockFreeSharedWithWeakPtr<TrackingType> ptr(new TrackingType(1));
+    ptr.set_reclamation(Reclamation::Hazard);
+
+    {
+        HazardPointer hp;
+        TrackingType* seen = ptr.protect(hp);
+        ptr = LockFreeSharedWithWeakPtr<TrackingType>(new TrackingType(2));
+
+        // Retired, but still published in hp
+        hazard_flush();
+        EXPECT_EQ(TrackingType::destructor_calls, 0);
+        EXPECT_EQ(seen->value, 1);
+    }
+
+    hazard_flush();
+    EXPECT_EQ(TrackingType::destructor_calls, 1);
+    EXPECT_EQ(ptr->value, 2);
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, HazardRetiredBlockOutlivesWeakRef) {
+    LockFreeSharedWithWeakPtr<TrackingType> ptr(new TrackingType(1));
+    ptr.set_reclamation(Reclamation::Hazard);
+    auto weak = make_unique<LockFreeWeakPtr<TrackingType>>(ptr);
+
+    HazardPointer hp;
+    ptr.protect(hp);
+    ptr.reset();
+    EXPECT_TRUE(weak->expired());
+    EXPECT_FALSE(weak->lock());
+
+    // Dropping the last weak reference must not free the retired block
+    weak.reset();
+    hp.reset();
+    hazard_flush();
+    EXPECT_EQ(TrackingType::destructor_calls, 1);
+}
+
+namespace {
+    // Readers protect and read while the writer keeps replacing the object
+    template<PointerLayout Layout>
+    void hazardReadersAndWriter(int updates) {
+        using Ptr = LockFreeSharedWithWeakPtr<TrackingType, Layout>;
+        const int num_readers = 4;
+        {
+            Ptr shared(new TrackingType(0));
+            shared.set_reclamation(Reclamation::Hazard);
+            atomic<bool> done{false};
+
+            vector<thread> readers;
+            for (int i = 0; i < num_readers; ++i) {
+                readers.emplace_back([&shared, &done] {
+                    HazardPointer hp;
+                    int last = 0;
+                    while (!done.load(memory_order_acquire)) {
+                        int value = shared.protect(hp)->value;
+                        EXPECT_GE(value, last);
+                        last = value;
+                    }
+                });
+            }
+            for (int i = 1; i <= updates; ++i) {
+                Ptr next(new TrackingType(i));
+                next.set_reclamation(Reclamation::Hazard);
+                shared = next;
+            }
+            done.store(true, memory_order_release);
+            for (auto& t : readers) {
+                t.join();
+            }
+        }
+        hazard_flush();
+        EXPECT_EQ(TrackingType::destructor_calls, updates + 1);
+    }
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, HazardConcurrentReadersAndWriter) {
+    hazardReadersAndWriter<PointerLayout::Pair>(2000);
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, HazardConcurrentReadersAndWriterPacked) {
+    // Unpacking reads the block, so this also covers the block being
+    // reclaimed between the load and the hazard being published
+    hazardReadersAndWriter<PointerLayout::Packed>(20000);
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, DeferredReclamationWaitsForDrain) {
+    drain_deferred();
+    LockFreeSharedWithWeakPtr<TrackingType> ptr(new TrackingType(1));
+    ptr.set_reclamation(Reclamation::Deferred);
+    LockFreeWeakPtr<TrackingType> weak(ptr);
+
+    ptr.reset();
+    EXPECT_EQ(TrackingType::destructor_calls, 0);
+    EXPECT_TRUE(weak.expired());
+    EXPECT_FALSE(weak.lock());
+
+    EXPECT_EQ(drain_deferred(), 1u);
+    EXPECT_EQ(TrackingType::destructor_calls, 1);
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, DeferredBlockOutlivesLastWeakRef) {
+    drain_deferred();
+    LockFreeSharedWithWeakPtr<TrackingType> ptr(new TrackingType(1));
+    ptr.set_reclamation(Reclamation::Deferred);
+    auto weak = make_unique<LockFreeWeakPtr<TrackingType>>(ptr);
+
+    ptr.reset();
+    weak.reset();
+    EXPECT_EQ(drain_deferred(), 1u);
+    EXPECT_EQ(TrackingType::destructor_calls, 1);
+}
+
+// --- Pointer layouts ---
+using PackedPtr = LockFreeSharedWithWeakPtr<TrackingType, PointerLayout::Packed>;
+using PairPtr = LockFreeSharedWithWeakPtr<TrackingType, PointerLayout::Pair>;
+
+TEST_F(LockFreeSharedWithWeakPtrTest, PackedLayoutIsOneWord) {
+    EXPECT_EQ(sizeof(PackedPtr), sizeof(void*));
+    EXPECT_EQ(PackedPtr::layout, PointerLayout::Packed);
+    EXPECT_EQ(PairPtr::layout, PointerLayout::Pair);
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, PackedLayoutOwnership) {
+    {
+        PackedPtr ptr(new TrackingType(7));
+        EXPECT_EQ(ptr->value, 7);
+        EXPECT_EQ(ptr.use_count(), 1);
+
+        PackedPtr copy = ptr;
+        EXPECT_EQ(copy.get(), ptr.get());
+        EXPECT_EQ(ptr.use_count(), 2);
+
+        PackedPtr other(new TrackingType(8), CustomDeleter());
+        copy.swap(other);
+        EXPECT_EQ(copy->value, 8);
+        EXPECT_EQ(other->value, 7);
+
+        copy.reset();
+        EXPECT_EQ(TrackingType::custom_deleter_calls, 1);
+        EXPECT_FALSE(copy);
+        EXPECT_TRUE(copy == nullptr);
+    }
+    EXPECT_EQ(TrackingType::destructor_calls, 2);
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, PackedLayoutAliasing) {
+    struct Pair {
+        TrackingType first{1};
+        TrackingType second{2};
+    };
+
+    auto pair = make_shared_custom<Pair>();
+    PackedPtr second(pair, &pair->second);
+    EXPECT_EQ(second.get(), &pair->second);
+    EXPECT_EQ(second->value, 2);
+
+    PackedPtr null_alias(pair, nullptr);
+    EXPECT_FALSE(null_alias);
+
+    PackedPtr copy = second;
+    EXPECT_EQ(copy.get(), &pair->second);
+}
+
+namespace {
+    TrackingType far_from_any_block{9};
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, DefaultLayoutAliasesAnywhere) {
+    EXPECT_EQ(LockFreeSharedWithWeakPtr<TrackingType>::layout, PointerLayout::Pair);
+
+    struct Big {
+        TrackingType head{1};
+        char gap[64 * 1024];
+        TrackingType tail{2};
+    };
+    auto owner = make_shared_custom<Big>();
+    LockFreeSharedWithWeakPtr<TrackingType> tail(owner, &owner->tail);
+    EXPECT_EQ(tail.get(), &owner->tail);
+    LockFreeSharedWithWeakPtr<TrackingType> global(owner, &far_from_any_block);
+    EXPECT_EQ(global.get(), &far_from_any_block);
+    EXPECT_EQ(owner.use_count(), 3);
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, PackedLayoutRejectsFarAliases) {
+    struct Big {
+        TrackingType head{1};
+        char gap[64 * 1024];
+        TrackingType tail{2};
+    };
+    auto owner = make_shared_custom<Big>();
+    EXPECT_THROW(PackedPtr(owner, &owner->tail), invalid_argument);
+    EXPECT_THROW(PackedPtr(owner, &far_from_any_block), invalid_argument);
+    EXPECT_EQ(owner.use_count(), 1);
+
+    PairPtr wide(owner, &far_from_any_block);
+    LockFreeWeakPtr<TrackingType> weak(wide);
+    EXPECT_THROW(weak.lock<PointerLayout::Packed>(), invalid_argument);
+    SharedRef<TrackingType> borrowed(wide);
+    EXPECT_THROW(borrowed.promote<PointerLayout::Packed>(), invalid_argument);
+    EXPECT_EQ(owner.use_count(), 2);
+
+    PackedPtr head(owner, &owner->head);
+    EXPECT_EQ(head.get(), &owner->head);
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, LayoutsShareControlBlocks) {
+    PairPtr wide(new TrackingType(3));
+    LockFreeWeakPtr<TrackingType> weak(wide);
+
+    auto packed = weak.lock<PointerLayout::Packed>();
+    EXPECT_EQ(packed.get(), wide.get());
+    EXPECT_EQ(wide.use_count(), 2);
+    EXPECT_TRUE(packed == wide);
+    EXPECT_FALSE(weak.owner_before(packed));
+
+    PairPtr back(packed, packed.get());
+    EXPECT_EQ(back->value, 3);
+
+    wide.reset();
+    packed.reset();
+    EXPECT_EQ(TrackingType::destructor_calls, 0);
+    back.reset();
+    EXPECT_EQ(TrackingType::destructor_calls, 1);
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, PackedWeakPointer) {
+    using PackedWeak = LockFreeWeakPtr<TrackingType, PointerLayout::Packed>;
+    EXPECT_EQ(sizeof(PackedWeak), sizeof(void*));
+    EXPECT_TRUE((is_same_v<PackedPtr::weak_type, PackedWeak>));
+
+    struct Pair {
+        TrackingType first{1};
+        TrackingType second{2};
+    };
+    auto pair = make_shared_custom<Pair>();
+    PackedPtr second(pair, &pair->second);
+    PackedWeak weak(second);
+    PackedWeak copy(weak);
+    EXPECT_EQ(weak.use_count(), 2);
+
+    auto locked = copy.lock();
+    EXPECT_TRUE((is_same_v<decltype(locked), PackedPtr>));
+    EXPECT_EQ(locked.get(), &pair->second);
+    EXPECT_EQ(weak.lock<PointerLayout::Pair>().get(), &pair->second);
+    EXPECT_FALSE(weak.owner_before(second));
+    EXPECT_FALSE(copy.owner_before(weak));
+
+    PairPtr far(pair, &far_from_any_block);
+    EXPECT_THROW(PackedWeak{far}, invalid_argument);
+    EXPECT_EQ(pair.use_count(), 4);
+
+    pair.reset();
+    second.reset();
+    locked.reset();
+    far.reset();
+    EXPECT_TRUE(weak.expired());
+    EXPECT_FALSE(copy.lock());
+    copy = weak;
+    weak.reset();
+    EXPECT_EQ(TrackingType::destructor_calls, 2);
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, PackedWeakConcurrentLock) {
+    const int num_threads = 4;
+    const int locks = 10000;
+    PackedPtr shared(new TrackingType(5));
+    LockFreeWeakPtr<TrackingType, PointerLayout::Packed> weak(shared);
+
+    vector<thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&weak] {
+            for (int j = 0; j < locks; ++j) {
+                auto locked = weak.lock();
+                ASSERT_TRUE(locked);
+                EXPECT_EQ(locked->value, 5);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(shared.use_count(), 1);
+    shared.reset();
+    EXPECT_FALSE(weak.lock());
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, PackedLayoutConcurrentCopies) {
+    const int num_threads = 4;
+    const int copies = 10000;
+    PackedPtr shared(new TrackingType(5));
+
+    vector<thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+        threads.emplace_back([&shared] {
+            for (int j = 0; j < copies; ++j) {
+                PackedPtr copy(shared);
+                EXPECT_EQ(copy->value, 5);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(shared.use_count(), 1);
+}
+
+// --- Control block operation tables ---
+TEST_F(LockFreeSharedWithWeakPtrTest, ControlBlocksCarryNoVtable) {
+    EXPECT_FALSE(is_polymorphic_v<BasicControlBlock<TrackingType>>);
+    EXPECT_FALSE((is_polymorphic_v<ControlBlockWithDeleter<TrackingType, CustomDeleter, allocator<TrackingType>>>));
+}
+
+// --- Packed strong/weak counts ---
+TEST_F(LockFreeSharedWithWeakPtrTest, PackedCountsTrackBothSides) {
+    LockFreeSharedWithWeakPtr<TrackingType> shared(new TrackingType(3));
+    auto copy = shared;
+    LockFreeWeakPtr<TrackingType> weak1(shared);
+    LockFreeWeakPtr<TrackingType> weak2(weak1);
+    EXPECT_EQ(shared.use_count(), 2);
+    EXPECT_EQ(shared.weak_count(), 2);
+
+    auto locked = weak2.lock();
+    EXPECT_EQ(shared.use_count(), 3);
+    EXPECT_EQ(shared.weak_count(), 2);
+
+    weak1.reset();
+    copy.reset();
+    locked.reset();
+    EXPECT_EQ(shared.use_count(), 1);
+    EXPECT_EQ(shared.weak_count(), 1);
+
+    shared.reset();
+    EXPECT_EQ(TrackingType::destructor_calls, 1);
+    EXPECT_TRUE(weak2.expired());
+    EXPECT_EQ(weak2.use_count(), 0);
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, ConcurrentLockRacesLastRelease) {
+    const int rounds = 500;
+    const int num_lockers = 3;
+    for (int round = 0; round < rounds; ++round) {
+        LockFreeSharedWithWeakPtr<TrackingType> shared(new TrackingType(round));
+        LockFreeWeakPtr<TrackingType> weak(shared);
+        atomic<int> ready{0};
+
+        vector<thread> lockers;
+        for (int i = 0; i < num_lockers; ++i) {
+            lockers.emplace_back([&weak, &ready, round] {
+                LockFreeWeakPtr<TrackingType> own(weak);
+                ready.fetch_add(1, memory_order_acq_rel);
+                while (ready.load(memory_order_acquire) <= num_lockers) {
+                    this_thread::yield();
+                }
+                // Either the upgrade wins and the object is still intact,
+                // or it loses and sees the object expired
+                if (auto locked = own.lock()) {
+                    EXPECT_EQ(locked->value, round);
+                }
+            });
+        }
+        while (ready.load(memory_order_acquire) < num_lockers) {
+            this_thread::yield();
+        }
+        ready.fetch_add(1, memory_order_acq_rel);
+        shared.reset();
+        for (auto& t : lockers) {
+            t.join();
+        }
+        EXPECT_TRUE(weak.expired());
+    }
+    EXPECT_EQ(TrackingType::destructor_calls, rounds);
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, LastWeakDropRacesLastRelease) {
+    const int rounds = 2000;
+    for (int round = 0; round < rounds; ++round) {
+        LockFreeSharedWithWeakPtr<TrackingType> shared(new TrackingType(round));
+        auto weak = make_unique<LockFreeWeakPtr<TrackingType>>(shared);
+        atomic<bool> go{false};
+
+        // Whichever side finishes last frees the block, exactly once
+        thread dropper([&weak, &go] {
+            while (!go.load(memory_order_acquire)) {
+                this_thread::yield();
+            }
+            weak.reset();
+        });
+        go.store(true, memory_order_release);
+        shared.reset();
+        dropper.join();
+    }
+    EXPECT_EQ(TrackingType::destructor_calls, rounds);
+}
+
+// --- Fused array allocation ---
+TEST_F(LockFreeSharedWithWeakPtrTest, ArrayHonoursRequestedAlignment) {
+    auto ptr = make_shared_array<double, 64>(100);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr.get()) % 64, 0u);
+    for (size_t i = 0; i < 100; ++i) {
+        EXPECT_EQ(ptr.get()[i], 0.0);
+    }
+    LockFreeWeakPtr<double> weak(ptr);
+    ptr.reset();
+    EXPECT_TRUE(weak.expired());
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, ArrayForOverwrite) {
+    auto ptr = make_shared_array_for_overwrite<float, 32>(257);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr.get()) % 32, 0u);
+    for (size_t i = 0; i < 257; ++i) {
+        ptr.get()[i] = static_cast<float>(i);
+    }
+    auto copy = ptr;
+    EXPECT_EQ(copy.get()[256], 256.0f);
+}
+
+class ThrowOnThird {
+public:
+    static atomic<int> live;
+    ThrowOnThird() {
+        if (live == 2) {
+            throw ThrowingType::ConstructorException();
+        }
+        ++live;
+    }
+    ~ThrowOnThird() { --live; }
+};
+atomic<int> ThrowOnThird::live(0);
+
+TEST_F(LockFreeSharedWithWeakPtrTest, ArrayConstructionUnwindsOnThrow) {
+    EXPECT_THROW(make_shared_array<ThrowOnThird>(5), ThrowingType::ConstructorException);
+    EXPECT_EQ(ThrowOnThird::live, 0);
+}
+
+// --- Memory resources ---
+TEST_F(LockFreeSharedWithWeakPtrTest, MakeSharedDestroysObjectOnce) {
+    auto ptr = make_shared_custom<TrackingType>(9);
+    LockFreeWeakPtr<TrackingType> weak(ptr);
+    EXPECT_EQ(ptr.use_count(), 1);
+    ptr.reset();
+    EXPECT_EQ(TrackingType::destructor_calls, 1);
+    EXPECT_TRUE(weak.expired());
+}
+
+// Counts what passes through to the upstream resource
+class CountingResource : public pmr::memory_resource {
+public:
+    size_t allocations = 0;
+    size_t deallocations = 0;
+    size_t bytes_in_use = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++allocations;
+        bytes_in_use += bytes;
+        return pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        ++deallocations;
+        bytes_in_use -= bytes;
+        pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+TEST_F(LockFreeSharedWithWeakPtrTest, AllocateSharedPmrPlacesBlockInResource) {
+    CountingResource resource;
+    {
+        auto ptr = allocate_shared_pmr<TrackingType>(&resource, 11);
+        EXPECT_EQ(ptr->value, 11);
+        EXPECT_EQ(resource.allocations, 1u);
+
+        LockFreeWeakPtr<TrackingType> weak(ptr);
+        ptr.reset();
+        EXPECT_EQ(TrackingType::destructor_calls, 1);
+        // The weak reference still holds the block
+        EXPECT_EQ(resource.deallocations, 0u);
+    }
+    EXPECT_EQ(resource.deallocations, 1u);
+    EXPECT_EQ(resource.bytes_in_use, 0u);
+}
+
+struct ArenaRecord {
+    using allocator_type = pmr::polymorphic_allocator<>;
+    pmr::vector<int> values;
+
+    ArenaRecord(int n, const allocator_type& alloc) : values(alloc) {
+        values.resize(n, n);
+    }
+};
+
+TEST_F(LockFreeSharedWithWeakPtrTest, AllocateSharedPmrPropagatesResource) {
+    CountingResource resource;
+    {
+        auto record = allocate_shared_pmr<ArenaRecord>(&resource, 100);
+        EXPECT_EQ(record->values.get_allocator().resource(), &resource);
+        EXPECT_EQ(resource.allocations, 2u);
+    }
+    EXPECT_EQ(resource.bytes_in_use, 0u);
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, MonotonicArenaHoldsWholeGraph) {
+    CountingResource upstream;
+    {
+        pmr::monotonic_buffer_resource arena(&upstream);
+        vector<LockFreeSharedWithWeakPtr<TrackingType>> graph;
+        for (int i = 0; i < 1000; ++i) {
+            graph.push_back(allocate_shared_pmr<TrackingType>(&arena, i));
+        }
+        graph.clear();
+        EXPECT_EQ(TrackingType::destructor_calls, 1000);
+        EXPECT_LT(upstream.allocations, 20u);
+    }
+    EXPECT_EQ(upstream.bytes_in_use, 0u);
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, DeleterConstructorTakesResource) {
+    CountingResource resource;
+    {
+        LockFreeSharedWithWeakPtr<TrackingType> ptr(new TrackingType(3), CustomDeleter(), &resource);
+        EXPECT_EQ(resource.allocations, 1u);
+    }
+    EXPECT_EQ(TrackingType::custom_deleter_calls, 1);
+    EXPECT_EQ(resource.bytes_in_use, 0u);
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, ArrayPmrFromResource) {
+    CountingResource resource;
+    {
+        auto values = allocate_shared_array_pmr<double, 64>(&resource, 33);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(values.get()) % 64, 0u);
+        EXPECT_EQ(values.get()[32], 0.0);
+        auto raw = allocate_shared_array_for_overwrite_pmr<int>(&resource, 10);
+        raw.get()[9] = 1;
+        EXPECT_EQ(resource.allocations, 2u);
+    }
+    EXPECT_EQ(resource.deallocations, 2u);
+    EXPECT_EQ(resource.bytes_in_use, 0u);
+}
+
+// --- Borrowed handles ---
+
+static int sumThroughLayers(SharedRef<TrackingType> ref, int depth) {
+    return depth == 0 ? ref->value : ref->value + sumThroughLayers(ref, depth - 1);
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, SharedRefTakesNoReference) {
+    auto owner = make_shared_custom<TrackingType>(3);
+    EXPECT_EQ(sumThroughLayers(owner, 5), 18);
+
+    SharedRef<TrackingType> ref(owner);
+    EXPECT_EQ(ref.get(), owner.get());
+    EXPECT_EQ(ref.use_count(), 1);
+    EXPECT_EQ(owner.use_count(), 1);
+
+    LockFreeSharedWithWeakPtr<TrackingType> empty;
+    SharedRef<TrackingType> none(empty);
+    EXPECT_FALSE(none);
+    EXPECT_FALSE(none.promote());
+#ifdef NDEBUG
+    static_assert(is_trivially_copyable_v<SharedRef<TrackingType>>);
+#endif
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, SharedRefPromoteOutlivesSource) {
+    LockFreeSharedWithWeakPtr<TrackingType> kept;
+    {
+        auto owner = make_shared_custom<TrackingType>(7);
+        SharedRef<TrackingType> ref(owner);
+        kept = ref.promote();
+        EXPECT_EQ(owner.use_count(), 2);
+    }
+    EXPECT_EQ(kept.use_count(), 1);
+    EXPECT_EQ(kept->value, 7);
+    EXPECT_EQ(TrackingType::destructor_calls, 0);
+    kept.reset();
+    EXPECT_EQ(TrackingType::destructor_calls, 1);
+}
+
+TEST_F(LockFreeSharedWithWeakPtrTest, SharedRefFromEitherLayoutAndDerived) {
+    LockFreeSharedWithWeakPtr<Derived, PointerLayout::Packed> packed(new Derived);
+    SharedRef<Base> base(packed);
+    EXPECT_EQ(base->get_value(), 84);
+
+    auto promoted = base.promote<PointerLayout::Packed>();
+    EXPECT_EQ(promoted.get(), static_cast<Base*>(packed.get()));
+    EXPECT_EQ(packed.use_count(), 2);
+
+    auto pair = base.promote<PointerLayout::Pair>();
+    SharedRef<Base> fromPair(pair);
+    EXPECT_EQ(fromPair.get(), base.get());
+    EXPECT_EQ(fromPair.use_count(), 3);
+    EXPECT_FALSE((is_constructible_v<SharedRef<int>, LockFreeSharedWithWeakPtr<int>&&>));
+}
+
+#ifndef NDEBUG
+TEST_F(LockFreeSharedWithWeakPtrTest, SharedRefTrapsWhenSourceChanges) {
+    GTEST_FLAG_SET(death_test_style, "threadsafe");
+    auto owner = make_shared_custom<TrackingType>(1);
+    auto other = owner;
+    EXPECT_DEATH(
+        {
+            SharedRef<TrackingType> ref(owner);
+            owner.reset();
+            static_cast<void>(ref.get());
+        },
+        "reset or reassigned");
+    EXPECT_DEATH(
+        {
+            SharedRef<TrackingType> ref(other);
+            other.reset();
+            owner.reset();
+        },
+        "still borrows");
+}
+#endif
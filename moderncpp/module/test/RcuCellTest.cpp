@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+import leonrahul.RcuCell;
+
+using namespace std;
+using ThreadSafeWorld::LockFreeSharedPtr;
+using ThreadSafeWorld::RcuCell;
+using ThreadSafeWorld::RcuReadGuard;
+using ThreadSafeWorld::EpochManager;
+
+// Versioned value whose two fields must always agree
+struct RcuTable {
+    static atomic<int> destroyed;
+    int version;
+    int checksum;
+
+    explicit RcuTable(int v = 0) : version(v), checksum(-v) {}
+    RcuTable(const RcuTable& other) : version(other.version), checksum(other.checksum) {}
+    ~RcuTable() { destroyed.fetch_add(1, memory_order_relaxed); }
+};
+
+atomic<int> RcuTable::destroyed(0);
+
+class RcuCellTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        RcuTable::destroyed = 0;
+    }
+};
+
+TEST_F(RcuCellTest, ReadSeesPublishedVersion) {
+    RcuCell<RcuTable> cell(LockFreeSharedPtr<RcuTable>(new RcuTable(1)));
+    EXPECT_EQ(cell.visit([](const RcuTable& t) { return t.version; }), 1);
+
+    cell.publish(LockFreeSharedPtr<RcuTable>(new RcuTable(2)));
+    RcuReadGuard guard;
+    EXPECT_EQ(cell.read(guard)->version, 2);
+}
+
+TEST_F(RcuCellTest, OldVersionOutlivesActiveReader) {
+    RcuCell<RcuTable> cell(LockFreeSharedPtr<RcuTable>(new RcuTable(1)));
+    {
+        RcuReadGuard guard;
+        const RcuTable* seen = cell.read(guard);
+
+        // Publishing from another thread cannot free what this reader sees
+        thread([&cell] { cell.publish(LockFreeSharedPtr<RcuTable>(new RcuTable(2))); }).join();
+        EXPECT_EQ(RcuTable::destroyed, 0);
+        EXPECT_EQ(cell.pending(), 1u);
+        EXPECT_EQ(seen->version, 1);
+    }
+
+    // The next publish finds no reader in the old epoch
+    cell.publish(LockFreeSharedPtr<RcuTable>(new RcuTable(3)));
+    EXPECT_EQ(RcuTable::destroyed, 2);
+    EXPECT_EQ(cell.pending(), 0u);
+}
+
+TEST_F(RcuCellTest, SnapshotKeepsVersionAlive) {
+    RcuCell<RcuTable> cell(LockFreeSharedPtr<RcuTable>(new RcuTable(1)));
+    auto snapshot = cell.snapshot();
+    cell.publish(LockFreeSharedPtr<RcuTable>(new RcuTable(2)));
+    cell.synchronize();
+
+    EXPECT_EQ(RcuTable::destroyed, 0);
+    EXPECT_EQ(snapshot->version, 1);
+    snapshot.reset();
+    EXPECT_EQ(RcuTable::destroyed, 1);
+}
+
+TEST_F(RcuCellTest, UpdateCopiesAndPublishes) {
+    RcuCell<RcuTable> cell(LockFreeSharedPtr<RcuTable>(new RcuTable(1)));
+    vector<thread> writers;
+    for (int i = 0; i < 4; ++i) {
+        writers.emplace_back([&cell] {
+            for (int j = 0; j < 100; ++j) {
+                cell.update([](RcuTable& t) {
+                    ++t.version;
+                    t.checksum = -t.version;
+                });
+            }
+        });
+    }
+    for (auto& t : writers) {
+        t.join();
+    }
+    EXPECT_EQ(cell.visit([](const RcuTable& t) { return t.version; }), 401);
+}
+
+TEST_F(RcuCellTest, NestedReadSections) {
+    RcuCell<RcuTable> cell(LockFreeSharedPtr<RcuTable>(new RcuTable(1)));
+    RcuReadGuard outer;
+    const RcuTable* seen = cell.read(outer);
+    {
+        RcuReadGuard inner;
+    }
+
+    // Leaving the inner section must not end the outer one
+    thread([&cell] { cell.publish(LockFreeSharedPtr<RcuTable>(new RcuTable(2))); }).join();
+    EXPECT_EQ(RcuTable::destroyed, 0);
+    EXPECT_EQ(seen->version, 1);
+}
+
+TEST_F(RcuCellTest, ConcurrentReadersSeeConsistentSnapshots) {
+    const int num_readers = 4;
+    const int updates = 2000;
+    {
+        RcuCell<RcuTable> cell(LockFreeSharedPtr<RcuTable>(new RcuTable(0)));
+        atomic<bool> done{false};
+
+        vector<thread> readers;
+        for (int i = 0; i < num_readers; ++i) {
+            readers.emplace_back([&cell, &done] {
+                int last = 0;
+                while (!done.load(memory_order_acquire)) {
+                    RcuReadGuard guard;
+                    const RcuTable* table = cell.read(guard);
+                    EXPECT_EQ(table->checksum, -table->version);
+                    EXPECT_GE(table->version, last);
+                    last = table->version;
+                }
+            });
+        }
+        for (int i = 1; i <= updates; ++i) {
+            cell.publish(LockFreeSharedPtr<RcuTable>(new RcuTable(i)));
+        }
+        done.store(true, memory_order_release);
+        for (auto& t : readers) {
+            t.join();
+        }
+        cell.synchronize();
+        EXPECT_EQ(RcuTable::destroyed, updates);
+    }
+    EXPECT_EQ(RcuTable::destroyed, updates + 1);
+}
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "../include/CustomString.h"
+
+import leonrahul.StringInternPool;
+
+using namespace std;
+using namespace StringWorld;
+
+TEST(StringInternPoolTest, EqualContentsShareOneEntry) {
+    StringInternPool pool;
+    string tenant = "tenant-42";
+    InternedString a = pool.intern("tenant-42");
+    InternedString b = pool.intern(tenant.c_str());
+    InternedString c = pool.intern(CustomString("tenant-42"));
+    InternedString other = pool.intern("tenant-43");
+
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a, c);
+    EXPECT_NE(a, other);
+    EXPECT_EQ(a.c_str(), b.c_str());
+    EXPECT_STREQ(a.c_str(), "tenant-42");
+    EXPECT_EQ(a.size(), 9u);
+    EXPECT_STREQ(a.str().c_str(), "tenant-42");
+    EXPECT_EQ(hash<InternedString>{}(a), hash<InternedString>{}(c));
+    EXPECT_EQ(pool.size(), 2u);
+
+    // Ids are dense, in interning order
+    EXPECT_EQ(a.id(), 0u);
+    EXPECT_EQ(other.id(), 1u);
+}
+
+TEST(StringInternPoolTest, NullAndEmptyDiffer) {
+    StringInternPool pool;
+    InternedString none = pool.intern(static_cast<const char *>(nullptr));
+    InternedString fromNullString = pool.intern(CustomString());
+    InternedString empty = pool.intern("");
+
+    EXPECT_FALSE(none);
+    EXPECT_EQ(none, InternedString());
+    EXPECT_EQ(fromNullString, none);
+    EXPECT_EQ(none.c_str(), nullptr);
+    EXPECT_EQ(none.id(), InternedString::null_id);
+    EXPECT_TRUE(empty);
+    EXPECT_STREQ(empty.c_str(), "");
+    EXPECT_NE(empty, none);
+    EXPECT_EQ(pool.size(), 1u);
+}
+
+TEST(StringInternPoolTest, FindNeverInserts) {
+    StringInternPool pool;
+    EXPECT_FALSE(pool.find("metric.latency"));
+    InternedString latency = pool.intern("metric.latency");
+    EXPECT_EQ(pool.find("metric.latency"), latency);
+    EXPECT_FALSE(pool.find("metric.errors"));
+    EXPECT_EQ(pool.size(), 1u);
+}
+
+TEST(StringInternPoolTest, HandlesSurviveTableGrowth) {
+    StringInternPool pool;
+    constexpr int count = 20000;
+    vector<InternedString> handles;
+    for (int i = 0; i < count; ++i) {
+        handles.push_back(pool.intern(("key-" + to_string(i)).c_str()));
+    }
+    // A long string takes an arena chunk of its own
+    string big(StringInternPool::chunk_size * 2, 'x');
+    InternedString bigHandle = pool.intern(big.c_str(), big.size());
+
+    for (int i = 0; i < count; ++i) {
+        string key = "key-" + to_string(i);
+        ASSERT_EQ(pool.intern(key.c_str()), handles[i]);
+        ASSERT_STREQ(handles[i].c_str(), key.c_str());
+    }
+    EXPECT_EQ(bigHandle.size(), big.size());
+
+    InternPoolStats stats = pool.memoryUsage();
+    EXPECT_EQ(stats.strings, count + 1u);
+    EXPECT_GE(stats.arena_bytes, stats.text_bytes);
+    EXPECT_GT(stats.table_bytes, 0u);
+}
+
+TEST(StringInternPoolTest, BulkInternMatchesSingle) {
+    StringInternPool pool;
+    InternedString before = pool.intern("b");
+    CustomStringArray names;
+    names.add("a");
+    names.add("b");
+    names.add(nullptr);
+    names.add("a");
+
+    vector<InternedString> handles = pool.intern(names);
+    ASSERT_EQ(handles.size(), 4u);
+    EXPECT_EQ(handles[0], pool.intern("a"));
+    EXPECT_EQ(handles[1], before);
+    EXPECT_FALSE(handles[2]);
+    EXPECT_EQ(handles[3], handles[0]);
+    EXPECT_EQ(pool.size(), 2u);
+}
+
+TEST(StringInternPoolTest, ConcurrentInternsAgree) {
+    StringInternPool pool;
+    constexpr int num_threads = 8;
+    constexpr int num_keys = 2000;
+    vector<vector<InternedString>> seen(num_threads);
+    atomic<bool> go{false};
+    vector<thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t] {
+            while (!go.load(memory_order_acquire)) {
+                this_thread::yield();
+            }
+            // Each thread walks the keys from a different starting point
+            for (int i = 0; i < num_keys; ++i) {
+                int k = (i + t * 250) % num_keys;
+                seen[t].push_back(pool.intern(("m" + to_string(k)).c_str()));
+            }
+        });
+    }
+    go.store(true, memory_order_release);
+    for (auto& th : threads) {
+        th.join();
+    }
+
+    EXPECT_EQ(pool.size(), static_cast<size_t>(num_keys));
+    unordered_set<uint32_t> ids;
+    for (int i = 0; i < num_keys; ++i) {
+        InternedString expected = pool.find(("m" + to_string(i)).c_str());
+        ASSERT_TRUE(expected);
+        ids.insert(expected.id());
+        for (int t = 0; t < num_threads; ++t) {
+            ASSERT_EQ(seen[t][(i - t * 250 % num_keys + num_keys) % num_keys], expected);
+        }
+    }
+    EXPECT_EQ(ids.size(), static_cast<size_t>(num_keys));
+    EXPECT_EQ(*max_element(ids.begin(), ids.end()), num_keys - 1u);
+}
+
+TEST(StringInternPoolTest, GlobalPoolIsShared) {
+    EXPECT_EQ(StringInternPool::global().intern("shared-name"),
+              StringInternPool::global().intern(CustomString("shared-name")));
+}
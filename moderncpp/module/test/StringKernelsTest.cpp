@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "../include/StringKernels.h"
+
+using namespace StringKernels;
+
+// Every vector table the CPU supports must agree with the scalar one on
+// random inputs: lengths across the vector widths, misaligned starts and
+// a small alphabet so that matches and near misses are common.
+namespace
+{
+    std::vector<const Table*> vectorTables()
+    {
+        std::vector<const Table*> tables;
+        for (Level level : {Level::SSE2, Level::AVX2, Level::AVX512})
+        {
+            if (const Table* table = forLevel(level))
+            {
+                tables.push_back(table);
+            }
+        }
+        return tables;
+    }
+
+    int sign(int v)
+    {
+        return (v > 0) - (v < 0);
+    }
+
+    class KernelFuzz
+    {
+    public:
+        explicit KernelFuzz(unsigned seed) : rng(seed) {}
+
+        size_t size(size_t max)
+        {
+            return std::uniform_int_distribution<size_t>(0, max)(rng);
+        }
+
+        // Random bytes from a small alphabet, which includes bytes above 0x7F
+        std::string text(size_t n)
+        {
+            static const char alphabet[] = {'a', 'b', 'c', static_cast<char>(0xE9)};
+            std::string s(n, 'a');
+            for (char& c : s)
+            {
+                c = alphabet[size(3)];
+            }
+            return s;
+        }
+
+    private:
+        std::mt19937 rng;
+    };
+}
+
+TEST(StringKernelsTest, ScalarResults) {
+    const Table& scalar = *forLevel(Level::Scalar);
+    EXPECT_EQ(scalar.length(""), 0u);
+    EXPECT_EQ(scalar.length("hello"), 5u);
+    EXPECT_LT(scalar.compare("abc", 3, "abd", 3), 0);
+    EXPECT_LT(scalar.compare("ab", 2, "abc", 3), 0);
+    EXPECT_GT(scalar.compare("\xE9", 1, "z", 1), 0);
+    EXPECT_EQ(scalar.compare("abc", 3, "abc", 3), 0);
+    EXPECT_EQ(scalar.find("hello world", 11, "world", 5), 6u);
+    EXPECT_EQ(scalar.find("hello", 5, "", 0), 0u);
+    EXPECT_EQ(scalar.find("hello", 5, "hello!", 6), npos);
+    EXPECT_EQ(scalar.findFirstOf("key=value;", 10, "=;", 2), 3u);
+    EXPECT_EQ(scalar.findFirstOf("key", 3, "=;", 2), npos);
+    EXPECT_NE(forLevel(active().level), nullptr);
+}
+
+TEST(StringKernelsTest, VectorKernelsMatchScalar) {
+    const Table& scalar = *forLevel(Level::Scalar);
+    KernelFuzz fuzz(20240601);
+    for (const Table* table : vectorTables()) {
+        SCOPED_TRACE(table->name);
+        for (int round = 0; round < 3000; ++round) {
+            // padding ahead of the text moves it to every alignment
+            size_t pad = fuzz.size(63);
+            std::string a = std::string(pad, 'x') + fuzz.text(fuzz.size(fuzz.size(7) == 0 ? 2000 : 300));
+            const char* as = a.c_str() + pad;
+            size_t an = a.size() - pad;
+            // b is often a copy of a with one byte changed or cut short
+            std::string b(as, an);
+            if (!b.empty() && fuzz.size(1) == 0) {
+                b[fuzz.size(b.size() - 1)] = 'c';
+            }
+            b.resize(fuzz.size(1) == 0 ? b.size() : fuzz.size(b.size()));
+
+            ASSERT_EQ(table->length(as), scalar.length(as));
+            ASSERT_EQ(sign(table->compare(as, an, b.data(), b.size())),
+                      sign(scalar.compare(as, an, b.data(), b.size())));
+            size_t common = std::min(an, b.size());
+            ASSERT_EQ(table->equal(as, b.data(), common), scalar.equal(as, b.data(), common));
+
+            std::string needle = fuzz.size(2) == 0 ? fuzz.text(fuzz.size(4))
+                                                   : std::string(as, an).substr(fuzz.size(an), fuzz.size(8));
+            ASSERT_EQ(table->find(as, an, needle.data(), needle.size()),
+                      scalar.find(as, an, needle.data(), needle.size()));
+
+            std::string set = fuzz.text(fuzz.size(3)) + (fuzz.size(4) == 0 ? "x" : "");
+            ASSERT_EQ(table->findFirstOf(as, an, set.data(), set.size()),
+                      scalar.findFirstOf(as, an, set.data(), set.size()));
+        }
+        // a set too large for the vectors falls back to the lookup table
+        std::string wide = "abcdefghijklmnopqrstuvwxyz";
+        EXPECT_EQ(table->findFirstOf("0123456789z", 11, wide.data(), wide.size()), 10u);
+    }
+}
+
+#ifdef __linux__
+TEST(StringKernelsTest, LengthStopsAtPageEnd) {
+    // A string that ends right before an unreadable page
+    long page = sysconf(_SC_PAGESIZE);
+    char* mem = static_cast<char*>(mmap(nullptr, 2 * page, PROT_READ | PROT_WRITE,
+                                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    ASSERT_NE(mem, MAP_FAILED);
+    ASSERT_EQ(mprotect(mem + page, page, PROT_NONE), 0);
+    for (size_t n = 0; n < 600; ++n) {
+        char* s = mem + page - n - 1;
+        std::memset(s, 'q', n);
+        s[n] = '\0';
+        for (const Table* table : vectorTables()) {
+            ASSERT_EQ(table->length(s), n) << table->name;
+        }
+    }
+    munmap(mem, 2 * page);
+}
+#endif